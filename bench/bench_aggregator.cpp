@@ -0,0 +1,184 @@
+#include "bench_corpus.h"
+#include "clamp/AggregationDaemon.h"
+#include "clamp/EntropyTelemetry.h"
+#include "clamp/TemporalAggregator.h"
+#include "telemetry/compression.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+void writeCorpusFile(const std::filesystem::path& dir, std::size_t file, std::size_t recordsPerFile) {
+    std::ofstream out(dir / ("bench_" + std::to_string(file) + ".json"));
+    clamp::bench::writeTelemetryDocument(out, recordsPerFile, file);
+}
+
+void writeCorpus(const std::filesystem::path& dir, std::size_t fileCount, std::size_t recordsPerFile) {
+    std::error_code ec;
+    std::filesystem::remove_all(dir, ec);
+    std::filesystem::create_directories(dir);
+    for (std::size_t file = 0; file < fileCount; ++file) {
+        writeCorpusFile(dir, file, recordsPerFile);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t fileCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000;
+    const std::size_t recordsPerFile = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 64;
+    const auto corpus = std::filesystem::temp_directory_path() / "clamp_aggregator_bench";
+    writeCorpus(corpus, fileCount, recordsPerFile);
+
+    std::vector<std::size_t> workerCounts{1, 2, 4};
+    const std::size_t hardware = std::thread::hardware_concurrency();
+    if (hardware > 4) {
+        workerCounts.push_back(hardware);
+    }
+
+    std::cout << "corpus: " << fileCount << " files x " << recordsPerFile << " records\n";
+    bool reproducible = true;
+    clamp::TemporalAggregator::Summary reference;
+    for (const std::size_t workers : workerCounts) {
+        clamp::TemporalAggregator aggregator({workers});
+        const auto start = std::chrono::steady_clock::now();
+        const auto summary = aggregator.aggregate(corpus);
+        const double elapsedMs =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (workers == workerCounts.front()) {
+            reference = summary;
+        } else if (summary.meanStability != reference.meanStability ||
+                   summary.stabilityVariance != reference.stabilityVariance ||
+                   summary.driftIndex != reference.driftIndex ||
+                   summary.sessionCount != reference.sessionCount) {
+            reproducible = false;
+        }
+        std::cout << std::setw(3) << workers << " workers: " << std::fixed << std::setprecision(2)
+                  << elapsedMs << " ms (" << summary.sessionCount << " records)\n";
+    }
+    std::cout << "bit-reproducible across worker counts: " << (reproducible ? "yes" : "NO") << '\n';
+
+    for (const bool batchedIo : {false, true}) {
+        clamp::TemporalAggregator::Options options;
+        options.workerCount = hardware;
+        options.batchedIo = batchedIo;
+        clamp::TemporalAggregator aggregator(options);
+        const auto start = std::chrono::steady_clock::now();
+        const auto summary = aggregator.aggregate(corpus);
+        const double elapsedMs =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (summary.meanStability != reference.meanStability || summary.sessionCount != reference.sessionCount) {
+            reproducible = false;
+        }
+        std::cout << (batchedIo ? "batched reads: " : "per-file mmap: ") << std::fixed << std::setprecision(2)
+                  << elapsedMs << " ms\n";
+    }
+
+    {
+        clamp::TemporalAggregator::Options options;
+        options.workerCount = hardware;
+        options.groupBy.context = true;
+        options.groupBy.threadId = true;
+        const auto start = std::chrono::steady_clock::now();
+        const auto summary = clamp::TemporalAggregator(options).aggregate(corpus);
+        const double elapsedMs =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (summary.sessionCount != reference.sessionCount) {
+            reproducible = false;
+        }
+        std::cout << "group by context+thread: " << std::fixed << std::setprecision(2) << elapsedMs << " ms ("
+                  << summary.groups.size() << " groups)\n";
+    }
+    {
+        clamp::TemporalAggregator::Options options;
+        options.workerCount = hardware;
+        options.bucketWidth = std::chrono::minutes(1);
+        const auto start = std::chrono::steady_clock::now();
+        const auto summary = clamp::TemporalAggregator(options).aggregate(corpus);
+        const double elapsedMs =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (summary.sessionCount != reference.sessionCount) {
+            reproducible = false;
+        }
+        std::cout << "1 min time buckets: " << std::fixed << std::setprecision(2) << elapsedMs << " ms ("
+                  << summary.timeBuckets.size() << " buckets)\n";
+    }
+
+    clamp::TemporalAggregator::Options incremental;
+    incremental.incremental = true;
+    clamp::TemporalAggregator cached(incremental);
+    auto timeAggregate = [&](const char* label) {
+        const auto start = std::chrono::steady_clock::now();
+        const auto summary = cached.aggregate(corpus);
+        const double elapsedMs =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << label << ": " << std::fixed << std::setprecision(2) << elapsedMs << " ms ("
+                  << summary.sessionCount << " records)\n";
+        return summary;
+    };
+    timeAggregate("incremental, cold cache");
+    timeAggregate("incremental, warm cache");
+    writeCorpusFile(corpus, fileCount, recordsPerFile);
+    const auto updated = timeAggregate("incremental, 1 new file");
+    if (updated.sessionCount != reference.sessionCount + recordsPerFile) {
+        reproducible = false;
+    }
+
+    if (clamp::EntropyTelemetry::compressionSupported(clamp::TelemetryCompression::Gzip)) {
+        // The same records as one large gzip archive, streamed through a
+        // decompression thread while the scanner parses.
+        const auto archiveDir = std::filesystem::temp_directory_path() / "clamp_aggregator_bench_gz";
+        std::error_code ec;
+        std::filesystem::remove_all(archiveDir, ec);
+        std::filesystem::create_directories(archiveDir);
+        std::ostringstream document;
+        clamp::bench::writeTelemetryDocument(document, fileCount * recordsPerFile, 0);
+        std::string compressed;
+        clamp::detail::compressBuffer(document.str(), clamp::TelemetryCompression::Gzip, compressed);
+        std::ofstream(archiveDir / "archive.json.gz", std::ios::binary) << compressed;
+        std::ofstream(archiveDir / "archive.json", std::ios::binary) << document.str();
+        for (const char* name : {"archive.json", "archive.json.gz"}) {
+            const auto only = archiveDir / name;
+            clamp::TemporalAggregator::Query query;
+            query.include = {name};
+            const auto start = std::chrono::steady_clock::now();
+            const auto summary = clamp::TemporalAggregator({1}).aggregate(archiveDir, query);
+            const double elapsedMs =
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            std::cout << name << " (" << std::filesystem::file_size(only) / 1024 << " KiB): " << std::fixed
+                      << std::setprecision(2) << elapsedMs << " ms (" << summary.sessionCount << " records)\n";
+        }
+        std::filesystem::remove_all(archiveDir, ec);
+    }
+
+    {
+        clamp::AggregationDaemon daemon(corpus, {});
+        auto timeRefresh = [&](const char* label) {
+            const auto start = std::chrono::steady_clock::now();
+            const std::size_t added = daemon.refresh();
+            const double elapsedMs =
+                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            std::cout << label << ": " << std::fixed << std::setprecision(2) << elapsedMs << " ms (" << added
+                      << " records)\n";
+        };
+        timeRefresh("daemon, initial scan");
+        writeCorpusFile(corpus, fileCount + 1, recordsPerFile);
+        timeRefresh("daemon, 1 new file");
+        if (daemon.summary().sessionCount != reference.sessionCount + 2 * recordsPerFile) {
+            reproducible = false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::remove_all(corpus, ec);
+    return reproducible ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+#include "clamp/TelemetryComparator.h"
+#include "clamp/TemporalAggregator.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main(int argc, char** argv) {
+    // Records are split evenly between two backends.
+    const std::size_t recordCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1'000'000;
+    const std::size_t resamples = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10'000;
+    const std::size_t summaryCount = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1000;
+
+    std::mt19937_64 rng(recordCount);
+    std::normal_distribution<double> noise(0.0, 0.05);
+    std::vector<clamp::TelemetryComparator::BackendRecords> records(2);
+    records[0].backend = "CPU";
+    records[0].deviceName = "host";
+    records[1].backend = "HIP";
+    records[1].deviceName = "gfx1100";
+    for (std::size_t i = 0; i < recordCount; ++i) {
+        auto& backend = records[i % 2];
+        const double shift = i % 2 == 0 ? 0.0 : 0.0005;
+        backend.stability.push_back(0.8 - shift + noise(rng));
+        backend.durationMs.push_back(4.0 + 20.0 * (noise(rng) + shift));
+    }
+
+    std::vector<std::size_t> workerCounts{1};
+    const std::size_t hardware = std::thread::hardware_concurrency();
+    if (hardware > 1) {
+        workerCounts.push_back(hardware);
+    }
+    std::cout << std::fixed;
+    for (const std::size_t workers : workerCounts) {
+        clamp::TelemetryComparator::Options options;
+        options.workerCount = workers;
+        options.resamples = resamples;
+        const auto start = std::chrono::steady_clock::now();
+        const auto result = clamp::TelemetryComparator(options).bootstrap(records, {});
+        const double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const auto& cell = result.at(1, 0).meanStabilityDelta;
+        std::cout << resamples << " resamples x " << recordCount << " records, " << workers
+                  << " workers: " << std::setprecision(2) << seconds << " s ("
+                  << static_cast<double>(resamples) * static_cast<double>(recordCount) / seconds / 1e9
+                  << " G weighted records/s); HIP - CPU stability " << std::setprecision(5) << cell.estimate
+                  << " [" << cell.lower << ", " << cell.upper << "]" << (cell.significant ? " significant" : "")
+                  << '\n';
+    }
+
+    // Loading and comparing summary files, spread over four backends.
+    const auto dir = std::filesystem::temp_directory_path() / "clamp_compare_bench";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    const char* backends[][2] = {{"CPU", "host"}, {"HIP", "gfx1100"}, {"HIP", "gfx90a"}, {"HIP", "gfx942"}};
+    std::vector<std::filesystem::path> paths;
+    for (std::size_t i = 0; i < summaryCount; ++i) {
+        clamp::TemporalAggregator::Summary summary;
+        clamp::TemporalAggregator::GroupSummary group;
+        group.key.backend = backends[i % 4][0];
+        group.key.deviceName = backends[i % 4][1];
+        group.sessionCount = summary.sessionCount = 10 + i % 7;
+        group.meanStability = summary.meanStability = 0.5 + static_cast<double>(i % 100) / 400.0;
+        group.stabilityVariance = summary.stabilityVariance = 0.01 + static_cast<double>(i % 13) / 1000.0;
+        group.driftIndex = summary.driftIndex = static_cast<double>(i % 50);
+        summary.groups.push_back(group);
+        paths.push_back(dir / ("summary_" + std::to_string(i) + ".json"));
+        clamp::TemporalAggregator().writeSummary(summary, paths.back(), "telemetry");
+    }
+    for (const std::size_t workers : workerCounts) {
+        clamp::TelemetryComparator::Options options;
+        options.workerCount = workers;
+        const auto start = std::chrono::steady_clock::now();
+        const auto result = clamp::TelemetryComparator(options).compare(paths, dir / "comparison.json");
+        const double milliseconds =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << summaryCount << " summaries, " << workers << " workers: " << std::setprecision(2)
+                  << milliseconds << " ms (" << result.backends.size() << " backends)\n";
+    }
+    std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdio>
+#include <ostream>
+#include <string>
+
+namespace clamp::bench {
+
+// Emits a pretty-printed telemetry document shaped like the files archived by
+// CI: one key per line, `recordCount` records, timestamps spread over a day.
+inline void writeTelemetryDocument(std::ostream& out, std::size_t recordCount, std::size_t salt = 0) {
+    out << "{\n  \"records\": [\n";
+    for (std::size_t i = 0; i < recordCount; ++i) {
+        const unsigned seconds = static_cast<unsigned>((salt * recordCount + i) % 86400);
+        char stamp[32];
+        std::snprintf(stamp, sizeof(stamp), "2025-01-01T%02u:%02u:%02uZ",
+                      seconds / 3600, (seconds / 60) % 60, seconds % 60);
+        if (i > 0) {
+            out << ",\n";
+        }
+        out << "    {\n"
+            << "      \"context\": \"bench-" << (i % 8) << "\",\n"
+            << "      \"seed\": " << (salt * 7919 + i + 1) << ",\n"
+            << "      \"thread_id\": \"" << (i % 4) << "\",\n"
+            << "      \"acquired_at\": \"" << stamp << "\",\n"
+            << "      \"released_at\": \"" << stamp << "\",\n"
+            << "      \"duration_ms\": " << (1.0 + static_cast<double>(i % 17) * 0.25) << ",\n"
+            << "      \"stability_score\": " << (0.5 + static_cast<double>((salt + i) % 50) / 100.0) << "\n"
+            << "    }";
+    }
+    out << "\n  ]\n}\n";
+}
+
+} // namespace clamp::bench
@@ -0,0 +1,44 @@
+#include "clamp/EntropyBackend.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <vector>
+
+int main(int argc, char** argv) {
+    const std::size_t entryCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 16'000'000;
+    const std::size_t repeats = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5;
+
+    std::vector<std::uint64_t> seeds(entryCount);
+    std::vector<int> states(entryCount);
+    for (std::size_t i = 0; i < entryCount; ++i) {
+        seeds[i] = i * 0x9E3779B97F4A7C15ull;
+        states[i] = static_cast<int>(i % 3);
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+    for (const auto& backend : clamp::availableEntropyBackends()) {
+        // A throwaway instance pays for page faults and device initialisation,
+        // so the measured throughput covers the timed runs only.
+        if (clamp::makeEntropyBackend(backend->name())->mirror(seeds, states) != std::optional<bool>(true)) {
+            std::cout << backend->name() << ": mirror failed\n";
+            continue;
+        }
+        bool ok = true;
+        for (std::size_t i = 0; i < repeats && ok; ++i) {
+            ok = backend->mirror(seeds, states) == std::optional<bool>(true);
+        }
+        const double entriesPerSecond = backend->measuredThroughput();
+
+        const auto capabilities = backend->capabilities();
+        std::cout << std::setw(13) << std::left << backend->name() << std::right << " ("
+                  << backend->telemetryBackend() << '/' << backend->deviceName() << ", "
+                  << (capabilities.device ? "device" : "host") << ", " << capabilities.workerCount << " units, "
+                  << capabilities.kernel << "): " << entriesPerSecond / 1e6 << " M entries/s, "
+                  << entriesPerSecond * 2 * (sizeof(std::uint64_t) + sizeof(int)) / 1e9 << " GB/s copied+compared"
+                  << (ok ? "" : " [mismatch]") << '\n';
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include "bench_corpus.h"
+#include "legacy_parsers.h"
+#include "telemetry/telemetry_scanner.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Totals {
+    std::size_t records{0};
+    double stabilitySum{0.0};
+    double timestampSum{0.0};
+
+    void add(const clamp::detail::ParsedRecord& record) {
+        ++records;
+        if (std::isfinite(record.stabilityScore)) {
+            stabilitySum += record.stabilityScore;
+        }
+        timestampSum += record.timestampMs;
+    }
+
+    bool operator==(const Totals& other) const {
+        return records == other.records && stabilitySum == other.stabilitySum && timestampSum == other.timestampSum;
+    }
+};
+
+class TotalsSink final : public clamp::detail::RecordSink {
+public:
+    void onRecord(const clamp::detail::ParsedRecord& record) override { totals.add(record); }
+    Totals totals;
+};
+
+template <typename Fn>
+Totals timeRun(const char* label, std::size_t bytes, int repeats, Fn&& fn) {
+    Totals totals;
+    double bestMs = 0.0;
+    for (int i = 0; i < repeats; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        totals = fn();
+        const double elapsed =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        bestMs = i == 0 ? elapsed : std::min(bestMs, elapsed);
+    }
+    const double mbPerSecond = static_cast<double>(bytes) / (1024.0 * 1024.0) / (bestMs / 1000.0);
+    std::cout << std::left << std::setw(18) << label << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << bestMs << " ms" << std::setw(10) << mbPerSecond << " MiB/s  ("
+              << totals.records << " records)\n";
+    return totals;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t recordCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    const int repeats = argc > 2 ? std::atoi(argv[2]) : 3;
+
+    std::ostringstream document;
+    clamp::bench::writeTelemetryDocument(document, recordCount);
+    const std::string json = document.str();
+    std::cout << "document: " << recordCount << " records, " << json.size() / 1024 << " KiB, scanner kernel "
+              << clamp::detail::TelemetryScanner::kernelName() << '\n';
+
+    const Totals scanned = timeRun("TelemetryScanner", json.size(), repeats, [&]() {
+        TotalsSink sink;
+        clamp::detail::TelemetryScanner::scan(json, sink);
+        return sink.totals;
+    });
+
+    bool consistent = true;
+    const Totals chunked = timeRun("Scanner, 64K feed", json.size(), repeats, [&]() {
+        TotalsSink sink;
+        clamp::detail::TelemetryScanner scanner(sink);
+        constexpr std::size_t kChunk = 64 * 1024 + 7;
+        for (std::size_t offset = 0; offset < json.size(); offset += kChunk) {
+            scanner.feed(std::string_view(json).substr(offset, kChunk));
+        }
+        scanner.finish();
+        return sink.totals;
+    });
+    consistent = consistent && chunked == scanned;
+
+    const Totals fallback = timeRun("parseFallback", json.size(), repeats, [&]() {
+        std::istringstream stream(json);
+        Totals totals;
+        for (const auto& record : clamp::bench::parseFallback(stream)) {
+            totals.add(record);
+        }
+        return totals;
+    });
+    consistent = consistent && fallback == scanned;
+
+#if CLAMP_HAS_NLOHMANN_JSON
+    const Totals dom = timeRun("parseWithNlohmann", json.size(), repeats, [&]() {
+        std::istringstream stream(json);
+        Totals totals;
+        for (const auto& record : clamp::bench::parseWithNlohmann(stream)) {
+            totals.add(record);
+        }
+        return totals;
+    });
+    consistent = consistent && dom == scanned;
+#else
+    std::cout << "parseWithNlohmann  skipped (nlohmann/json.hpp not found)\n";
+#endif
+
+    std::cout << "results consistent: " << (consistent ? "yes" : "NO") << '\n';
+    return consistent ? 0 : 1;
+}
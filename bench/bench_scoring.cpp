@@ -0,0 +1,235 @@
+#include "clamp/StreamingTemporalScorer.h"
+#include "clamp/TemporalScoring.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct DriftOnlyPolicy : clamp::DefaultScoringPolicy {
+    static constexpr bool kEntropy = false;
+    static constexpr bool kDuration = false;
+};
+
+// The copy-then-multi-pass evaluate() that TemporalScoring used before the
+// fused kernel, kept here for comparison.
+double legacyNormalizedVariance(const std::vector<double>& values) {
+    if (values.size() < 2) {
+        return 0.0;
+    }
+    double mean = 0.0;
+    for (const double value : values) {
+        mean += value;
+    }
+    mean /= static_cast<double>(values.size());
+    double sumSq = 0.0;
+    for (const double value : values) {
+        const double diff = value - mean;
+        sumSq += diff * diff;
+    }
+    const double scale = std::abs(mean) + 1.0;
+    return sumSq / static_cast<double>(values.size() - 1) / (scale * scale);
+}
+
+clamp::TemporalScoringResult legacyEvaluate(const std::vector<clamp::AnchorTelemetryRecord>& records) {
+    clamp::TemporalScoringResult result;
+    result.sampleCount = records.size();
+    std::vector<double> seeds;
+    seeds.reserve(records.size());
+    std::vector<double> durations;
+    durations.reserve(records.size());
+    for (const auto& record : records) {
+        seeds.push_back(static_cast<double>(record.seed));
+        durations.push_back(record.durationMs);
+    }
+    result.entropyVariance = std::min(1.0, legacyNormalizedVariance(seeds));
+    result.durationVariance = std::min(1.0, legacyNormalizedVariance(durations));
+    std::optional<std::chrono::system_clock::time_point> minTs;
+    std::optional<std::chrono::system_clock::time_point> maxTs;
+    for (const auto& record : records) {
+        if (record.acquiredAt.time_since_epoch().count() == 0) {
+            continue;
+        }
+        minTs = minTs ? std::min(*minTs, record.acquiredAt) : record.acquiredAt;
+        maxTs = maxTs ? std::max(*maxTs, record.acquiredAt) : record.acquiredAt;
+    }
+    if (minTs) {
+        result.driftMs = std::chrono::duration<double, std::milli>(*maxTs - *minTs).count();
+    }
+    return result;
+}
+
+struct Columns {
+    std::vector<std::uint64_t> seeds;
+    std::vector<double> durations;
+    std::vector<std::int64_t> stamps;
+};
+
+Columns makeColumns(std::size_t count) {
+    Columns columns;
+    columns.seeds.resize(count);
+    columns.durations.resize(count);
+    columns.stamps.resize(count);
+    std::mt19937_64 rng(count);
+    const std::int64_t base = std::int64_t{1'700'000'000} * 1'000'000'000;
+    for (std::size_t i = 0; i < count; ++i) {
+        columns.seeds[i] = 1000 + rng() % 64;
+        columns.durations[i] = 2.0 + static_cast<double>(rng() % 4096) / 512.0;
+        columns.stamps[i] = base + static_cast<std::int64_t>(i) * 1000;
+    }
+    return columns;
+}
+
+std::vector<clamp::AnchorTelemetryRecord> makeRecords(const Columns& columns) {
+    std::vector<clamp::AnchorTelemetryRecord> records(columns.seeds.size());
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        records[i].seed = columns.seeds[i];
+        records[i].durationMs = columns.durations[i];
+        records[i].acquiredAt = std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(columns.stamps[i])));
+    }
+    return records;
+}
+
+// Best of several runs, repeated until ~50 ms have been spent so small inputs
+// are not dominated by timer resolution.
+template <typename Fn>
+double bestMs(std::size_t count, Fn&& evaluate, clamp::TemporalScoringResult& result) {
+    double best = 1e300;
+    double spent = 0.0;
+    for (int run = 0; run < 5 || (spent < 50.0 && run < 100000); ++run) {
+        const auto start = std::chrono::steady_clock::now();
+        result = evaluate();
+        const double elapsed =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, elapsed);
+        spent += elapsed;
+        if (count >= 10'000'000 && run >= 1) {
+            break;
+        }
+    }
+    return best;
+}
+
+bool matches(const clamp::TemporalScoringResult& a, const clamp::TemporalScoringResult& b) {
+    auto close = [](double x, double y) { return std::abs(x - y) <= 1e-9 * std::max(1.0, std::abs(y)); };
+    return a.sampleCount == b.sampleCount && close(a.entropyVariance, b.entropyVariance) &&
+           close(a.durationVariance, b.durationVariance) && close(a.driftMs, b.driftMs);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    // Records are ~200 bytes each, so the record layout stops at a smaller
+    // size than the columnar one (24 bytes per record).
+    const std::size_t maxColumns = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100'000'000;
+    const std::size_t maxRecords = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10'000'000;
+    clamp::TemporalScoring scoring;
+    bool consistent = true;
+
+    std::cout << std::setw(11) << "records" << std::setw(14) << "legacy ms" << std::setw(14) << "fused ms"
+              << std::setw(14) << "columnar ms" << std::setw(16) << "columnar Mrec/s" << '\n';
+    for (std::size_t count = 1000; count <= maxColumns; count *= 10) {
+        clamp::TemporalScoringResult columnar;
+        Columns columns = makeColumns(count);
+        const clamp::TemporalColumns view{columns.seeds.data(), columns.durations.data(), columns.stamps.data(),
+                                          count};
+        const double columnarMs = bestMs(count, [&] { return scoring.evaluate(view); }, columnar);
+
+        std::cout << std::setw(11) << count << std::fixed << std::setprecision(3);
+        if (count <= maxRecords) {
+            const auto records = makeRecords(columns);
+            clamp::TemporalScoringResult legacy;
+            clamp::TemporalScoringResult fused;
+            const double legacyMs = bestMs(count, [&] { return legacyEvaluate(records); }, legacy);
+            const double fusedMs = bestMs(count, [&] { return scoring.evaluate(records); }, fused);
+            consistent = consistent && matches(fused, legacy) && matches(columnar, legacy);
+            std::cout << std::setw(14) << legacyMs << std::setw(14) << fusedMs;
+        } else {
+            std::cout << std::setw(14) << "-" << std::setw(14) << "-";
+        }
+        std::cout << std::setw(14) << columnarMs << std::setw(16) << std::setprecision(1)
+                  << static_cast<double>(count) / columnarMs / 1000.0 << '\n';
+    }
+    std::cout << "results match legacy within 1e-9: " << (consistent ? "yes" : "NO") << '\n';
+
+    // A policy with components disabled compiles them out of the kernel.
+    {
+        const std::size_t count = std::min<std::size_t>(maxColumns, 10'000'000);
+        Columns columns = makeColumns(count);
+        const clamp::TemporalColumns view{columns.seeds.data(), columns.durations.data(), columns.stamps.data(),
+                                          count};
+        clamp::TemporalScoringResult full;
+        clamp::TemporalScoringResult driftOnly;
+        const double fullMs = bestMs(count, [&] { return scoring.evaluate(view); }, full);
+        const double driftMs =
+            bestMs(count, [&] { return clamp::BasicTemporalScoring<DriftOnlyPolicy>().evaluate(view); }, driftOnly);
+        consistent = consistent && driftOnly.driftMs == full.driftMs;
+        std::cout << count << " columnar records, default policy: " << std::setprecision(3) << fullMs
+                  << " ms, drift-only policy: " << driftMs << " ms\n";
+    }
+
+    // evaluateAggregated over many per-session groups held in one column set.
+    {
+        const std::size_t groupCount = 10'000;
+        const std::size_t perGroup = 1'000;
+        Columns columns = makeColumns(groupCount * perGroup);
+        const clamp::TemporalColumns view{columns.seeds.data(), columns.durations.data(), columns.stamps.data(),
+                                          columns.seeds.size()};
+        std::vector<std::size_t> offsets;
+        for (std::size_t group = 0; group <= groupCount; ++group) {
+            offsets.push_back(group * perGroup);
+        }
+        std::vector<std::size_t> workerCounts{1, 2, 4};
+        const std::size_t hardware = std::thread::hardware_concurrency();
+        if (hardware > 4) {
+            workerCounts.push_back(hardware);
+        }
+        clamp::TemporalScoringResult reference;
+        for (const std::size_t workers : workerCounts) {
+            const clamp::TemporalScoring grouped({workers});
+            clamp::TemporalScoringResult result;
+            const double ms = bestMs(view.size, [&] { return grouped.evaluateAggregated(view, offsets); }, result);
+            if (workers == workerCounts.front()) {
+                reference = result;
+            }
+            consistent = consistent && result.toJson() == reference.toJson() &&
+                         result.stabilityScore == reference.stabilityScore;
+            std::cout << groupCount << " groups x " << perGroup << " records, " << workers
+                      << " workers: " << std::setprecision(3) << ms << " ms\n";
+        }
+        std::cout << "grouped results identical across worker counts: " << (consistent ? "yes" : "NO") << '\n';
+    }
+
+    // StreamingTemporalScorer: cost per add() and per current().
+    {
+        const std::size_t count = 10'000'000;
+        const Columns columns = makeColumns(count);
+        for (const std::size_t windowRecords : {std::size_t{1'000}, std::size_t{100'000}}) {
+            clamp::StreamingTemporalScorer streaming({windowRecords, std::chrono::milliseconds(0)});
+            double checksum = 0.0;
+            const auto start = std::chrono::steady_clock::now();
+            for (std::size_t i = 0; i < count; ++i) {
+                streaming.add(columns.seeds[i], columns.durations[i], columns.stamps[i]);
+                if (i % 64 == 0) {
+                    checksum += streaming.current().stabilityScore;
+                }
+            }
+            const double elapsedNs =
+                std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            std::cout << "streaming, window " << windowRecords << ": " << std::setprecision(1)
+                      << elapsedNs / static_cast<double>(count) << " ns per add (current() every 64; checksum "
+                      << std::setprecision(3) << checksum << ")\n";
+        }
+    }
+    return consistent ? 0 : 1;
+}
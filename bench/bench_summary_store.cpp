@@ -0,0 +1,66 @@
+#include "clamp/SummaryStore.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv) {
+    const std::size_t buildCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000;
+    const auto storeDir = std::filesystem::temp_directory_path() / "clamp_summary_store_bench";
+    std::error_code ec;
+    std::filesystem::remove_all(storeDir, ec);
+
+    using Clock = std::chrono::steady_clock;
+    auto elapsedMs = [](Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+    constexpr std::int64_t kBaseMs = 1735689600000;
+    constexpr std::int64_t kBuildSpacingMs = 15 * 60 * 1000;
+
+    clamp::SummaryStore store;
+    store.open(storeDir);
+    auto start = Clock::now();
+    for (std::size_t build = 0; build < buildCount; ++build) {
+        clamp::SummaryStore::Row row;
+        row.timestampMs = kBaseMs + static_cast<std::int64_t>(build) * kBuildSpacingMs;
+        row.digest = "sha256:" + std::to_string(build);
+        row.sessionCount = 64;
+        row.meanStability = 0.5 + static_cast<double>(build % 100) / 1000.0;
+        store.append(row);
+    }
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "append " << buildCount << " rows: " << elapsedMs(start) << " ms\n";
+
+    start = Clock::now();
+    clamp::SummaryStore reopened;
+    reopened.open(storeDir);
+    std::cout << "open + index catch-up: " << elapsedMs(start) << " ms\n";
+
+    start = Clock::now();
+    clamp::SummaryStore indexed;
+    indexed.open(storeDir);
+    std::cout << "open with saved index: " << elapsedMs(start) << " ms\n";
+
+    start = Clock::now();
+    const auto lastBuilds = indexed.latest(500);
+    std::cout << "latest 500 builds: " << elapsedMs(start) << " ms (" << lastBuilds.size() << " rows)\n";
+
+    start = Clock::now();
+    const std::int64_t from = kBaseMs + static_cast<std::int64_t>(buildCount / 2) * kBuildSpacingMs;
+    const auto window = indexed.range(from, from + 500 * kBuildSpacingMs);
+    std::cout << "range over 500 builds: " << elapsedMs(start) << " ms (" << window.size() << " rows)\n";
+
+    start = Clock::now();
+    std::size_t found = 0;
+    for (std::size_t build = 0; build < 1000; ++build) {
+        found += indexed.findDigest("sha256:" + std::to_string(build * 7 % buildCount)).size();
+    }
+    std::cout << "1000 digest lookups: " << elapsedMs(start) << " ms (" << found << " rows)\n";
+
+    std::filesystem::remove_all(storeDir, ec);
+    return lastBuilds.size() == std::min<std::size_t>(500, buildCount) && found == 1000 ? 0 : 1;
+}
@@ -0,0 +1,62 @@
+#include "telemetry/iso_timestamp.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::string> makeStamps(std::size_t count, std::size_t distinctDays) {
+    std::vector<std::string> stamps;
+    stamps.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const unsigned day = static_cast<unsigned>((i * distinctDays / count) % 28) + 1;
+        const unsigned seconds = static_cast<unsigned>(i % 86400);
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "2025-03-%02uT%02u:%02u:%02uZ",
+                      day, seconds / 3600, (seconds / 60) % 60, seconds % 60);
+        stamps.emplace_back(buffer);
+    }
+    return stamps;
+}
+
+template <typename Fn>
+double nsPerCall(const std::vector<std::string>& stamps, Fn&& parse, double& checksum) {
+    const auto start = std::chrono::steady_clock::now();
+    double sum = 0.0;
+    for (const auto& stamp : stamps) {
+        sum += parse(stamp);
+    }
+    const double elapsed =
+        std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    checksum = sum;
+    return elapsed / static_cast<double>(stamps.size());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    bool consistent = true;
+    double warmup = 0.0;
+    nsPerCall(makeStamps(count, count), clamp::detail::parseIsoTimestampMs, warmup);
+    for (const std::size_t distinctDays : {std::size_t{1}, std::size_t{28}, count}) {
+        const auto stamps = makeStamps(count, distinctDays);
+        double fastSum = 0.0;
+        double localeSum = 0.0;
+        const double fastNs = nsPerCall(stamps, clamp::detail::parseIsoTimestampMs, fastSum);
+        const double localeNs = nsPerCall(stamps, clamp::detail::parseIsoTimestampMsLocale, localeSum);
+        consistent = consistent && fastSum == localeSum;
+        std::cout << "date changes every " << std::setw(8) << count / std::min(distinctDays, count)
+                  << " stamps: fixed-format " << std::fixed << std::setprecision(1) << std::setw(7) << fastNs
+                  << " ns, locale " << std::setw(8) << localeNs << " ns, speedup " << std::setprecision(1)
+                  << localeNs / fastNs << "x\n";
+    }
+    std::cout << "results consistent: " << (consistent ? "yes" : "NO") << '\n';
+    return consistent ? 0 : 1;
+}
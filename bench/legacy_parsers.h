@@ -0,0 +1,115 @@
+#pragma once
+
+// Line-based and DOM-based readers that TemporalAggregator used before
+// TelemetryScanner. Kept here so the benchmarks can compare against them.
+
+#include "telemetry/telemetry_scanner.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <istream>
+#include <string>
+#include <vector>
+
+#if __has_include(<nlohmann/json.hpp>)
+#include <nlohmann/json.hpp>
+#define CLAMP_HAS_NLOHMANN_JSON 1
+#else
+#define CLAMP_HAS_NLOHMANN_JSON 0
+#endif
+
+namespace clamp::bench {
+
+using detail::ParsedRecord;
+using detail::parseIsoTimestampMs;
+
+#if CLAMP_HAS_NLOHMANN_JSON
+inline std::vector<ParsedRecord> parseWithNlohmann(std::istream& stream) {
+    nlohmann::json data = nlohmann::json::parse(stream, nullptr, false);
+    if (data.is_discarded()) {
+        return {};
+    }
+    const auto* records = data.contains("records") ? data["records"].get_ptr<const nlohmann::json::array_t*>() : nullptr;
+    if (records == nullptr) {
+        return {};
+    }
+    std::vector<ParsedRecord> parsed;
+    parsed.reserve(records->size());
+    for (const auto& entry : *records) {
+        ParsedRecord record;
+        if (entry.contains("stability_score")) {
+            record.stabilityScore = entry["stability_score"].get<double>();
+        }
+        if (entry.contains("acquired_at") && entry["acquired_at"].is_string()) {
+            record.timestampMs = parseIsoTimestampMs(entry["acquired_at"].get<std::string>());
+        }
+        if (!std::isfinite(record.timestampMs)) {
+            record.timestampMs = static_cast<double>(parsed.size());
+        }
+        parsed.push_back(record);
+    }
+    return parsed;
+}
+#endif
+
+inline std::vector<ParsedRecord> parseFallback(std::istream& stream) {
+    std::vector<ParsedRecord> parsed;
+    std::string line;
+    ParsedRecord record;
+    bool inRecord = false;
+    while (std::getline(stream, line)) {
+        auto trimmed = line;
+        trimmed.erase(std::remove_if(trimmed.begin(), trimmed.end(), [](unsigned char ch) {
+            return std::isspace(ch);
+        }), trimmed.end());
+        if (trimmed.find('{') != std::string::npos) {
+            inRecord = true;
+            record = ParsedRecord{};
+        }
+        auto keyPos = trimmed.find("\"stability_score\"");
+        if (keyPos != std::string::npos) {
+            const auto colon = trimmed.find(':', keyPos + std::strlen("\"stability_score\""));
+            if (colon != std::string::npos) {
+                auto token = trimmed.substr(colon + 1);
+                std::size_t begin = 0;
+                while (begin < token.size() && std::isspace(static_cast<unsigned char>(token[begin]))) {
+                    ++begin;
+                }
+                std::size_t end = token.size();
+                while (end > begin && (std::isspace(static_cast<unsigned char>(token[end - 1])) ||
+                                        token[end - 1] == ',' || token[end - 1] == '}' || token[end - 1] == ']')) {
+                    --end;
+                }
+                if (begin < end) {
+                    try {
+                        record.stabilityScore = std::stod(token.substr(begin, end - begin));
+                    } catch (...) {
+                    }
+                }
+            }
+        }
+        keyPos = trimmed.find("\"acquired_at\"");
+        if (keyPos != std::string::npos) {
+            const auto colon = trimmed.find(':', keyPos + std::strlen("\"acquired_at\""));
+            if (colon != std::string::npos) {
+                auto firstQuote = trimmed.find('"', colon);
+                auto secondQuote = trimmed.find('"', firstQuote + 1);
+                if (firstQuote != std::string::npos && secondQuote != std::string::npos) {
+                    record.timestampMs = parseIsoTimestampMs(trimmed.substr(firstQuote + 1, secondQuote - firstQuote - 1));
+                }
+            }
+        }
+        if (trimmed.find('}') != std::string::npos && inRecord) {
+            inRecord = false;
+            if (!std::isfinite(record.timestampMs)) {
+                record.timestampMs = static_cast<double>(parsed.size());
+            }
+            parsed.push_back(record);
+        }
+    }
+    return parsed;
+}
+
+} // namespace clamp::bench
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "clamp/TemporalAggregator.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+namespace clamp {
+
+// Long-running counterpart to TemporalAggregator::aggregate(). It watches a
+// telemetry directory (inotify on Linux, periodic polling elsewhere), feeds
+// only the bytes appended to each *.json file since the previous update through
+// a per-file resumable scanner and keeps the directory aggregates in memory, so
+// an update costs time proportional to the new data. The summary file is then
+// rewritten atomically through a temporary file and a rename.
+//
+// Files that shrink, are replaced or are removed cannot be subtracted from the
+// aggregates; they trigger a full rescan so the summary always reflects the
+// directory's current contents.
+class AggregationDaemon {
+public:
+    struct Options {
+        // groupBy, bucketWidth and maxBuckets apply; the per-run options
+        // (workerCount, incremental, batchedIo) are not used.
+        TemporalAggregator::Options aggregation;
+        // Rewritten after every update; empty keeps the summary in memory only.
+        std::filesystem::path summaryPath;
+        std::filesystem::path snapshotPath;
+        // Updates within this interval of the previous write are folded into
+        // the next one, so bursts of appends cost a single rewrite.
+        std::chrono::milliseconds writeInterval{250};
+        // Directory rescan period when inotify is unavailable.
+        std::chrono::milliseconds pollInterval{1000};
+    };
+
+    AggregationDaemon(std::filesystem::path telemetryDir, Options options);
+    ~AggregationDaemon();
+
+    AggregationDaemon(const AggregationDaemon&) = delete;
+    AggregationDaemon& operator=(const AggregationDaemon&) = delete;
+
+    // Scans every file for new bytes once and rewrites the summary if anything
+    // changed. Returns the number of records added.
+    std::size_t refresh();
+
+    // Refreshes, then applies filesystem events until stop() is called.
+    // Returns false if the directory cannot be watched.
+    bool run();
+    // May be called from any thread; run() returns after writing any pending
+    // summary update.
+    void stop();
+
+    // Most recently published summary; safe to call while run() is active.
+    TemporalAggregator::Summary summary() const;
+
+    // Bytes fed to the scanners since construction, and full rescans caused by
+    // truncated, replaced or deleted files.
+    std::uint64_t bytesScanned() const;
+    std::size_t rescans() const;
+
+private:
+    struct State;
+    std::unique_ptr<State> state_;
+};
+
+} // namespace clamp
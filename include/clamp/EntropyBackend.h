@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace clamp {
+
+// What a backend runs on, reported before it has done any work.
+struct EntropyBackendCapabilities {
+    // Runs on an accelerator rather than on the host.
+    bool device{false};
+    // Parallel units the mirror is spread over: host threads, or the compute
+    // units of a device.
+    std::size_t workerCount{1};
+    // Compare kernel: "scalar", "sse2", "avx2" or "hip".
+    std::string kernel;
+};
+
+// One way of running the entropy mirror: seeds and states are copied through
+// the backend and compared against their source. mirror() may be called from
+// several threads at once.
+class EntropyBackend {
+public:
+    virtual ~EntropyBackend() = default;
+
+    // Identifier used for selection: "cpu-scalar", "cpu-parallel" or "hip".
+    virtual const char* name() const = 0;
+    // Backend and device names recorded in telemetry, e.g. "CPU" / "host".
+    virtual std::string telemetryBackend() const = 0;
+    virtual std::string deviceName() const = 0;
+    virtual EntropyBackendCapabilities capabilities() const = 0;
+
+    // Whether the mirrored buffers match their source; false when the sizes
+    // differ. nullopt when the backend could not run (e.g. a device call
+    // failed), in which case nothing is counted towards the throughput.
+    std::optional<bool> mirror(const std::vector<std::uint64_t>& seeds, const std::vector<int>& states);
+
+    // Entries per second measured over every completed mirror() call; 0
+    // before the first one.
+    double measuredThroughput() const;
+    std::uint64_t mirroredEntries() const { return entries_.load(std::memory_order_relaxed); }
+
+protected:
+    // Called with equally sized, non-empty buffers.
+    virtual std::optional<bool> run(const std::uint64_t* seeds, const int* states, std::size_t count) = 0;
+
+private:
+    std::atomic<std::uint64_t> entries_{0};
+    std::atomic<std::uint64_t> nanoseconds_{0};
+};
+
+// Backend names compiled into this build, in order of preference.
+std::vector<std::string> entropyBackendNames();
+
+// Creates the named backend; "auto" picks the first available one. nullptr
+// when the name is unknown or the backend cannot run on this host (no HIP
+// device, or HIP not compiled in). workerCount applies to "cpu-parallel"; 0
+// selects hardware_concurrency().
+std::unique_ptr<EntropyBackend> makeEntropyBackend(std::string_view name, std::size_t workerCount = 0);
+
+// Every backend that can run on this host, in order of preference.
+std::vector<std::unique_ptr<EntropyBackend>> availableEntropyBackends(std::size_t workerCount = 0);
+
+// Backend used by runHipEntropyMirror. Until one is selected it is chosen from
+// the CLAMP_ENTROPY_BACKEND environment variable, falling back to "auto" when
+// the variable is unset or names a backend that is not available.
+std::shared_ptr<EntropyBackend> activeEntropyBackend();
+
+// Replaces the active backend; false (and the active backend is kept) when
+// the name cannot be created on this host.
+bool selectEntropyBackend(std::string_view name);
+
+// Re-reads CLAMP_ENTROPY_BACKEND; false when it is set to a backend that is
+// not available, in which case "auto" is selected.
+bool selectEntropyBackendFromEnvironment();
+
+} // namespace clamp
@@ -1,12 +1,16 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <deque>
 #include <filesystem>
+#include <functional>
 #include <mutex>
 #include <optional>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace clamp {
@@ -23,16 +27,144 @@ struct AnchorTelemetryRecord {
     std::string deviceName;
 };
 
+// Self-reported cost of an EntropyTelemetry instance. Memory figures are a
+// snapshot; call/time counters are cumulative. Acquire/release timings are
+// sampled once every kOverheadSampleInterval calls, lock waits are only timed
+// when the uncontended try_lock fails.
+struct TelemetryOverhead {
+    std::size_t recordCount{0};
+    std::size_t recordBytes{0};
+    std::size_t stringBytes{0};
+    std::uint64_t acquireCalls{0};
+    std::uint64_t acquireSamples{0};
+    std::uint64_t acquireSampledNs{0};
+    std::uint64_t releaseCalls{0};
+    std::uint64_t releaseSamples{0};
+    std::uint64_t releaseSampledNs{0};
+    std::uint64_t serializationCount{0};
+    std::uint64_t serializationNs{0};
+    std::uint64_t serializedBytes{0};
+    std::uint64_t lockAcquisitions{0};
+    std::uint64_t lockContentions{0};
+    std::uint64_t lockWaitNs{0};
+
+    std::size_t totalBytes() const;
+    double estimatedAcquireNs() const;
+    double estimatedReleaseNs() const;
+    std::string toJson() const;
+};
+
+// A shift in a context's hold durations, found by the Page-Hinkley detector on
+// EntropyTelemetry's release path and written to the `change_points` array of
+// the telemetry JSON.
+struct TelemetryChangePoint {
+    std::string context;
+    // Index of the record whose release triggered detection.
+    std::size_t recordIndex{0};
+    std::chrono::system_clock::time_point detectedAt{};
+    // Mean duration of the context before the shift, and the duration that
+    // crossed the threshold.
+    double baselineMs{0.0};
+    double observedMs{0.0};
+    bool increase{true};
+};
+
+// The stability score EntropyTelemetry gives each release of a context. A
+// duration is scored against the exponentially weighted mean and variance of
+// the earlier ones: the first sample scores 1.0 and one three (floored)
+// standard deviations away scores 0.5. O(1) time and memory per sample.
+class ReleaseScorer {
+public:
+    // Scores `durationMs`, then folds it into the rolling statistics.
+    double observe(double durationMs);
+    // Rolling standard deviation of the durations observed so far.
+    double spreadMs() const;
+    double meanMs() const { return mean_; }
+    std::uint64_t count() const { return count_; }
+
+private:
+    double mean_{0.0};
+    double variance_{0.0};
+    std::uint64_t count_{0};
+};
+
+// Page-Hinkley parameters, in standard deviations of the context's durations,
+// so one setting fits microsecond and second-long holds and noisy contexts do
+// not alarm on their own tails. Deviations below `tolerance` are ignored; an
+// alarm fires once the cumulative deviation exceeds `threshold`. Each context
+// first learns its baseline from `warmup` releases, and starts over after
+// every alarm.
+struct ChangePointOptions {
+    bool enabled{true};
+    double tolerance{0.5};
+    double threshold{20.0};
+    std::uint64_t warmup{30};
+};
+
+// The two-sided Page-Hinkley test EntropyTelemetry runs on each context's hold
+// durations. O(1) time and memory per sample.
+class ChangePointDetector {
+public:
+    struct Shift {
+        // Mean duration of the regime before the shift.
+        double baselineMs{0.0};
+        bool increase{true};
+    };
+
+    // `spreadMs` is the standard deviation of the stream before this sample;
+    // EntropyTelemetry passes the context's rolling one. After a shift the
+    // detector learns the new regime from scratch.
+    std::optional<Shift> observe(double durationMs, double spreadMs, const ChangePointOptions& options);
+
+private:
+    double regimeMean_{0.0};
+    std::uint64_t regimeCount_{0};
+    // Cumulative deviations above / below the regime mean and their running
+    // minimum / maximum.
+    double upSum_{0.0};
+    double upMin_{0.0};
+    double downSum_{0.0};
+    double downMax_{0.0};
+};
+
+// Codec for files written by EntropyTelemetry::writeJSON. Gzip needs zlib and
+// Zstd needs libzstd at configure time; TemporalAggregator reads both
+// (*.json.gz, *.json.zst) directly.
+enum class TelemetryCompression {
+    None,
+    Gzip,
+    Zstd
+};
+
 class EntropyTelemetry {
 public:
+    static constexpr std::uint64_t kOverheadSampleInterval = 64;
+    // Change points kept for changePoints() and toJson(); older ones are only
+    // counted.
+    static constexpr std::size_t kRetainedChangePoints = 256;
+
     std::size_t recordAcquire(const std::string& context, std::uint64_t seed);
     void recordRelease(std::size_t recordId,
                        const std::string& context,
                        std::uint64_t seed,
                        double stabilityScore);
+    // Scores the release with the context's ReleaseScorer.
+    void recordRelease(std::size_t recordId, const std::string& context, std::uint64_t seed);
+
+    // Change-point detection runs on scored releases (the recordRelease
+    // overload without a score, used by ClampAnchor) in O(1) time and memory
+    // per context. The callback runs on the releasing thread after the
+    // telemetry lock is dropped, so it may call back into this instance.
+    void setChangePointOptions(ChangePointOptions options);
+    void setChangePointCallback(std::function<void(const TelemetryChangePoint&)> callback);
+    // The latest kRetainedChangePoints change points, oldest first, and the
+    // number detected in total.
+    std::vector<TelemetryChangePoint> changePoints() const;
+    std::uint64_t changePointCount() const;
 
     std::string toJson() const;
     std::vector<AnchorTelemetryRecord> records() const;
+    TelemetryOverhead overhead() const;
 
     void merge(const EntropyTelemetry& other);
     void mergeRecords(const std::vector<AnchorTelemetryRecord>& externalRecords);
@@ -44,6 +176,12 @@ public:
     static void setActiveInstance(EntropyTelemetry* telemetry);
     static EntropyTelemetry* activeInstance();
 
+    // Compresses writeJSON output and appends ".gz" / ".zst" to the file name.
+    // writeJSON fails when the codec is not available in this build.
+    void setCompression(TelemetryCompression compression);
+    TelemetryCompression compression() const;
+    static bool compressionSupported(TelemetryCompression compression);
+
     bool writeJSON(const std::filesystem::path& directory = std::filesystem::path{"telemetry"},
                    const std::string& filenameHint = "clamp_run") const;
     bool writeJson(const std::filesystem::path& directory = std::filesystem::path{"telemetry"},
@@ -56,10 +194,51 @@ private:
     static std::string threadIdToString(const std::thread::id& threadId);
     static std::string makeFilename(const std::string& hint);
 
+    struct OverheadCounters {
+        std::atomic<std::uint64_t> acquireCalls{0};
+        std::atomic<std::uint64_t> acquireSamples{0};
+        std::atomic<std::uint64_t> acquireSampledNs{0};
+        std::atomic<std::uint64_t> releaseCalls{0};
+        std::atomic<std::uint64_t> releaseSamples{0};
+        std::atomic<std::uint64_t> releaseSampledNs{0};
+        std::atomic<std::uint64_t> serializationCount{0};
+        std::atomic<std::uint64_t> serializationNs{0};
+        std::atomic<std::uint64_t> serializedBytes{0};
+        std::atomic<std::uint64_t> lockAcquisitions{0};
+        std::atomic<std::uint64_t> lockContentions{0};
+        std::atomic<std::uint64_t> lockWaitNs{0};
+    };
+
+    // Rolling duration statistics of one context, plus its change detector.
+    struct ContextDurationStats {
+        ReleaseScorer scorer;
+        ChangePointDetector detector;
+    };
+
+    AnchorTelemetryRecord* releaseLocked(std::size_t recordId,
+                                         const std::string& context,
+                                         std::uint64_t seed,
+                                         std::chrono::system_clock::time_point now);
+    ContextDurationStats& contextStatsLocked(const std::string& context);
+
+    std::unique_lock<std::mutex> lockRecords() const;
+    TelemetryOverhead overheadLocked() const;
+
     mutable std::mutex mutex_;
+    mutable OverheadCounters counters_;
     std::vector<AnchorTelemetryRecord> records_;
     std::string backend_{"CPU"};
     std::string deviceName_{"host"};
+    std::atomic<TelemetryCompression> compression_{TelemetryCompression::None};
+    std::unordered_map<std::string, ContextDurationStats> contextStats_;
+    // Most recently scored context; consecutive releases usually share it,
+    // so the hash lookup is skipped. Map nodes never move or get erased.
+    const std::string* lastContext_{nullptr};
+    ContextDurationStats* lastContextStats_{nullptr};
+    ChangePointOptions changePointOptions_;
+    std::function<void(const TelemetryChangePoint&)> changePointCallback_;
+    std::deque<TelemetryChangePoint> changePoints_;
+    std::uint64_t changePointCount_{0};
     static EntropyTelemetry* activeTelemetry_;
 };
 
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "clamp/EntropyTelemetry.h"
+#include "clamp/TemporalScoring.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace clamp {
+
+// Maintains the TemporalScoring components (entropy variance, duration
+// variance, drift) over a sliding window of the most recent records, for live
+// services that want their current stability without keeping every record.
+// add() is O(1) amortised and current() is O(1). Not thread-safe; callers
+// serialise access.
+class StreamingTemporalScorer {
+public:
+    struct Options {
+        // Keep at most this many records; 0 removes the count limit.
+        std::size_t maxRecords{1024};
+        // Keep records acquired within this span of the newest acquired_at;
+        // zero removes the time limit. Records leave the window in arrival
+        // order, so a late record is evicted once it is the oldest arrival
+        // and falls outside the span. Records without acquired_at are dated
+        // by the newest timestamp seen when they arrive.
+        std::chrono::milliseconds window{0};
+    };
+
+    StreamingTemporalScorer();
+    explicit StreamingTemporalScorer(Options options);
+    ~StreamingTemporalScorer();
+    StreamingTemporalScorer(StreamingTemporalScorer&&) noexcept;
+    StreamingTemporalScorer& operator=(StreamingTemporalScorer&&) noexcept;
+
+    void add(const AnchorTelemetryRecord& record);
+    // acquiredAtNs is nanoseconds since the Unix epoch; 0 means not set.
+    void add(std::uint64_t seed, double durationMs, std::int64_t acquiredAtNs);
+
+    // Matches TemporalScoring::evaluate over the records currently in the
+    // window, up to rounding.
+    TemporalScoringResult current() const;
+
+    std::size_t size() const;
+    void clear();
+
+private:
+    struct State;
+    std::unique_ptr<State> state_;
+};
+
+} // namespace clamp
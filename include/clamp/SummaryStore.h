@@ -0,0 +1,87 @@
+#pragma once
+
+#include "clamp/TemporalAggregator.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace clamp {
+
+// Append-only history of aggregated summaries, one fixed-size binary row per
+// CI run, with an index on build time and build digest. Rows live in
+// <dir>/summaries.rows; the sorted index lives in <dir>/summaries.idx and is
+// brought up to date on open(), so range queries over thousands of builds
+// only touch the matching rows. A store has a single writer.
+class SummaryStore {
+public:
+    struct Row {
+        // Build time in milliseconds since the Unix epoch (build_info.resolved_at
+        // when present).
+        std::int64_t timestampMs{0};
+        // Truncated to kMaxDigestLength bytes.
+        std::string digest;
+        std::size_t sessionCount{0};
+        double meanStability{0.0};
+        double stabilityVariance{0.0};
+        double driftIndex{0.0};
+        double stabilityP50{0.0};
+        double stabilityP99{0.0};
+        double durationP50{0.0};
+        double durationP99{0.0};
+    };
+
+    static constexpr std::size_t kMaxDigestLength = 79;
+
+    // Loads rows and the index from `directory`, creating it if needed.
+    bool open(const std::filesystem::path& directory);
+
+    bool append(const Row& row);
+    bool append(const TemporalAggregator::Summary& summary, std::string_view digest, std::int64_t timestampMs);
+    // Imports a telemetry_summary.json written by TemporalAggregator::writeSummary.
+    // The row time is build_info.resolved_at, or the file's mtime without it.
+    bool appendSummaryFile(const std::filesystem::path& summaryPath);
+
+    // Rows with fromMs <= timestampMs < toMs, in time order.
+    std::vector<Row> range(std::int64_t fromMs, std::int64_t toMs) const;
+    // The `count` most recent rows, oldest first.
+    std::vector<Row> latest(std::size_t count) const;
+    // Rows for one build digest, in time order.
+    std::vector<Row> findDigest(std::string_view digest) const;
+
+    std::size_t size() const;
+
+    static std::string toJson(const std::vector<Row>& rows);
+    static bool exportJson(const std::vector<Row>& rows, const std::filesystem::path& outputPath);
+
+private:
+    // Persisted as-is, so padding is explicit.
+    struct TimeEntry {
+        std::int64_t timestampMs;
+        std::uint32_t row;
+        std::uint32_t reserved;
+    };
+
+    struct DigestEntry {
+        std::uint64_t hash;
+        std::uint32_t row;
+        std::uint32_t reserved;
+    };
+
+    Row rowAt(std::uint32_t index) const;
+    TimeEntry timeEntry(std::uint32_t index) const;
+    DigestEntry digestEntry(std::uint32_t index) const;
+    void indexRow(std::uint32_t index);
+    bool saveIndex() const;
+
+    std::filesystem::path directory_;
+    // Raw fixed-size rows exactly as stored on disk.
+    std::string rows_;
+    std::vector<TimeEntry> byTime_;
+    std::vector<DigestEntry> byDigest_;
+};
+
+} // namespace clamp
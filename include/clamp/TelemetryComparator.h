@@ -2,15 +2,50 @@
 
 #include "clamp/TemporalAggregator.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
+#include <string>
 #include <vector>
 
 namespace clamp {
 
+// Compares telemetry summaries written by TemporalAggregator::writeSummary
+// across backends. A summary belongs to the backend and device named by its
+// top-level "backend" / "device_name" keys, or else by its groups when they
+// all share one (Options::groupBy.backend / deviceName); otherwise both are
+// "@unknown".
 class TelemetryComparator {
 public:
+    struct Options {
+        // Files are parsed, and bootstrap replicates drawn, on this many
+        // threads; 0 selects hardware_concurrency(). Results are identical for
+        // every worker count.
+        std::size_t workerCount{0};
+        // Drift skews beyond +/- this many milliseconds are significant.
+        double driftSignificanceMs{5.0};
+        // bootstrap(): replicates per backend, two-sided confidence level of
+        // the intervals, and the seed of the counter-based generator.
+        std::size_t resamples{10000};
+        double confidence{0.95};
+        std::uint64_t seed{0};
+    };
+
+    // One side against another: meanDelta and driftSkew (ms) are differences,
+    // varianceRatio is a quotient (1 when both variances are zero, infinite
+    // when only the other side's is).
+    struct Comparison {
+        double meanDelta{0.0};
+        double driftSkew{0.0};
+        double varianceRatio{1.0};
+        bool driftSignificant{false};
+    };
+
+    // One summary file, compared against the baseline summary.
     struct Entry {
         std::filesystem::path path;
+        std::string backend;
+        std::string deviceName;
         TemporalAggregator::Summary summary;
         double meanDelta{0.0};
         double driftSkew{0.0};
@@ -18,14 +53,101 @@ public:
         bool driftSignificant{false};
     };
 
+    // All summaries of one backend/device pooled: session-weighted mean and
+    // drift index, and the variance of the combined sessions.
+    struct Backend {
+        std::string backend;
+        std::string deviceName;
+        std::size_t summaryCount{0};
+        std::size_t sessionCount{0};
+        double meanStability{0.0};
+        double stabilityVariance{0.0};
+        double driftIndex{0.0};
+    };
+
     struct Result {
         std::string baselineBackend;
+        // Summaries that could be read, in input order; unreadable paths are
+        // skipped.
         std::vector<Entry> entries;
+        // Ordered by backend, then device name.
+        std::vector<Backend> backends;
+        // Row-major backends.size() x backends.size(): cell (i, j) compares
+        // backends[i] against backends[j].
+        std::vector<Comparison> matrix;
+        bool wroteOutput{false};
+
+        const Comparison& at(std::size_t row, std::size_t column) const {
+            return matrix[row * backends.size() + column];
+        }
+    };
+
+    // Per-record samples of one backend/device for bootstrap().
+    struct BackendRecords {
+        std::string backend;
+        std::string deviceName;
+        std::vector<double> stability;
+        std::vector<double> durationMs;
+    };
+
+    // Observed difference with its bootstrap percentile interval; significant
+    // when the interval excludes zero.
+    struct Interval {
+        double estimate{0.0};
+        double lower{0.0};
+        double upper{0.0};
+        bool significant{false};
+    };
+
+    struct BootstrapComparison {
+        Interval meanStabilityDelta;
+        Interval meanDurationDeltaMs;
+    };
+
+    struct BootstrapBackend {
+        std::string backend;
+        std::string deviceName;
+        std::size_t recordCount{0};
+        double meanStability{0.0};
+        double meanDurationMs{0.0};
+    };
+
+    struct BootstrapResult {
+        // Ordered by backend, then device name.
+        std::vector<BootstrapBackend> backends;
+        // Row-major backends.size() x backends.size(): cell (i, j) is
+        // backends[i] minus backends[j].
+        std::vector<BootstrapComparison> matrix;
+        std::size_t resamples{0};
+        double confidence{0.0};
         bool wroteOutput{false};
+
+        const BootstrapComparison& at(std::size_t row, std::size_t column) const {
+            return matrix[row * backends.size() + column];
+        }
     };
 
+    TelemetryComparator() = default;
+    explicit TelemetryComparator(Options options) : options_(options) {}
+
+    // The baseline is the first CPU or host summary, else the first one read.
+    // The report is written to outputPath unless it is empty.
     Result compare(const std::vector<std::filesystem::path>& summaryPaths,
                    const std::filesystem::path& outputPath) const;
+
+    // Significance from raw records instead of summaries: reads EntropyTelemetry
+    // files (plain, .gz or .zst) in parallel, keeps records with a finite
+    // stability_score and duration_ms, and bootstraps the differences in mean
+    // stability and mean duration between every pair of backends. Each
+    // backend is resampled Options::resamples times with Poisson(1) weights
+    // drawn from a counter-based hash, on Options::workerCount threads;
+    // results depend on the seed but not on the worker count.
+    BootstrapResult bootstrap(const std::vector<std::filesystem::path>& telemetryPaths,
+                              const std::filesystem::path& outputPath) const;
+    BootstrapResult bootstrap(std::vector<BackendRecords> records, const std::filesystem::path& outputPath) const;
+
+private:
+    Options options_;
 };
 
 } // namespace clamp
@@ -1,28 +1,153 @@
 #pragma once
 
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
+#include <optional>
 #include <string>
+#include <vector>
 
 namespace clamp {
 
 class TemporalAggregator {
 public:
+    // Fields not selected in Options::groupBy are left empty. Values are kept
+    // exactly as they appear (JSON-escaped) in the telemetry files.
+    struct GroupKey {
+        std::string context;
+        std::string backend;
+        std::string deviceName;
+        std::string threadId;
+
+        bool operator==(const GroupKey&) const = default;
+    };
+
+    // Tail estimates from mergeable t-digest sketches (compression 100); zero
+    // when no samples were seen.
+    struct Quantiles {
+        double p50{0.0};
+        double p90{0.0};
+        double p99{0.0};
+        double p999{0.0};
+    };
+
+    struct GroupSummary {
+        GroupKey key;
+        double meanStability{0.0};
+        double stabilityVariance{0.0};
+        double driftIndex{0.0};
+        std::size_t sessionCount{0};
+        Quantiles stabilityQuantiles;
+        Quantiles durationQuantiles;
+    };
+
+    struct TimeBucket {
+        // Inclusive start of the bucket in milliseconds since the Unix epoch;
+        // the bucket covers [startMs, startMs + Summary::bucketWidthMs).
+        std::int64_t startMs{0};
+        std::size_t sessionCount{0};
+        double meanStability{0.0};
+        double stabilityVariance{0.0};
+        double meanDurationMs{0.0};
+        double durationVariance{0.0};
+        Quantiles stabilityQuantiles;
+        Quantiles durationQuantiles;
+    };
+
     struct Summary {
         double meanStability{0.0};
         double stabilityVariance{0.0};
         double driftIndex{0.0};
         std::size_t sessionCount{0};
+        Quantiles stabilityQuantiles;
+        Quantiles durationQuantiles;
+        // Per-group statistics ordered by key; empty unless Options::groupBy
+        // selects at least one field.
+        std::vector<GroupSummary> groups;
+        // Time-ordered rollup of records with a parsable acquired_at; empty
+        // unless Options::bucketWidth is set. The width may be a power-of-two
+        // multiple of the requested one when maxBuckets forced coarsening.
+        std::vector<TimeBucket> timeBuckets;
+        std::int64_t bucketWidthMs{0};
+    };
+
+    struct GroupBy {
+        bool context{false};
+        bool backend{false};
+        bool deviceName{false};
+        bool threadId{false};
+
+        bool any() const { return context || backend || deviceName || threadId; }
+    };
+
+    struct Options {
+        // Files are parsed on this many threads; 0 selects hardware_concurrency().
+        // Summaries are identical for every worker count.
+        std::size_t workerCount{0};
+        // Reuse per-file partial statistics from a sidecar cache and only parse
+        // files whose size, mtime or inode changed since the previous run.
+        bool incremental{false};
+        // Cache location; empty selects <telemetryDir>/.clamp_aggregate.cache.
+        std::filesystem::path cachePath;
+        // Read files in batches (io_uring on Linux, a thread pool elsewhere)
+        // while the previous batch is parsed. Files above 8 MiB are still
+        // streamed through mmap.
+        bool batchedIo{false};
+        // Also summarise records per combination of the selected fields, in
+        // the same pass over the files.
+        GroupBy groupBy;
+        // Roll records up into fixed-width buckets of acquired_at (e.g. 1s,
+        // 1min, 1h); zero disables. If more than maxBuckets would be needed the
+        // width is doubled until they fit, which bounds memory for any span.
+        std::chrono::milliseconds bucketWidth{0};
+        std::size_t maxBuckets{4096};
+    };
+
+    // Which files and records aggregate() looks at. Record predicates are
+    // evaluated while scanning, so rejected records are never materialised;
+    // with Options::incremental, files whose cached acquired_at range lies
+    // outside the window are skipped without being opened.
+    struct Query {
+        // Also aggregate *.json files in subdirectories.
+        bool recursive{false};
+        // Glob patterns over the path relative to telemetryDir ('/'-separated).
+        // '*' and '?' stay within one path component, '**' spans any number
+        // of them and '[...]' matches a character class. A pattern without
+        // '/' is matched against the file name only. An empty include list
+        // accepts every *.json file; exclude also prunes whole directories.
+        std::vector<std::string> include;
+        std::vector<std::string> exclude;
+        // Half-open window [fromMs, toMs) on acquired_at in milliseconds since
+        // the Unix epoch. With either bound set, records without a parsable
+        // acquired_at are dropped.
+        std::optional<std::int64_t> fromMs;
+        std::optional<std::int64_t> toMs;
+        // Keep only records whose context / backend is listed, compared as they
+        // appear (JSON-escaped) in the files; empty accepts every value.
+        std::vector<std::string> contexts;
+        std::vector<std::string> backends;
     };
 
     TemporalAggregator() = default;
+    explicit TemporalAggregator(Options options);
 
     Summary aggregate(const std::filesystem::path& telemetryDir);
+    Summary aggregate(const std::filesystem::path& telemetryDir, const Query& query);
+
+    static std::filesystem::path defaultCachePath(const std::filesystem::path& telemetryDir);
 
     bool writeSummary(const Summary& summary,
                       const std::filesystem::path& outputPath,
                       const std::string& sourceDirectory,
                       const std::filesystem::path& snapshotPath = {}) const;
+
+    // Writes Summary::timeBuckets as a columnar JSON document (one array per
+    // metric) that dashboards can load without per-row parsing.
+    bool writeTimeSeries(const Summary& summary, const std::filesystem::path& outputPath) const;
+
+private:
+    Options options_;
 };
 
 } // namespace clamp
@@ -2,6 +2,11 @@
 
 #include "clamp/EntropyTelemetry.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -18,10 +23,166 @@ struct TemporalScoringResult {
     std::string toText() const;
 };
 
-class TemporalScoring {
+// Structure-of-arrays view of the fields TemporalScoring reads, for callers
+// that already hold telemetry in columns. All arrays have `size` elements;
+// timestamps are nanoseconds since the Unix epoch, with 0 meaning "not set"
+// (those records do not count towards drift).
+struct TemporalColumns {
+    const std::uint64_t* seeds{nullptr};
+    const double* durationsMs{nullptr};
+    const std::int64_t* acquiredAtNs{nullptr};
+    std::size_t size{0};
+};
+
+// How BasicTemporalScoring turns its three components into a score. A policy
+// is any type with these static constexpr members. Disabled components are not
+// gathered by the kernel at all and report 0; the penalty is the weighted mean
+// of the enabled ones. Variances are normalised by (|mean| + kVarianceOffset)^2
+// and drift by kDriftScaleMs, each clamped to [0, 1].
+struct DefaultScoringPolicy {
+    static constexpr bool kEntropy = true;
+    static constexpr bool kDuration = true;
+    static constexpr bool kDrift = true;
+    static constexpr double kEntropyWeight = 1.0;
+    static constexpr double kDurationWeight = 1.0;
+    static constexpr double kDriftWeight = 1.0;
+    static constexpr double kVarianceOffset = 1.0;
+    static constexpr double kDriftScaleMs = 1000.0;
+};
+
+namespace detail {
+
+// Count, mean and sum of squared deviations of seeds and durations, plus the
+// acquisition time range in nanoseconds (minStampNs > maxStampNs when no
+// record has one). Fields of disabled components are left zero.
+struct ScoringMoments {
+    std::size_t count{0};
+    double seedMean{0.0};
+    double seedM2{0.0};
+    double durationMean{0.0};
+    double durationM2{0.0};
+    std::int64_t minStampNs{0};
+    std::int64_t maxStampNs{-1};
+};
+
+// The single-pass kernel, instantiated in TemporalScoring.cpp for every
+// combination of enabled components.
+template <bool Entropy, bool Duration, bool Drift>
+ScoringMoments scoringMoments(const std::vector<AnchorTelemetryRecord>& records);
+template <bool Entropy, bool Duration, bool Drift>
+ScoringMoments scoringMoments(const TemporalColumns& columns);
+
+// Scores groups on `workerCount` threads and averages them in group order.
+TemporalScoringResult averageGroupScores(std::size_t groupCount,
+                                         std::size_t totalRecords,
+                                         std::size_t workerCount,
+                                         const std::function<TemporalScoringResult(std::size_t)>& scoreGroup);
+
+inline double clamp01(double value) {
+    return std::clamp(value, 0.0, 1.0);
+}
+
+} // namespace detail
+
+template <typename Policy = DefaultScoringPolicy>
+class BasicTemporalScoring {
 public:
-    TemporalScoringResult evaluate(const std::vector<AnchorTelemetryRecord>& records) const;
-    TemporalScoringResult evaluateAggregated(const std::vector<std::vector<AnchorTelemetryRecord>>& groupedRecords) const;
+    static_assert(Policy::kEntropy || Policy::kDuration || Policy::kDrift,
+                  "a scoring policy needs at least one component");
+
+    struct Options {
+        // evaluateAggregated scores groups on this many threads; 0 selects
+        // hardware_concurrency(). Results are identical for every worker count.
+        std::size_t workerCount{0};
+    };
+
+    BasicTemporalScoring() = default;
+    explicit BasicTemporalScoring(Options options) : options_(options) {}
+
+    // Mean, variance and the acquisition time range are gathered in a single
+    // pass without copying the records.
+    TemporalScoringResult evaluate(const std::vector<AnchorTelemetryRecord>& records) const {
+        return score(detail::scoringMoments<Policy::kEntropy, Policy::kDuration, Policy::kDrift>(records));
+    }
+
+    TemporalScoringResult evaluate(const TemporalColumns& columns) const {
+        return score(detail::scoringMoments<Policy::kEntropy, Policy::kDuration, Policy::kDrift>(columns));
+    }
+
+    // Scores each group independently and averages the results. Groups are
+    // evaluated in parallel but summed in group order.
+    TemporalScoringResult evaluateAggregated(const std::vector<std::vector<AnchorTelemetryRecord>>& groupedRecords) const {
+        std::size_t totalRecords = 0;
+        for (const auto& group : groupedRecords) {
+            totalRecords += group.size();
+        }
+        return detail::averageGroupScores(groupedRecords.size(), totalRecords, options_.workerCount,
+                                          [&](std::size_t group) { return evaluate(groupedRecords[group]); });
+    }
+
+    // Same for one columnar record set: group g spans records
+    // [groupOffsets[g], groupOffsets[g + 1]), so n groups take n + 1 offsets.
+    // Offsets past columns.size are clamped.
+    TemporalScoringResult evaluateAggregated(const TemporalColumns& columns,
+                                             const std::vector<std::size_t>& groupOffsets) const {
+        const std::size_t groupCount = groupOffsets.empty() ? 0 : groupOffsets.size() - 1;
+        return detail::averageGroupScores(groupCount, columns.size, options_.workerCount, [&](std::size_t group) {
+            const std::size_t begin = std::min(groupOffsets[group], columns.size);
+            const std::size_t end = std::clamp(groupOffsets[group + 1], begin, columns.size);
+            // Columns a policy does not read may be null and must stay null.
+            const auto slice = [begin](auto* column) { return column ? column + begin : column; };
+            return evaluate(TemporalColumns{slice(columns.seeds), slice(columns.durationsMs),
+                                            slice(columns.acquiredAtNs), end - begin});
+        });
+    }
+
+    // Scores precomputed moments, e.g. from a streaming window.
+    static TemporalScoringResult score(const detail::ScoringMoments& moments) {
+        TemporalScoringResult result;
+        result.sampleCount = moments.count;
+        if (moments.count == 0) {
+            result.stabilityScore = 1.0;
+            return result;
+        }
+
+        double penalty = 0.0;
+        if constexpr (Policy::kEntropy) {
+            result.entropyVariance = detail::clamp01(normalizedVariance(moments.count, moments.seedMean, moments.seedM2));
+            penalty += Policy::kEntropyWeight * result.entropyVariance;
+        }
+        if constexpr (Policy::kDuration) {
+            result.durationVariance =
+                detail::clamp01(normalizedVariance(moments.count, moments.durationMean, moments.durationM2));
+            penalty += Policy::kDurationWeight * result.durationVariance;
+        }
+        if constexpr (Policy::kDrift) {
+            if (moments.minStampNs <= moments.maxStampNs) {
+                result.driftMs = static_cast<double>(moments.maxStampNs - moments.minStampNs) / 1e6;
+            }
+            penalty += Policy::kDriftWeight * detail::clamp01(result.driftMs / Policy::kDriftScaleMs);
+        }
+        result.stabilityScore = detail::clamp01(1.0 - penalty / kWeightSum);
+        return result;
+    }
+
+private:
+    static constexpr double kWeightSum = (Policy::kEntropy ? Policy::kEntropyWeight : 0.0) +
+                                         (Policy::kDuration ? Policy::kDurationWeight : 0.0) +
+                                         (Policy::kDrift ? Policy::kDriftWeight : 0.0);
+    static_assert(kWeightSum > 0.0, "scoring policy weights must not all be zero");
+
+    // Sample variance scaled by (|mean| + kVarianceOffset)^2.
+    static double normalizedVariance(std::size_t count, double mean, double m2) {
+        if (count < 2) {
+            return 0.0;
+        }
+        const double scale = std::abs(mean) + Policy::kVarianceOffset;
+        return m2 / static_cast<double>(count - 1) / (scale * scale);
+    }
+
+    Options options_;
 };
 
+using TemporalScoring = BasicTemporalScoring<>;
+
 } // namespace clamp
@@ -126,8 +126,7 @@ void ClampAnchor::release_internal(const char* sourceTag) {
     setState(AnchorState::Unlocked,
              std::string(sourceTag) + " anchor reset to unlocked");
     if (telemetry_ && activeTelemetryRecord_) {
-        constexpr double kStableScore = 1.0;
-        telemetry_->recordRelease(*activeTelemetryRecord_, ctx, seedSnapshot, kStableScore);
+        telemetry_->recordRelease(*activeTelemetryRecord_, ctx, seedSnapshot);
     }
     activeTelemetryRecord_.reset();
 }
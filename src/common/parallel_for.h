@@ -0,0 +1,79 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace clamp::detail {
+
+inline std::size_t resolveWorkerCount(std::size_t requested) {
+    if (requested != 0) {
+        return requested;
+    }
+    const unsigned int hardware = std::thread::hardware_concurrency();
+    return hardware == 0 ? 1 : static_cast<std::size_t>(hardware);
+}
+
+// Runs fn(index) for every index in [0, count). Workers claim `grain`-sized
+// chunks from a shared cursor, so idle workers keep pulling work until the
+// range is drained. The calling thread participates as one of the workers.
+// The first exception thrown by fn is rethrown once all workers have joined.
+template <typename Fn>
+void parallelFor(std::size_t count, std::size_t workers, Fn&& fn, std::size_t grain = 1) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max<std::size_t>(grain, 1);
+    const std::size_t chunks = (count + grain - 1) / grain;
+    workers = std::min(resolveWorkerCount(workers), chunks);
+    if (workers <= 1) {
+        for (std::size_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    std::atomic<std::size_t> cursor{0};
+    std::exception_ptr failure;
+    std::mutex failureMutex;
+    auto drain = [&]() {
+        for (;;) {
+            const std::size_t begin = cursor.fetch_add(grain, std::memory_order_relaxed);
+            if (begin >= count) {
+                return;
+            }
+            const std::size_t end = std::min(count, begin + grain);
+            try {
+                for (std::size_t i = begin; i < end; ++i) {
+                    fn(i);
+                }
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(failureMutex);
+                if (!failure) {
+                    failure = std::current_exception();
+                }
+                cursor.store(count, std::memory_order_relaxed);
+                return;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (std::size_t i = 1; i < workers; ++i) {
+        threads.emplace_back(drain);
+    }
+    drain();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+} // namespace clamp::detail
@@ -0,0 +1,154 @@
+#include "clamp/StreamingTemporalScorer.h"
+
+#include "../telemetry/running_stats.h"
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+
+namespace clamp {
+
+namespace {
+
+struct Sample {
+    double seed;
+    double durationMs;
+    // Time the window compares against its span when evicting.
+    std::int64_t evictAtNs;
+};
+
+struct Extreme {
+    std::uint64_t sequence;
+    std::int64_t acquiredAtNs;
+};
+
+// Running moments are rebuilt from the window after at least this many
+// evictions (and at least as many as the window holds), which bounds the
+// rounding error of repeated RunningStats::remove at O(1) amortised cost.
+constexpr std::size_t kMinRebuildInterval = 64;
+constexpr std::int64_t kNoStamp = std::numeric_limits<std::int64_t>::min();
+
+} // namespace
+
+struct StreamingTemporalScorer::State {
+    explicit State(Options opts) : options(opts) {}
+
+    void add(std::uint64_t seed, double durationMs, std::int64_t acquiredAtNs) {
+        const std::uint64_t sequence = firstSequence + window.size();
+        if (acquiredAtNs != 0) {
+            newestNs = std::max(newestNs, acquiredAtNs);
+            // Monotonic queues: the front always holds the window's earliest
+            // (minStamps) or latest (maxStamps) acquisition time.
+            while (!minStamps.empty() && minStamps.back().acquiredAtNs >= acquiredAtNs) {
+                minStamps.pop_back();
+            }
+            minStamps.push_back({sequence, acquiredAtNs});
+            while (!maxStamps.empty() && maxStamps.back().acquiredAtNs <= acquiredAtNs) {
+                maxStamps.pop_back();
+            }
+            maxStamps.push_back({sequence, acquiredAtNs});
+        }
+        const Sample sample{static_cast<double>(seed), durationMs, acquiredAtNs != 0 ? acquiredAtNs : newestNs};
+        window.push_back(sample);
+        seeds.add(sample.seed);
+        durations.add(sample.durationMs);
+
+        if (options.maxRecords != 0) {
+            while (window.size() > options.maxRecords) {
+                evictOldest();
+            }
+        }
+        if (options.window.count() > 0 && newestNs != kNoStamp) {
+            const std::int64_t spanNs = std::chrono::nanoseconds(options.window).count();
+            while (!window.empty() && window.front().evictAtNs <= newestNs - spanNs) {
+                evictOldest();
+            }
+        }
+        if (evictedSinceRebuild >= std::max(kMinRebuildInterval, window.size())) {
+            rebuild();
+        }
+    }
+
+    void evictOldest() {
+        const Sample& oldest = window.front();
+        seeds.remove(oldest.seed);
+        durations.remove(oldest.durationMs);
+        if (!minStamps.empty() && minStamps.front().sequence == firstSequence) {
+            minStamps.pop_front();
+        }
+        if (!maxStamps.empty() && maxStamps.front().sequence == firstSequence) {
+            maxStamps.pop_front();
+        }
+        window.pop_front();
+        ++firstSequence;
+        ++evictedSinceRebuild;
+    }
+
+    void rebuild() {
+        seeds = {};
+        durations = {};
+        for (const Sample& sample : window) {
+            seeds.add(sample.seed);
+            durations.add(sample.durationMs);
+        }
+        evictedSinceRebuild = 0;
+    }
+
+    detail::ScoringMoments moments() const {
+        detail::ScoringMoments current;
+        current.count = window.size();
+        current.seedMean = seeds.mean;
+        current.seedM2 = seeds.m2;
+        current.durationMean = durations.mean;
+        current.durationM2 = durations.m2;
+        if (!minStamps.empty()) {
+            current.minStampNs = minStamps.front().acquiredAtNs;
+            current.maxStampNs = maxStamps.front().acquiredAtNs;
+        }
+        return current;
+    }
+
+    Options options;
+    std::deque<Sample> window;
+    // Sequence number of window.front().
+    std::uint64_t firstSequence{0};
+    std::deque<Extreme> minStamps;
+    std::deque<Extreme> maxStamps;
+    // Latest acquired_at seen; records added before any is seen are the
+    // first to leave a time window.
+    std::int64_t newestNs{kNoStamp};
+    detail::RunningStats seeds;
+    detail::RunningStats durations;
+    std::size_t evictedSinceRebuild{0};
+};
+
+StreamingTemporalScorer::StreamingTemporalScorer() : StreamingTemporalScorer(Options{}) {}
+
+StreamingTemporalScorer::StreamingTemporalScorer(Options options) : state_(std::make_unique<State>(options)) {}
+
+StreamingTemporalScorer::~StreamingTemporalScorer() = default;
+StreamingTemporalScorer::StreamingTemporalScorer(StreamingTemporalScorer&&) noexcept = default;
+StreamingTemporalScorer& StreamingTemporalScorer::operator=(StreamingTemporalScorer&&) noexcept = default;
+
+void StreamingTemporalScorer::add(const AnchorTelemetryRecord& record) {
+    add(record.seed, record.durationMs,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(record.acquiredAt.time_since_epoch()).count());
+}
+
+void StreamingTemporalScorer::add(std::uint64_t seed, double durationMs, std::int64_t acquiredAtNs) {
+    state_->add(seed, durationMs, acquiredAtNs);
+}
+
+TemporalScoringResult StreamingTemporalScorer::current() const {
+    return TemporalScoring::score(state_->moments());
+}
+
+std::size_t StreamingTemporalScorer::size() const {
+    return state_->window.size();
+}
+
+void StreamingTemporalScorer::clear() {
+    state_ = std::make_unique<State>(state_->options);
+}
+
+} // namespace clamp
@@ -1,112 +1,266 @@
 #include "clamp/TemporalScoring.h"
 
+#include "../common/parallel_for.h"
+#include "../telemetry/running_stats.h"
+
 #include <algorithm>
+#include <chrono>
 #include <cmath>
-#include <numeric>
+#include <cstdint>
 #include <iomanip>
-#include <optional>
+#include <limits>
 #include <sstream>
+#include <utility>
 
 namespace clamp {
 
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(__clang__))
+#define CLAMP_SCORING_AVX2 1
+#define CLAMP_SCORING_INLINE __attribute__((always_inline)) inline
+#else
+#define CLAMP_SCORING_AVX2 0
+#define CLAMP_SCORING_INLINE inline
+#endif
+
 namespace {
 
-double computeNormalizedVariance(const std::vector<double>& values) {
-    if (values.size() < 2) {
-        return 0.0;
-    }
+// Records are reduced in blocks of kBlockSize. Within a block every lane sums
+// values shifted by the block's first value, which keeps the loop free of
+// divisions and cross-lane dependencies (so it vectorises) while avoiding the
+// cancellation of a raw sum of squares; blocks are then folded into
+// RunningStats with Chan's pairwise update. Components a policy disables are
+// compiled out of the loop.
+constexpr std::size_t kLanes = 4;
+constexpr std::size_t kBlockSize = 1024;
+constexpr std::int64_t kNoMinStamp = std::numeric_limits<std::int64_t>::max();
+constexpr std::int64_t kNoMaxStamp = std::numeric_limits<std::int64_t>::min();
+// averageGroupScores stays on the calling thread below this many records.
+constexpr std::size_t kParallelMinRecords = 32 * 1024;
 
-    const double mean = std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size());
-    double sumSq = 0.0;
-    for (const double value : values) {
-        const double diff = value - mean;
-        sumSq += diff * diff;
-    }
+struct BlockSums {
+    double seedSum{0.0};
+    double seedSquares{0.0};
+    double durationSum{0.0};
+    double durationSquares{0.0};
+    std::int64_t minStamp{kNoMinStamp};
+    std::int64_t maxStamp{kNoMaxStamp};
+};
 
-    const double variance = sumSq / static_cast<double>(values.size() - 1);
-    const double scale = std::abs(mean) + 1.0;
-    return variance / (scale * scale);
-}
-
-double maxDriftMs(const std::vector<AnchorTelemetryRecord>& records) {
-    if (records.empty()) {
-        return 0.0;
+// Sums one block. Timestamps of 0 are unset and leave min/max untouched.
+template <bool Entropy, bool Duration, bool Drift, typename Seed, typename DurationAt, typename Stamp>
+CLAMP_SCORING_INLINE BlockSums sumBlock(std::size_t begin,
+                                        std::size_t end,
+                                        double seedShift,
+                                        double durationShift,
+                                        Seed seedAt,
+                                        DurationAt durationAt,
+                                        Stamp stampAt) {
+    double seedSum[kLanes] = {};
+    double seedSquares[kLanes] = {};
+    double durationSum[kLanes] = {};
+    double durationSquares[kLanes] = {};
+    std::int64_t minStamp[kLanes];
+    std::int64_t maxStamp[kLanes];
+    for (std::size_t lane = 0; lane < kLanes; ++lane) {
+        minStamp[lane] = kNoMinStamp;
+        maxStamp[lane] = kNoMaxStamp;
     }
 
-    std::optional<std::chrono::system_clock::time_point> minTs;
-    std::optional<std::chrono::system_clock::time_point> maxTs;
-    for (const auto& record : records) {
-        if (record.acquiredAt.time_since_epoch().count() == 0) {
-            continue;
+    auto accumulate = [&](std::size_t lane, std::size_t index) {
+        if constexpr (Entropy) {
+            const double seed = seedAt(index) - seedShift;
+            seedSum[lane] += seed;
+            seedSquares[lane] += seed * seed;
+        }
+        if constexpr (Duration) {
+            const double duration = durationAt(index) - durationShift;
+            durationSum[lane] += duration;
+            durationSquares[lane] += duration * duration;
         }
-        if (!minTs || record.acquiredAt < *minTs) {
-            minTs = record.acquiredAt;
+        if constexpr (Drift) {
+            const std::int64_t stamp = stampAt(index);
+            minStamp[lane] = std::min(minStamp[lane], stamp == 0 ? kNoMinStamp : stamp);
+            maxStamp[lane] = std::max(maxStamp[lane], stamp == 0 ? kNoMaxStamp : stamp);
         }
-        if (!maxTs || record.acquiredAt > *maxTs) {
-            maxTs = record.acquiredAt;
+    };
+
+    std::size_t index = begin;
+    for (; index + kLanes <= end; index += kLanes) {
+        for (std::size_t lane = 0; lane < kLanes; ++lane) {
+            accumulate(lane, index + lane);
         }
     }
-    if (!minTs || !maxTs) {
-        return 0.0;
+    for (std::size_t lane = 0; index < end; ++index, ++lane) {
+        accumulate(lane, index);
     }
-    return std::chrono::duration<double, std::milli>(*maxTs - *minTs).count();
-}
 
-double clamp01(double value) {
-    if (value < 0.0) {
-        return 0.0;
+    BlockSums sums;
+    for (std::size_t lane = 0; lane < kLanes; ++lane) {
+        sums.seedSum += seedSum[lane];
+        sums.seedSquares += seedSquares[lane];
+        sums.durationSum += durationSum[lane];
+        sums.durationSquares += durationSquares[lane];
+        sums.minStamp = std::min(sums.minStamp, minStamp[lane]);
+        sums.maxStamp = std::max(sums.maxStamp, maxStamp[lane]);
     }
-    if (value > 1.0) {
-        return 1.0;
-    }
-    return value;
+    return sums;
 }
 
-} // namespace
+template <bool Entropy, bool Duration, bool Drift>
+BlockSums sumColumnBlock(const TemporalColumns& columns,
+                         std::size_t begin,
+                         std::size_t end,
+                         double seedShift,
+                         double durationShift) {
+    return sumBlock<Entropy, Duration, Drift>(
+        begin, end, seedShift, durationShift,
+        [&](std::size_t i) { return static_cast<double>(columns.seeds[i]); },
+        [&](std::size_t i) { return columns.durationsMs[i]; },
+        [&](std::size_t i) { return columns.acquiredAtNs[i]; });
+}
+
+#if CLAMP_SCORING_AVX2
+template <bool Entropy, bool Duration, bool Drift>
+__attribute__((target("avx2"))) BlockSums sumColumnBlockAvx2(const TemporalColumns& columns,
+                                                              std::size_t begin,
+                                                              std::size_t end,
+                                                              double seedShift,
+                                                              double durationShift) {
+    return sumBlock<Entropy, Duration, Drift>(
+        begin, end, seedShift, durationShift,
+        [&](std::size_t i) { return static_cast<double>(columns.seeds[i]); },
+        [&](std::size_t i) { return columns.durationsMs[i]; },
+        [&](std::size_t i) { return columns.acquiredAtNs[i]; });
+}
+#endif
 
-TemporalScoringResult TemporalScoring::evaluate(const std::vector<AnchorTelemetryRecord>& records) const {
-    TemporalScoringResult result;
-    result.sampleCount = records.size();
-    if (records.empty()) {
-        result.stabilityScore = 1.0;
-        return result;
+using ColumnBlockKernel = BlockSums (*)(const TemporalColumns&, std::size_t, std::size_t, double, double);
+
+template <bool Entropy, bool Duration, bool Drift>
+ColumnBlockKernel columnBlockKernel() {
+#if CLAMP_SCORING_AVX2
+    static const ColumnBlockKernel selected = __builtin_cpu_supports("avx2")
+                                                  ? sumColumnBlockAvx2<Entropy, Duration, Drift>
+                                                  : sumColumnBlock<Entropy, Duration, Drift>;
+    return selected;
+#else
+    return sumColumnBlock<Entropy, Duration, Drift>;
+#endif
+}
+
+std::int64_t stampNs(const AnchorTelemetryRecord& record) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(record.acquiredAt.time_since_epoch()).count();
+}
+
+// `sumRange(begin, end, seedShift, durationShift)` returns the BlockSums of one
+// block; `shiftsAt(begin)` the seed and duration it is shifted by.
+template <typename SumRange, typename Shifts>
+detail::ScoringMoments scan(std::size_t size, SumRange sumRange, Shifts shiftsAt) {
+    detail::RunningStats seeds;
+    detail::RunningStats durations;
+    std::int64_t minStamp = kNoMinStamp;
+    std::int64_t maxStamp = kNoMaxStamp;
+    for (std::size_t begin = 0; begin < size; begin += kBlockSize) {
+        const std::size_t end = std::min(size, begin + kBlockSize);
+        const auto [seedShift, durationShift] = shiftsAt(begin);
+        const BlockSums sums = sumRange(begin, end, seedShift, durationShift);
+        const double count = static_cast<double>(end - begin);
+        auto blockStats = [&](double shift, double sum, double squares) {
+            detail::RunningStats block;
+            block.count = end - begin;
+            block.mean = shift + sum / count;
+            block.m2 = std::max(0.0, squares - sum * sum / count);
+            return block;
+        };
+        seeds.merge(blockStats(seedShift, sums.seedSum, sums.seedSquares));
+        durations.merge(blockStats(durationShift, sums.durationSum, sums.durationSquares));
+        minStamp = std::min(minStamp, sums.minStamp);
+        maxStamp = std::max(maxStamp, sums.maxStamp);
     }
 
-    std::vector<double> seedValues;
-    seedValues.reserve(records.size());
-    std::vector<double> durations;
-    durations.reserve(records.size());
-    for (const auto& record : records) {
-        seedValues.push_back(static_cast<double>(record.seed));
-        durations.push_back(record.durationMs);
+    detail::ScoringMoments moments;
+    moments.count = size;
+    moments.seedMean = seeds.mean;
+    moments.seedM2 = seeds.m2;
+    moments.durationMean = durations.mean;
+    moments.durationM2 = durations.m2;
+    if (minStamp <= maxStamp) {
+        moments.minStampNs = minStamp;
+        moments.maxStampNs = maxStamp;
     }
+    return moments;
+}
 
-    result.entropyVariance = clamp01(computeNormalizedVariance(seedValues));
-    result.durationVariance = clamp01(computeNormalizedVariance(durations));
-    result.driftMs = std::abs(maxDriftMs(records));
+} // namespace
 
-    const double driftComponent = clamp01(result.driftMs / 1000.0);
-    const double penalty = (result.entropyVariance + result.durationVariance + driftComponent) / 3.0;
-    result.stabilityScore = clamp01(1.0 - penalty);
+namespace detail {
 
-    return result;
+template <bool Entropy, bool Duration, bool Drift>
+ScoringMoments scoringMoments(const std::vector<AnchorTelemetryRecord>& records) {
+    return scan(
+        records.size(),
+        [&](std::size_t begin, std::size_t end, double seedShift, double durationShift) {
+            return sumBlock<Entropy, Duration, Drift>(
+                begin, end, seedShift, durationShift,
+                [&](std::size_t i) { return static_cast<double>(records[i].seed); },
+                [&](std::size_t i) { return records[i].durationMs; },
+                [&](std::size_t i) { return stampNs(records[i]); });
+        },
+        [&](std::size_t begin) {
+            return std::pair{static_cast<double>(records[begin].seed), records[begin].durationMs};
+        });
 }
 
-TemporalScoringResult TemporalScoring::evaluateAggregated(
-    const std::vector<std::vector<AnchorTelemetryRecord>>& groupedRecords) const {
+template <bool Entropy, bool Duration, bool Drift>
+ScoringMoments scoringMoments(const TemporalColumns& columns) {
+    const ColumnBlockKernel kernel = columnBlockKernel<Entropy, Duration, Drift>();
+    return scan(
+        columns.size,
+        [&](std::size_t begin, std::size_t end, double seedShift, double durationShift) {
+            return kernel(columns, begin, end, seedShift, durationShift);
+        },
+        [&](std::size_t begin) {
+            return std::pair{Entropy ? static_cast<double>(columns.seeds[begin]) : 0.0,
+                             Duration ? columns.durationsMs[begin] : 0.0};
+        });
+}
+
+#define CLAMP_INSTANTIATE_SCORING_MOMENTS(E, D, T)                                           \
+    template ScoringMoments scoringMoments<E, D, T>(const std::vector<AnchorTelemetryRecord>&); \
+    template ScoringMoments scoringMoments<E, D, T>(const TemporalColumns&);
+CLAMP_INSTANTIATE_SCORING_MOMENTS(false, false, true)
+CLAMP_INSTANTIATE_SCORING_MOMENTS(false, true, false)
+CLAMP_INSTANTIATE_SCORING_MOMENTS(false, true, true)
+CLAMP_INSTANTIATE_SCORING_MOMENTS(true, false, false)
+CLAMP_INSTANTIATE_SCORING_MOMENTS(true, false, true)
+CLAMP_INSTANTIATE_SCORING_MOMENTS(true, true, false)
+CLAMP_INSTANTIATE_SCORING_MOMENTS(true, true, true)
+#undef CLAMP_INSTANTIATE_SCORING_MOMENTS
+
+// Each group lands in its own slot and the sums run in group order
+// afterwards, so the result does not depend on how groups were spread over
+// workers.
+TemporalScoringResult averageGroupScores(std::size_t groupCount,
+                                         std::size_t totalRecords,
+                                         std::size_t workerCount,
+                                         const std::function<TemporalScoringResult(std::size_t)>& scoreGroup) {
     TemporalScoringResult aggregate;
-    if (groupedRecords.empty()) {
+    if (groupCount == 0) {
         aggregate.stabilityScore = 1.0;
         return aggregate;
     }
 
+    std::vector<TemporalScoringResult> results(groupCount);
+    const std::size_t workers = totalRecords < kParallelMinRecords ? 1 : workerCount;
+    const std::size_t grain = std::max<std::size_t>(1, groupCount / (resolveWorkerCount(workers) * 8));
+    parallelFor(
+        groupCount, workers, [&](std::size_t group) { results[group] = scoreGroup(group); }, grain);
+
     double stabilitySum = 0.0;
     double entropySum = 0.0;
     double durationSum = 0.0;
     double driftSum = 0.0;
-
-    for (const auto& group : groupedRecords) {
-        const auto groupResult = evaluate(group);
+    for (const auto& groupResult : results) {
         stabilitySum += groupResult.stabilityScore;
         entropySum += groupResult.entropyVariance;
         durationSum += groupResult.durationVariance;
@@ -114,7 +268,7 @@ TemporalScoringResult TemporalScoring::evaluateAggregated(
         aggregate.sampleCount += groupResult.sampleCount;
     }
 
-    const double count = static_cast<double>(groupedRecords.size());
+    const double count = static_cast<double>(groupCount);
     aggregate.stabilityScore = stabilitySum / count;
     aggregate.entropyVariance = entropySum / count;
     aggregate.durationVariance = durationSum / count;
@@ -123,6 +277,8 @@ TemporalScoringResult TemporalScoring::evaluateAggregated(
     return aggregate;
 }
 
+} // namespace detail
+
 std::string TemporalScoringResult::toJson() const {
     std::ostringstream oss;
     oss << "{";
@@ -0,0 +1,574 @@
+#include "aggregate_cache.h"
+
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace clamp::detail {
+namespace {
+
+constexpr std::array<char, 8> kCacheMagic{'C', 'L', 'A', 'G', 'G', 'C', 'H', 'E'};
+constexpr std::uint32_t kCacheVersion = 5;
+
+// Every record is a tag byte and a 32-bit payload length, then the payload.
+enum RecordTag : std::uint8_t {
+    kEntryRecord = 'E',
+    kErasedRecord = 'D',
+    kRollupRecord = 'R',
+};
+constexpr std::size_t kRecordHeaderBytes = sizeof(std::uint8_t) + sizeof(std::uint32_t);
+constexpr std::size_t kFileHeaderBytes = 8 + sizeof(std::uint32_t) + sizeof(std::uint64_t);
+
+template <typename T>
+void appendPod(std::string& out, const T& value) {
+    const auto* bytes = reinterpret_cast<const char*>(&value);
+    out.append(bytes, sizeof(T));
+}
+
+class Reader {
+public:
+    Reader(const char* data, std::size_t size)
+        : cursor_(data), end_(data + size) {}
+
+    template <typename T>
+    bool read(T& value) {
+        if (static_cast<std::size_t>(end_ - cursor_) < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, cursor_, sizeof(T));
+        cursor_ += sizeof(T);
+        return true;
+    }
+
+    bool read(std::string& value, std::size_t length) {
+        if (static_cast<std::size_t>(end_ - cursor_) < length) {
+            return false;
+        }
+        value.assign(cursor_, length);
+        cursor_ += length;
+        return true;
+    }
+
+    bool skip(std::size_t length) {
+        if (remaining() < length) {
+            return false;
+        }
+        cursor_ += length;
+        return true;
+    }
+
+    std::size_t remaining() const { return static_cast<std::size_t>(end_ - cursor_); }
+    const char* cursor() const { return cursor_; }
+
+private:
+    const char* cursor_;
+    const char* end_;
+};
+
+void appendDigest(std::string& out, const TDigest& digest) {
+    TDigest compressed = digest;
+    compressed.compress();
+    appendPod(out, compressed.compression());
+    appendPod(out, compressed.min());
+    appendPod(out, compressed.max());
+    appendPod(out, static_cast<std::uint32_t>(compressed.centroids().size()));
+    for (const auto& centroid : compressed.centroids()) {
+        appendPod(out, centroid.mean);
+        appendPod(out, centroid.weight);
+    }
+}
+
+bool readDigest(Reader& reader, TDigest& digest) {
+    double compression = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+    std::uint32_t count = 0;
+    if (!reader.read(compression) || !reader.read(min) || !reader.read(max) || !reader.read(count) ||
+        count > reader.remaining() / (2 * sizeof(double))) {
+        return false;
+    }
+    std::vector<TDigest::Centroid> centroids(count);
+    for (auto& centroid : centroids) {
+        if (!reader.read(centroid.mean) || !reader.read(centroid.weight)) {
+            return false;
+        }
+    }
+    digest = TDigest::fromCentroids(std::move(centroids), min, max, compression);
+    return true;
+}
+
+void appendRunning(std::string& out, const RunningStats& stats) {
+    appendPod(out, static_cast<std::uint64_t>(stats.count));
+    appendPod(out, stats.mean);
+    appendPod(out, stats.m2);
+}
+
+bool readRunning(Reader& reader, RunningStats& stats) {
+    std::uint64_t count = 0;
+    if (!reader.read(count) || !reader.read(stats.mean) || !reader.read(stats.m2)) {
+        return false;
+    }
+    stats.count = static_cast<std::size_t>(count);
+    return true;
+}
+
+void appendStats(std::string& out, const PartialStats& stats) {
+    appendRunning(out, stats.stability);
+    appendRunning(out, stats.duration);
+    appendPod(out, stats.minTimestamp);
+    appendPod(out, stats.maxTimestamp);
+    appendDigest(out, stats.stabilitySketch);
+    appendDigest(out, stats.durationSketch);
+}
+
+bool readStats(Reader& reader, PartialStats& stats) {
+    if (!readRunning(reader, stats.stability) || !readRunning(reader, stats.duration) ||
+        !reader.read(stats.minTimestamp) || !reader.read(stats.maxTimestamp) ||
+        !readDigest(reader, stats.stabilitySketch) || !readDigest(reader, stats.durationSketch)) {
+        return false;
+    }
+    return true;
+}
+
+void appendPartial(std::string& out, const FilePartial& partial) {
+    appendStats(out, partial);
+    appendPod(out, static_cast<std::uint32_t>(partial.groups.size()));
+    for (const auto& [key, stats] : partial.groups) {
+        appendPod(out, static_cast<std::uint32_t>(key.size()));
+        out.append(key);
+        appendStats(out, stats);
+    }
+    appendPod(out, partial.timeline.widthMs());
+    appendPod(out, static_cast<std::uint32_t>(partial.timeline.buckets().size()));
+    for (const auto& [key, stats] : partial.timeline.buckets()) {
+        appendPod(out, key);
+        appendStats(out, stats);
+    }
+}
+
+bool readPartial(Reader& reader, FilePartial& partial) {
+    std::uint32_t groupCount = 0;
+    if (!readStats(reader, partial) || !reader.read(groupCount) || groupCount > reader.remaining()) {
+        return false;
+    }
+    partial.groups.resize(groupCount);
+    for (auto& [key, stats] : partial.groups) {
+        std::uint32_t keyLength = 0;
+        if (!reader.read(keyLength) || !reader.read(key, keyLength) || !readStats(reader, stats)) {
+            return false;
+        }
+    }
+    std::int64_t widthMs = 0;
+    std::uint32_t bucketCount = 0;
+    if (!reader.read(widthMs) || !reader.read(bucketCount) || bucketCount > reader.remaining()) {
+        return false;
+    }
+    TimeBuckets::Map buckets;
+    for (std::uint32_t i = 0; i < bucketCount; ++i) {
+        std::int64_t key = 0;
+        PartialStats stats;
+        if (!reader.read(key) || !readStats(reader, stats)) {
+            return false;
+        }
+        buckets.emplace_hint(buckets.end(), key, std::move(stats));
+    }
+    partial.timeline.assign(widthMs, std::move(buckets));
+    return true;
+}
+
+
+// FNV-1a over the key and identity, finished with a 64-bit mix. Stable across
+// builds, because rollups record the fingerprint of the set they cover.
+std::uint64_t entryHash(const std::string& key, const FileIdentity& identity) {
+    std::uint64_t hash = 0xCBF29CE484222325ull;
+    auto feed = [&](const void* data, std::size_t size) {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+        }
+    };
+    feed(key.data(), key.size());
+    feed(&identity.size, sizeof(identity.size));
+    feed(&identity.mtimeNs, sizeof(identity.mtimeNs));
+    feed(&identity.inode, sizeof(identity.inode));
+    feed(&identity.device, sizeof(identity.device));
+    hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+    hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+    return hash ^ (hash >> 31);
+}
+
+void appendRecord(std::string& out, RecordTag tag, std::string_view payload) {
+    appendPod(out, static_cast<std::uint8_t>(tag));
+    appendPod(out, static_cast<std::uint32_t>(payload.size()));
+    out.append(payload);
+}
+
+// Key, identity and time range of an entry; its partial follows.
+void appendEntryHead(std::string& out, const std::string& key, const AggregateCache::CachedFile& file) {
+    appendPod(out, static_cast<std::uint32_t>(key.size()));
+    out.append(key);
+    appendPod(out, file.identity.size);
+    appendPod(out, file.identity.mtimeNs);
+    appendPod(out, file.identity.inode);
+    appendPod(out, file.identity.device);
+    appendPod(out, file.minTimestamp);
+    appendPod(out, file.maxTimestamp);
+}
+
+bool readEntryHead(Reader& reader, std::string& key, AggregateCache::CachedFile& file) {
+    std::uint32_t keyLength = 0;
+    return reader.read(keyLength) && reader.read(key, keyLength) && reader.read(file.identity.size) &&
+           reader.read(file.identity.mtimeNs) && reader.read(file.identity.inode) &&
+           reader.read(file.identity.device) && reader.read(file.minTimestamp) && reader.read(file.maxTimestamp);
+}
+
+} // namespace
+
+#if !defined(_WIN32)
+namespace {
+
+void fillIdentity(const struct stat& info, FileIdentity& identity) {
+    identity.size = static_cast<std::uint64_t>(info.st_size);
+    identity.mtimeNs = static_cast<std::int64_t>(info.st_mtim.tv_sec) * 1'000'000'000 + info.st_mtim.tv_nsec;
+    identity.inode = static_cast<std::uint64_t>(info.st_ino);
+    identity.device = static_cast<std::uint64_t>(info.st_dev);
+}
+
+} // namespace
+#endif
+
+bool statFileIdentity(const std::filesystem::path& path, FileIdentity& identity) {
+#if defined(_WIN32)
+    std::error_code ec;
+    identity.size = std::filesystem::file_size(path, ec);
+    if (ec) {
+        return false;
+    }
+    const auto mtime = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        return false;
+    }
+    identity.mtimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(mtime.time_since_epoch()).count();
+    identity.inode = 0;
+    identity.device = 0;
+    return true;
+#else
+    struct stat info {};
+    if (::stat(path.c_str(), &info) != 0) {
+        return false;
+    }
+    fillIdentity(info, identity);
+    return true;
+#endif
+}
+
+DirectoryStat::DirectoryStat(const std::filesystem::path& directory)
+    : directory_(directory) {
+#if !defined(_WIN32)
+    fd_ = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+#endif
+}
+
+DirectoryStat::~DirectoryStat() {
+#if !defined(_WIN32)
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+#endif
+}
+
+bool DirectoryStat::identity(const std::string& relative, FileIdentity& identity) const {
+#if !defined(_WIN32)
+    if (fd_ >= 0) {
+        struct stat info {};
+        if (::fstatat(fd_, relative.c_str(), &info, 0) != 0) {
+            return false;
+        }
+        fillIdentity(info, identity);
+        return true;
+    }
+#endif
+    return statFileIdentity(directory_ / relative, identity);
+}
+
+void AggregateCache::load(const std::filesystem::path& path) {
+    *this = AggregateCache(layout_);
+    if (!file_.open(path)) {
+        return;
+    }
+    const std::string_view buffer = file_.view();
+    Reader reader(buffer.data(), buffer.size());
+
+    std::array<char, 8> magic{};
+    std::uint32_t version = 0;
+    std::uint64_t layout = 0;
+    if (!reader.read(magic) || magic != kCacheMagic || !reader.read(version) || version != kCacheVersion ||
+        !reader.read(layout) || layout != layout_) {
+        file_.close();
+        return;
+    }
+    headerValid_ = true;
+    // An entry record is rarely smaller than this; rehashing a large map while
+    // replaying costs more than the headers do.
+    entries_.reserve(buffer.size() / 512);
+
+    struct RollupRecord {
+        std::uint64_t fingerprint{0};
+        std::uint64_t count{0};
+        std::size_t offset{0};
+        std::size_t length{0};
+    };
+    std::optional<RollupRecord> lastRollup;
+    // Records are replayed in order; a record that does not parse ends the log.
+    while (reader.remaining() >= kRecordHeaderBytes) {
+        const std::size_t recordOffset = static_cast<std::size_t>(reader.cursor() - buffer.data());
+        std::uint8_t tag = 0;
+        std::uint32_t length = 0;
+        reader.read(tag);
+        reader.read(length);
+        if (reader.remaining() < length) {
+            break;
+        }
+        const char* payload = reader.cursor();
+        reader.skip(length);
+        Reader record(payload, length);
+        const std::size_t recordBytes = kRecordHeaderBytes + length;
+
+        if (tag == kEntryRecord) {
+            std::string key;
+            Entry entry;
+            if (!readEntryHead(record, key, entry.file)) {
+                break;
+            }
+            entry.hash = entryHash(key, entry.file.identity);
+            entry.blobOffset = static_cast<std::size_t>(record.cursor() - buffer.data());
+            entry.blobLength = record.remaining();
+            entry.recordBytes = recordBytes;
+            if (const auto previous = entries_.find(key); previous != entries_.end()) {
+                forget(previous->second);
+            }
+            fingerprint_ ^= entry.hash;
+            liveBytes_ += recordBytes;
+            entries_.insert_or_assign(std::move(key), std::move(entry));
+        } else if (tag == kErasedRecord) {
+            std::uint32_t keyLength = 0;
+            std::string key;
+            if (!record.read(keyLength) || !record.read(key, keyLength)) {
+                break;
+            }
+            if (const auto previous = entries_.find(key); previous != entries_.end()) {
+                forget(previous->second);
+                entries_.erase(previous);
+            }
+            deadBytes_ += recordBytes;
+        } else if (tag == kRollupRecord) {
+            RollupRecord rollup;
+            if (!record.read(rollup.fingerprint) || !record.read(rollup.count)) {
+                break;
+            }
+            rollup.offset = static_cast<std::size_t>(record.cursor() - buffer.data());
+            rollup.length = record.remaining();
+            deadBytes_ += rollupBytes_;
+            rollupBytes_ = recordBytes;
+            lastRollup = rollup;
+        } else {
+            break;
+        }
+        validEnd_ = recordOffset + recordBytes;
+    }
+    validEnd_ = std::max(validEnd_, kFileHeaderBytes);
+    tornTail_ = validEnd_ != buffer.size();
+    changed_ = false;
+
+    if (lastRollup && lastRollup->fingerprint == fingerprint_ && lastRollup->count == entries_.size()) {
+        Reader record(buffer.data() + lastRollup->offset, lastRollup->length);
+        FilePartial rollup;
+        if (readPartial(record, rollup)) {
+            rollup_ = std::move(rollup);
+        }
+    }
+}
+
+bool AggregateCache::save(const std::filesystem::path& path, const FilePartial* rollup) {
+    if (!changed_ && (rollup == nullptr || rollup_)) {
+        return true;
+    }
+
+    auto encodeEntry = [&](std::string& out, const std::string& key, Entry& entry) {
+        std::string payload;
+        appendEntryHead(payload, key, entry.file);
+        if (entry.stored) {
+            appendPartial(payload, *entry.stored);
+        } else {
+            // Unchanged entries are copied without decoding them.
+            payload.append(file_.view().substr(entry.blobOffset, entry.blobLength));
+        }
+        appendRecord(out, kEntryRecord, payload);
+        entry.recordBytes = kRecordHeaderBytes + payload.size();
+    };
+    std::size_t rollupBytes = 0;
+    auto encodeRollup = [&](std::string& out) {
+        std::string payload;
+        appendPod(payload, fingerprint_);
+        appendPod(payload, static_cast<std::uint64_t>(entries_.size()));
+        appendPartial(payload, *rollup);
+        appendRecord(out, kRollupRecord, payload);
+        rollupBytes = kRecordHeaderBytes + payload.size();
+    };
+
+    std::size_t appendedLive = 0;
+    std::string records;
+    for (const auto& key : erased_) {
+        std::string payload;
+        appendPod(payload, static_cast<std::uint32_t>(key.size()));
+        payload.append(key);
+        appendRecord(records, kErasedRecord, payload);
+    }
+    for (auto& [key, entry] : entries_) {
+        if (entry.unsaved) {
+            const std::size_t before = records.size();
+            encodeEntry(records, key, entry);
+            appendedLive += records.size() - before;
+        }
+    }
+    const std::size_t superseded = deadBytes_ + records.size() - appendedLive + (rollup ? rollupBytes_ : 0);
+
+    if (headerValid_ && superseded <= liveBytes_ + appendedLive) {
+        if (rollup != nullptr) {
+            encodeRollup(records);
+        }
+        std::error_code ec;
+        if (tornTail_) {
+            std::filesystem::resize_file(path, validEnd_, ec);
+            if (ec) {
+                return false;
+            }
+        }
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        if (!out.is_open()) {
+            return false;
+        }
+        out.write(records.data(), static_cast<std::streamsize>(records.size()));
+        if (!out.good()) {
+            return false;
+        }
+        deadBytes_ = superseded;
+        liveBytes_ += appendedLive;
+        if (rollup != nullptr) {
+            rollupBytes_ = rollupBytes;
+        }
+        validEnd_ += records.size();
+        markSaved();
+        return true;
+    }
+
+    // Compact: header, live entries and the rollup, written beside the target
+    // and renamed so readers never observe a torn cache.
+    std::string payload;
+    payload.reserve(kFileHeaderBytes + liveBytes_ + appendedLive);
+    payload.append(kCacheMagic.data(), kCacheMagic.size());
+    appendPod(payload, kCacheVersion);
+    appendPod(payload, layout_);
+    for (auto& [key, entry] : entries_) {
+        encodeEntry(payload, key, entry);
+    }
+    if (rollup != nullptr) {
+        encodeRollup(payload);
+    }
+
+    auto tempPath = path;
+    tempPath += ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            return false;
+        }
+        out.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+        if (!out.good()) {
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        return false;
+    }
+    // file_ still maps the previous log, which keeps unchanged blobs readable.
+    headerValid_ = true;
+    deadBytes_ = 0;
+    rollupBytes_ = rollupBytes;
+    liveBytes_ = payload.size() - kFileHeaderBytes - rollupBytes;
+    validEnd_ = payload.size();
+    markSaved();
+    return true;
+}
+
+const AggregateCache::CachedFile* AggregateCache::lookup(const std::string& key, const FileIdentity& identity) const {
+    const auto it = entries_.find(key);
+    if (it == entries_.end() || !(it->second.file.identity == identity)) {
+        return nullptr;
+    }
+    return &it->second.file;
+}
+
+bool AggregateCache::read(const std::string& key, FilePartial& partial) const {
+    const auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        return false;
+    }
+    if (it->second.stored) {
+        partial = *it->second.stored;
+        return true;
+    }
+    Reader reader(file_.view().data() + it->second.blobOffset, it->second.blobLength);
+    return readPartial(reader, partial);
+}
+
+void AggregateCache::store(const std::string& key, const FileIdentity& identity, const FilePartial& partial) {
+    Entry entry;
+    entry.file.identity = identity;
+    entry.file.minTimestamp = partial.minTimestamp;
+    entry.file.maxTimestamp = partial.maxTimestamp;
+    entry.hash = entryHash(key, identity);
+    entry.stored = std::make_unique<const FilePartial>(partial);
+    entry.unsaved = true;
+    if (const auto previous = entries_.find(key); previous != entries_.end()) {
+        forget(previous->second);
+    }
+    fingerprint_ ^= entry.hash;
+    entries_.insert_or_assign(key, std::move(entry));
+    rollup_.reset();
+    changed_ = true;
+}
+
+void AggregateCache::markSaved() {
+    for (auto& [key, entry] : entries_) {
+        entry.unsaved = false;
+    }
+    erased_.clear();
+    tornTail_ = false;
+    changed_ = false;
+}
+
+void AggregateCache::forget(const Entry& entry) {
+    fingerprint_ ^= entry.hash;
+    liveBytes_ -= entry.recordBytes;
+    deadBytes_ += entry.recordBytes;
+    rollup_.reset();
+    changed_ = true;
+}
+
+} // namespace clamp::detail
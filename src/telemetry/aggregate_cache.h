@@ -0,0 +1,133 @@
+#pragma once
+
+#include "aggregate_partial.h"
+#include "mapped_file.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace clamp::detail {
+
+// What we trust to detect a changed file without reading it.
+struct FileIdentity {
+    std::uint64_t size{0};
+    std::int64_t mtimeNs{0};
+    std::uint64_t inode{0};
+    std::uint64_t device{0};
+
+    bool operator==(const FileIdentity&) const = default;
+};
+
+bool statFileIdentity(const std::filesystem::path& path, FileIdentity& identity);
+
+// Stats files by their path relative to one open directory, so the kernel does
+// not resolve the directory again for each of many files.
+class DirectoryStat {
+public:
+    explicit DirectoryStat(const std::filesystem::path& directory);
+    ~DirectoryStat();
+
+    DirectoryStat(const DirectoryStat&) = delete;
+    DirectoryStat& operator=(const DirectoryStat&) = delete;
+
+    bool identity(const std::string& relative, FileIdentity& identity) const;
+
+private:
+    std::filesystem::path directory_;
+    int fd_{-1};
+};
+
+// Sidecar cache of per-file partials keyed by file name relative to the
+// aggregated directory. Entries are only reused when the file identity matches.
+// The layout fingerprint describes what a partial contains (e.g. which fields
+// records are grouped by); a cache written under another layout is ignored.
+//
+// The file is an append-only log of records: a file's partial, a deleted file,
+// or a rollup holding the merge of every live partial. Loading reads only the
+// record headers; per-file partials stay encoded in the mapped file until
+// read() asks for one, so a directory whose files are all unchanged costs one
+// rollup decode rather than a merge per file. save() appends the changes and a
+// new rollup, and rewrites the log only once superseded records outweigh the
+// live ones.
+class AggregateCache {
+public:
+    struct CachedFile {
+        FileIdentity identity;
+        double minTimestamp{0.0};
+        double maxTimestamp{0.0};
+    };
+
+    explicit AggregateCache(std::uint64_t layout = 0)
+        : layout_(layout) {}
+
+    // Loads a cache written by save(); a missing, corrupt or incompatible file
+    // yields an empty cache. A torn trailing record is ignored and cut off by
+    // the next save().
+    void load(const std::filesystem::path& path);
+    // Persists the changes made since load(). `rollup`, when given, must be the
+    // merge of every live entry; it lets the next load skip the per-file
+    // partials.
+    bool save(const std::filesystem::path& path, const FilePartial* rollup);
+
+    const CachedFile* lookup(const std::string& key, const FileIdentity& identity) const;
+    bool contains(const std::string& key) const { return entries_.count(key) != 0; }
+    // Decodes the partial of a live entry; safe to call from several threads.
+    bool read(const std::string& key, FilePartial& partial) const;
+    // The merge of every live entry, when the log ends with a current rollup.
+    const FilePartial* rollup() const { return rollup_ ? &*rollup_ : nullptr; }
+
+    void store(const std::string& key, const FileIdentity& identity, const FilePartial& partial);
+    // Drops every entry whose key `keep` rejects.
+    template <typename Keep>
+    void retain(Keep&& keep) {
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            if (keep(it->first)) {
+                ++it;
+                continue;
+            }
+            erased_.push_back(it->first);
+            forget(it->second);
+            it = entries_.erase(it);
+        }
+    }
+    std::size_t size() const { return entries_.size(); }
+
+private:
+    struct Entry {
+        CachedFile file;
+        std::uint64_t hash{0};
+        // The encoded partial inside file_, or the partial stored since load.
+        std::size_t blobOffset{0};
+        std::size_t blobLength{0};
+        std::size_t recordBytes{0};
+        std::unique_ptr<const FilePartial> stored;
+        bool unsaved{false};
+    };
+
+    // Accounts for an entry leaving the live set.
+    void forget(const Entry& entry);
+    void markSaved();
+
+    std::uint64_t layout_;
+    MappedFile file_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::vector<std::string> erased_;
+    // XOR of the live entries' hashes; a rollup is current when it was written
+    // for the same live set.
+    std::uint64_t fingerprint_{0};
+    std::optional<FilePartial> rollup_;
+    std::size_t rollupBytes_{0};
+    std::size_t liveBytes_{0};
+    std::size_t deadBytes_{0};
+    std::size_t validEnd_{0};
+    bool headerValid_{false};
+    bool tornTail_{false};
+    bool changed_{false};
+};
+
+} // namespace clamp::detail
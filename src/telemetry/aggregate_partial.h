@@ -0,0 +1,22 @@
+#pragma once
+
+#include "partial_stats.h"
+#include "time_buckets.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace clamp::detail {
+
+// Statistics for a single telemetry file; partials merge in a fixed order so the
+// directory summary does not depend on which worker parsed which file. `groups`
+// holds per-group statistics keyed by an encoded GroupTable key, in first-seen
+// order, and is only populated when the aggregator groups records. `timeline`
+// is only enabled when time buckets are requested.
+struct FilePartial : PartialStats {
+    std::vector<std::pair<std::string, PartialStats>> groups;
+    TimeBuckets timeline;
+};
+
+} // namespace clamp::detail
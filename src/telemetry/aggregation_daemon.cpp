@@ -0,0 +1,364 @@
+#include "clamp/AggregationDaemon.h"
+
+#include "aggregate_cache.h"
+#include "partial_sink.h"
+#include "telemetry_scanner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#define CLAMP_HAS_INOTIFY 1
+#else
+#define CLAMP_HAS_INOTIFY 0
+#endif
+
+namespace clamp {
+namespace {
+
+// New bytes are read and fed to the scanner in chunks of this size.
+constexpr std::size_t kReadChunkBytes = 1024 * 1024;
+
+struct WatchedFile {
+    detail::FileIdentity identity;
+    std::uint64_t offset{0};
+    std::unique_ptr<detail::TelemetryScanner> scanner;
+};
+
+} // namespace
+
+struct AggregationDaemon::State {
+    State(std::filesystem::path dir, Options opts)
+        : directory(std::move(dir)),
+          options(std::move(opts)),
+          writer(options.aggregation),
+          config(detail::sinkConfig(options.aggregation)) {
+        // A summary written into the watched directory must not be read back.
+        if (!options.summaryPath.empty()) {
+            const auto parent = options.summaryPath.parent_path();
+            if (std::filesystem::weakly_canonical(parent.empty() ? "." : parent, ignoredError) ==
+                std::filesystem::weakly_canonical(directory, ignoredError)) {
+                summaryName = options.summaryPath.filename();
+            }
+        }
+#if CLAMP_HAS_INOTIFY
+        if (::pipe2(wakePipe, O_NONBLOCK | O_CLOEXEC) != 0) {
+            wakePipe[0] = wakePipe[1] = -1;
+        }
+#endif
+        reset();
+    }
+
+    ~State() {
+#if CLAMP_HAS_INOTIFY
+        for (const int fd : wakePipe) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+#endif
+    }
+
+    // Drops all aggregates; the next scan starts every file from offset zero.
+    void reset() {
+        files.clear();
+        sink.reset();
+        total = std::make_unique<detail::FilePartial>();
+        sink = std::make_unique<detail::PartialSink>(*total, config);
+    }
+
+    bool isWatched(const std::filesystem::path& name) const {
+        return name.extension() == ".json" && name != summaryName;
+    }
+
+    // Feeds the bytes appended to `name` since the last call. Returns false
+    // when the file was truncated or replaced and aggregates must be rebuilt.
+    bool updateFile(const std::string& name, std::size_t& added) {
+        const auto path = directory / name;
+        detail::FileIdentity identity;
+        if (!detail::statFileIdentity(path, identity) || !std::filesystem::is_regular_file(path, ignoredError)) {
+            return files.find(name) == files.end();
+        }
+        auto [it, inserted] = files.try_emplace(name);
+        WatchedFile& file = it->second;
+        if (inserted) {
+            file.scanner = std::make_unique<detail::TelemetryScanner>(*sink, config.fields);
+        } else if (identity.inode != file.identity.inode || identity.device != file.identity.device ||
+                   identity.size < file.offset ||
+                   (identity.size == file.offset && file.offset > 0 && identity.mtimeNs != file.identity.mtimeNs)) {
+            return false;
+        }
+        file.identity = identity;
+        if (identity.size == file.offset) {
+            return true;
+        }
+
+        std::ifstream in(path, std::ios::binary);
+        if (!in.is_open()) {
+            return true;
+        }
+        in.seekg(static_cast<std::streamoff>(file.offset));
+        const std::size_t before = file.scanner->emitted();
+        std::uint64_t remaining = identity.size - file.offset;
+        while (remaining > 0 && in) {
+            buffer.resize(static_cast<std::size_t>(std::min<std::uint64_t>(remaining, kReadChunkBytes)));
+            in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            const auto got = static_cast<std::size_t>(in.gcount());
+            if (got == 0) {
+                break;
+            }
+            file.scanner->feed(std::string_view(buffer.data(), got));
+            file.offset += got;
+            remaining -= got;
+            bytesScanned += got;
+        }
+        added += file.scanner->emitted() - before;
+        return true;
+    }
+
+    // Picks up new bytes in every file; rebuilds from scratch if any file was
+    // truncated, replaced or deleted.
+    std::size_t scanDirectory() {
+        std::size_t added = 0;
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            std::set<std::string> present;
+            bool consistent = true;
+            for (const auto& entry : std::filesystem::directory_iterator(directory, ignoredError)) {
+                const auto name = entry.path().filename();
+                if (!isWatched(name)) {
+                    continue;
+                }
+                present.insert(name.string());
+            }
+            for (const auto& [name, file] : files) {
+                if (present.find(name) == present.end()) {
+                    consistent = false;
+                }
+            }
+            for (auto it = present.begin(); consistent && it != present.end(); ++it) {
+                consistent = updateFile(*it, added);
+            }
+            if (consistent) {
+                return added;
+            }
+            reset();
+            ++rescans;
+            added = 0;
+        }
+        return added;
+    }
+
+    void publish() {
+        auto next = detail::buildSummary(*total, sink->groups().entries(), total->timeline);
+        if (!options.summaryPath.empty()) {
+            auto tempPath = options.summaryPath;
+            tempPath += ".tmp";
+            if (writer.writeSummary(next, tempPath, directory.string(), options.snapshotPath)) {
+                std::error_code ec;
+                std::filesystem::rename(tempPath, options.summaryPath, ec);
+            }
+        }
+        std::lock_guard<std::mutex> lock(summaryMutex);
+        summary = std::move(next);
+    }
+
+    std::filesystem::path directory;
+    Options options;
+    std::filesystem::path summaryName;
+    TemporalAggregator writer;
+    detail::SinkConfig config;
+    std::unique_ptr<detail::FilePartial> total;
+    std::unique_ptr<detail::PartialSink> sink;
+    std::map<std::string, WatchedFile> files;
+    std::string buffer;
+    mutable std::error_code ignoredError;
+
+    std::atomic<bool> stopRequested{false};
+    std::atomic<std::uint64_t> bytesScanned{0};
+    std::atomic<std::size_t> rescans{0};
+    mutable std::mutex summaryMutex;
+    TemporalAggregator::Summary summary;
+    // Wakes run() from stop(): a pipe polled next to the inotify descriptor,
+    // or a condition variable for the polling fallback. The pipe lives as long
+    // as the daemon so stop() never races with closing it.
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    int wakePipe[2]{-1, -1};
+};
+
+AggregationDaemon::AggregationDaemon(std::filesystem::path telemetryDir, Options options)
+    : state_(std::make_unique<State>(std::move(telemetryDir), std::move(options))) {}
+
+AggregationDaemon::~AggregationDaemon() = default;
+
+std::size_t AggregationDaemon::refresh() {
+    const std::size_t added = state_->scanDirectory();
+    state_->publish();
+    return added;
+}
+
+bool AggregationDaemon::run() {
+    State& state = *state_;
+    if (!std::filesystem::is_directory(state.directory)) {
+        return false;
+    }
+    using Clock = std::chrono::steady_clock;
+#if CLAMP_HAS_INOTIFY
+    // The watch is registered before the initial scan, so files written while
+    // it runs still produce events.
+    const int watchFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    const bool watching = watchFd >= 0 && state.wakePipe[0] >= 0 &&
+                          ::inotify_add_watch(watchFd, state.directory.c_str(),
+                                              IN_CREATE | IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM |
+                                                  IN_DELETE | IN_DELETE_SELF | IN_MOVE_SELF) >= 0;
+#endif
+    refresh();
+    auto lastWrite = Clock::now();
+    bool dirty = false;
+    // Milliseconds until a pending update may be written, or -1 when idle.
+    auto writeDelay = [&]() -> int {
+        if (!dirty) {
+            return -1;
+        }
+        const auto due = lastWrite + state.options.writeInterval - Clock::now();
+        return static_cast<int>(std::max<std::int64_t>(0, std::chrono::ceil<std::chrono::milliseconds>(due).count()));
+    };
+    auto publishIfDue = [&]() {
+        if (dirty && writeDelay() == 0) {
+            state.publish();
+            lastWrite = Clock::now();
+            dirty = false;
+        }
+    };
+
+#if CLAMP_HAS_INOTIFY
+    if (watching) {
+        // Events are read in bulk; names are collected first so a burst of
+        // writes to one file costs one update.
+        alignas(inotify_event) char events[64 * 1024];
+        bool valid = true;
+        while (valid && !state.stopRequested.load()) {
+            pollfd fds[2] = {{watchFd, POLLIN, 0}, {state.wakePipe[0], POLLIN, 0}};
+            const int ready = ::poll(fds, 2, writeDelay());
+            if (ready < 0 && errno != EINTR) {
+                valid = false;
+                break;
+            }
+            std::set<std::string> changed;
+            bool rescan = false;
+            if (ready > 0 && (fds[0].revents & POLLIN) != 0) {
+                for (;;) {
+                    const ssize_t length = ::read(watchFd, events, sizeof(events));
+                    if (length <= 0) {
+                        break;
+                    }
+                    for (char* cursor = events; cursor < events + length;) {
+                        const auto* event = reinterpret_cast<const inotify_event*>(cursor);
+                        cursor += sizeof(inotify_event) + event->len;
+                        if ((event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) != 0) {
+                            valid = false;
+                        } else if ((event->mask & IN_Q_OVERFLOW) != 0) {
+                            rescan = true;
+                        } else if (event->len > 0) {
+                            const std::filesystem::path name(event->name);
+                            if (!state.isWatched(name)) {
+                                continue;
+                            }
+                            if ((event->mask & (IN_DELETE | IN_MOVED_FROM)) != 0) {
+                                rescan = rescan || state.files.count(name.string()) != 0;
+                            } else {
+                                changed.insert(name.string());
+                            }
+                        }
+                    }
+                }
+            }
+            if (rescan) {
+                state.scanDirectory();
+                dirty = true;
+            } else {
+                for (const auto& name : changed) {
+                    std::size_t added = 0;
+                    if (!state.updateFile(name, added)) {
+                        state.scanDirectory();
+                        dirty = true;
+                        break;
+                    }
+                    dirty = dirty || added > 0;
+                }
+            }
+            publishIfDue();
+        }
+        ::close(watchFd);
+        if (dirty) {
+            state.publish();
+        }
+        return valid;
+    }
+    if (watchFd >= 0) {
+        ::close(watchFd);
+    }
+#endif
+
+    // Without inotify the directory is rescanned every pollInterval; only new
+    // bytes are parsed, so an idle rescan costs one stat per file.
+    while (!state.stopRequested.load()) {
+        {
+            std::unique_lock<std::mutex> lock(state.wakeMutex);
+            const int delay = writeDelay();
+            const auto timeout = delay >= 0 ? std::min(state.options.pollInterval, std::chrono::milliseconds(delay))
+                                            : state.options.pollInterval;
+            state.wake.wait_for(lock, timeout, [&] { return state.stopRequested.load(); });
+        }
+        const std::size_t rescansBefore = state.rescans.load();
+        dirty = state.scanDirectory() > 0 || state.rescans.load() != rescansBefore || dirty;
+        publishIfDue();
+    }
+    if (dirty) {
+        state.publish();
+    }
+    return true;
+}
+
+void AggregationDaemon::stop() {
+    State& state = *state_;
+    {
+        std::lock_guard<std::mutex> lock(state.wakeMutex);
+        state.stopRequested.store(true);
+    }
+    state.wake.notify_all();
+#if CLAMP_HAS_INOTIFY
+    if (state.wakePipe[1] >= 0) {
+        const char byte = 1;
+        [[maybe_unused]] const ssize_t written = ::write(state.wakePipe[1], &byte, 1);
+    }
+#endif
+}
+
+TemporalAggregator::Summary AggregationDaemon::summary() const {
+    std::lock_guard<std::mutex> lock(state_->summaryMutex);
+    return state_->summary;
+}
+
+std::uint64_t AggregationDaemon::bytesScanned() const {
+    return state_->bytesScanned.load();
+}
+
+std::size_t AggregationDaemon::rescans() const {
+    return state_->rescans.load();
+}
+
+} // namespace clamp
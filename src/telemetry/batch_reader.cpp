@@ -0,0 +1,453 @@
+#include "batch_reader.h"
+
+#include "../common/parallel_for.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if !defined(CLAMP_HAS_IO_URING)
+#define CLAMP_HAS_IO_URING 0
+#endif
+
+#if CLAMP_HAS_IO_URING
+#include <linux/io_uring.h>
+#endif
+
+namespace clamp::detail {
+
+namespace {
+
+FileBuffer readWhole(const std::filesystem::path& path, std::size_t maxFileBytes) {
+    FileBuffer buffer;
+#if defined(_WIN32)
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) {
+        return buffer;
+    }
+    const auto size = static_cast<std::size_t>(in.tellg());
+    if (size > maxFileBytes) {
+        buffer.status = FileBuffer::Status::Oversized;
+        return buffer;
+    }
+    buffer.data.resize(size);
+    in.seekg(0);
+    if (in.read(buffer.data.data(), static_cast<std::streamsize>(size))) {
+        buffer.status = FileBuffer::Status::Ok;
+    }
+    return buffer;
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return buffer;
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return buffer;
+    }
+    const auto size = static_cast<std::size_t>(info.st_size);
+    if (size > maxFileBytes) {
+        ::close(fd);
+        buffer.status = FileBuffer::Status::Oversized;
+        return buffer;
+    }
+    buffer.data.resize(size);
+    std::size_t offset = 0;
+    while (offset < size) {
+        const ssize_t got = ::read(fd, buffer.data.data() + offset, size - offset);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            break;
+        }
+        offset += static_cast<std::size_t>(got);
+    }
+    ::close(fd);
+    buffer.data.resize(offset);
+    buffer.status = FileBuffer::Status::Ok;
+    return buffer;
+#endif
+}
+
+} // namespace
+
+#if CLAMP_HAS_IO_URING
+
+// Minimal io_uring driver on the raw syscalls, so liburing is not required.
+class BatchFileReader::Ring {
+public:
+    static constexpr unsigned kEntries = 64;
+
+    static std::unique_ptr<Ring> create() {
+        auto ring = std::unique_ptr<Ring>(new Ring());
+        if (!ring->setup()) {
+            return nullptr;
+        }
+        return ring;
+    }
+
+    ~Ring() {
+        if (sqes_ != nullptr) {
+            ::munmap(sqes_, sqesBytes_);
+        }
+        if (cqRingPtr_ != nullptr && cqRingPtr_ != sqRingPtr_) {
+            ::munmap(cqRingPtr_, cqRingBytes_);
+        }
+        if (sqRingPtr_ != nullptr) {
+            ::munmap(sqRingPtr_, sqRingBytes_);
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    // Set once the kernel rejects an opcode the probe reported or the ring
+    // itself fails; the caller then stops using the ring.
+    bool unsupported() const { return unsupported_; }
+    // Set when requests were still in flight after a failure and could not be
+    // waited for. The ring keeps their buffers, so it must outlive anything
+    // the kernel may still write and is never destroyed.
+    bool abandoned() const { return abandoned_; }
+
+    std::vector<FileBuffer> read(const std::vector<std::filesystem::path>& paths, std::size_t maxFileBytes) {
+        std::vector<FileBuffer> buffers(paths.size());
+        for (std::size_t begin = 0; begin < paths.size() && !unsupported_; begin += kEntries) {
+            const std::size_t end = std::min(paths.size(), begin + kEntries);
+            readWindow(paths, buffers, begin, end, maxFileBytes);
+        }
+        return buffers;
+    }
+
+private:
+    Ring() = default;
+
+    bool setup() {
+        io_uring_params params{};
+        fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, kEntries, &params));
+        if (fd_ < 0) {
+            return false;
+        }
+        sqRingBytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingBytes_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMmap) {
+            sqRingBytes_ = cqRingBytes_ = std::max(sqRingBytes_, cqRingBytes_);
+        }
+        sqRingPtr_ = ::mmap(nullptr, sqRingBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                            IORING_OFF_SQ_RING);
+        if (sqRingPtr_ == MAP_FAILED) {
+            sqRingPtr_ = nullptr;
+            return false;
+        }
+        if (singleMmap) {
+            cqRingPtr_ = sqRingPtr_;
+        } else {
+            cqRingPtr_ = ::mmap(nullptr, cqRingBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                                IORING_OFF_CQ_RING);
+            if (cqRingPtr_ == MAP_FAILED) {
+                cqRingPtr_ = nullptr;
+                return false;
+            }
+        }
+        sqesBytes_ = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = ::mmap(nullptr, sqesBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_,
+                            IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            return false;
+        }
+        sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+        auto* sq = static_cast<char*>(sqRingPtr_);
+        sqHead_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        auto* cq = static_cast<char*>(cqRingPtr_);
+        cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return supportsOpcodes();
+    }
+
+    // Rings predate the opcodes they run: 5.1-5.5 kernels set up a ring but
+    // fail OPENAT and READ with -EINVAL. Kernels without the probe (added with
+    // those opcodes in 5.6) cannot run them either.
+    bool supportsOpcodes() const {
+        constexpr unsigned kProbeOps = 256;
+        std::vector<unsigned char> storage(sizeof(io_uring_probe) + kProbeOps * sizeof(io_uring_probe_op), 0);
+        auto* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+        if (::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_PROBE, probe, kProbeOps) < 0) {
+            return false;
+        }
+        auto supported = [&](unsigned opcode) {
+            return opcode <= probe->last_op && (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED) != 0;
+        };
+        return supported(IORING_OP_OPENAT) && supported(IORING_OP_READ);
+    }
+
+    io_uring_sqe* nextSqe() {
+        const unsigned tail = *sqTail_;
+        const unsigned index = tail & sqMask_;
+        io_uring_sqe* sqe = &sqes_[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqArray_[index] = index;
+        __atomic_store_n(sqTail_, tail + 1, __ATOMIC_RELEASE);
+        ++queued_;
+        return sqe;
+    }
+
+    // Submits everything queued and waits for `expected` completions. If
+    // io_uring_enter fails, the ring is retired: entries it did not take are
+    // dropped, and the submitted ones are still waited for, because the kernel
+    // may write into their buffers and hand out fds until they complete.
+    // Returns false after a failure; `abandoned_` is set if even waiting
+    // failed and requests are left in flight.
+    template <typename OnComplete>
+    bool submitAndWait(unsigned expected, OnComplete&& onComplete) {
+        unsigned toSubmit = queued_;
+        queued_ = 0;
+        bool failed = false;
+        while (expected > 0) {
+            const long rc = ::syscall(__NR_io_uring_enter, fd_, toSubmit, 1u, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (rc >= 0) {
+                toSubmit -= std::min<unsigned>(toSubmit, static_cast<unsigned>(rc));
+            } else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                if (failed) {
+                    abandoned_ = true;
+                    return false;
+                }
+                // A failed enter submitted nothing, so those never complete.
+                failed = true;
+                unsupported_ = true;
+                expected -= toSubmit;
+                toSubmit = 0;
+            }
+            unsigned head = *cqHead_;
+            const unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+            while (head != tail && expected > 0) {
+                const io_uring_cqe& cqe = cqes_[head & cqMask_];
+                onComplete(cqe.user_data, cqe.res);
+                ++head;
+                --expected;
+            }
+            __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+        }
+        return !failed;
+    }
+
+    // After an abandoned wait: keeps the buffers of requests that may still
+    // complete. Their fds can be closed, since a request holds its own
+    // reference to the file; an open that completes later leaks its fd.
+    void orphan(std::vector<FileBuffer>& buffers, std::size_t begin, const std::vector<char>& pending) {
+        for (std::size_t slot = 0; slot < pending.size(); ++slot) {
+            if (pending[slot] != 0) {
+                orphans_.push_back(std::move(buffers[begin + slot].data));
+                buffers[begin + slot] = FileBuffer();
+            }
+        }
+    }
+
+    void readWindow(const std::vector<std::filesystem::path>& paths,
+                    std::vector<FileBuffer>& buffers,
+                    std::size_t begin,
+                    std::size_t end,
+                    std::size_t maxFileBytes) {
+        const auto count = static_cast<unsigned>(end - begin);
+        std::vector<int> fds(count, -1);
+        // Slots with a request the kernel has not completed yet.
+        std::vector<char> pending(count, 0);
+
+        // Phase 1: open the whole window at once.
+        for (unsigned i = 0; i < count; ++i) {
+            io_uring_sqe* sqe = nextSqe();
+            sqe->opcode = IORING_OP_OPENAT;
+            sqe->fd = AT_FDCWD;
+            sqe->addr = reinterpret_cast<std::uint64_t>(paths[begin + i].c_str());
+            sqe->open_flags = O_RDONLY | O_CLOEXEC;
+            sqe->user_data = i;
+            pending[i] = 1;
+        }
+        const bool opened = submitAndWait(count, [&](std::uint64_t slot, int result) {
+            pending[slot] = 0;
+            fds[slot] = result;
+            unsupported_ = unsupported_ || result == -EINVAL;
+        });
+        if (abandoned_) {
+            orphan(buffers, begin, pending);
+        }
+
+        // Phase 2: size each file (the inode is hot after open) and queue reads.
+        std::vector<std::size_t> filled(count, 0);
+        unsigned inFlight = 0;
+        auto queueRead = [&](unsigned slot) {
+            auto& data = buffers[begin + slot].data;
+            io_uring_sqe* sqe = nextSqe();
+            sqe->opcode = IORING_OP_READ;
+            sqe->fd = fds[slot];
+            sqe->addr = reinterpret_cast<std::uint64_t>(data.data() + filled[slot]);
+            sqe->len = static_cast<std::uint32_t>(data.size() - filled[slot]);
+            sqe->off = filled[slot];
+            sqe->user_data = slot;
+            pending[slot] = 1;
+            ++inFlight;
+        };
+        for (unsigned i = 0; opened && i < count; ++i) {
+            struct stat info {};
+            if (fds[i] < 0 || ::fstat(fds[i], &info) != 0) {
+                continue;
+            }
+            const auto size = static_cast<std::size_t>(info.st_size);
+            if (size > maxFileBytes) {
+                buffers[begin + i].status = FileBuffer::Status::Oversized;
+                continue;
+            }
+            // Never the inline small-string buffer: an orphaned read must
+            // target memory that survives moving the string out.
+            buffers[begin + i].data.reserve(std::max<std::size_t>(size, sizeof(std::string)));
+            buffers[begin + i].data.resize(size);
+            if (size == 0) {
+                buffers[begin + i].status = FileBuffer::Status::Ok;
+                continue;
+            }
+            queueRead(i);
+        }
+
+        // Phase 3: drain reads, resubmitting the remainder of short reads.
+        while (opened && inFlight > 0) {
+            std::vector<unsigned> retry;
+            const unsigned waiting = inFlight;
+            inFlight = 0;
+            const bool drained = submitAndWait(waiting, [&](std::uint64_t slot, int result) {
+                pending[slot] = 0;
+                auto& buffer = buffers[begin + slot];
+                if (result < 0) {
+                    unsupported_ = unsupported_ || result == -EINVAL;
+                    buffer.data.clear();
+                    return;
+                }
+                filled[slot] += static_cast<std::size_t>(result);
+                if (result == 0 || filled[slot] == buffer.data.size()) {
+                    buffer.data.resize(filled[slot]);
+                    buffer.status = FileBuffer::Status::Ok;
+                } else {
+                    retry.push_back(static_cast<unsigned>(slot));
+                }
+            });
+            if (!drained) {
+                if (abandoned_) {
+                    orphan(buffers, begin, pending);
+                }
+                break;
+            }
+            for (const unsigned slot : retry) {
+                queueRead(slot);
+            }
+        }
+
+        for (const int fd : fds) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+    }
+
+    int fd_{-1};
+    void* sqRingPtr_{nullptr};
+    void* cqRingPtr_{nullptr};
+    std::size_t sqRingBytes_{0};
+    std::size_t cqRingBytes_{0};
+    std::size_t sqesBytes_{0};
+    io_uring_sqe* sqes_{nullptr};
+    unsigned* sqHead_{nullptr};
+    unsigned* sqTail_{nullptr};
+    unsigned* sqArray_{nullptr};
+    unsigned sqMask_{0};
+    unsigned* cqHead_{nullptr};
+    unsigned* cqTail_{nullptr};
+    unsigned cqMask_{0};
+    io_uring_cqe* cqes_{nullptr};
+    unsigned queued_{0};
+    bool unsupported_{false};
+    bool abandoned_{false};
+    std::vector<std::string> orphans_;
+};
+
+#else
+
+class BatchFileReader::Ring {
+public:
+    static std::unique_ptr<Ring> create() { return nullptr; }
+
+    bool unsupported() const { return false; }
+    bool abandoned() const { return false; }
+
+    std::vector<FileBuffer> read(const std::vector<std::filesystem::path>&, std::size_t) { return {}; }
+};
+
+#endif
+
+BatchFileReader::BatchFileReader(std::size_t workerCount, bool preferIoUring, std::size_t maxFileBytes)
+    : workerCount_(workerCount),
+      maxFileBytes_(maxFileBytes),
+      ring_(preferIoUring ? Ring::create() : nullptr) {}
+
+BatchFileReader::~BatchFileReader() = default;
+
+BatchFileReader::Backend BatchFileReader::backend() const {
+    return ring_ ? Backend::IoUring : Backend::ThreadPool;
+}
+
+const char* BatchFileReader::backendName() const {
+    return ring_ ? "io_uring" : "thread-pool";
+}
+
+std::vector<FileBuffer> BatchFileReader::read(const std::vector<std::filesystem::path>& paths) {
+    if (!ring_) {
+        return readWithThreads(paths);
+    }
+    std::vector<FileBuffer> buffers = ring_->read(paths, maxFileBytes_);
+    if (ring_->abandoned()) {
+        // Leaked on purpose: requests still in flight write into buffers the
+        // ring owns.
+        ring_.release();
+    } else if (ring_->unsupported()) {
+        ring_.reset();
+    }
+    // Whatever the ring could not read is read again the portable way, so a
+    // kernel quirk costs time rather than files.
+    std::vector<std::size_t> failed;
+    for (std::size_t i = 0; i < buffers.size(); ++i) {
+        if (buffers[i].status == FileBuffer::Status::Failed) {
+            failed.push_back(i);
+        }
+    }
+    parallelFor(failed.size(), workerCount_, [&](std::size_t index) {
+        buffers[failed[index]] = readWhole(paths[failed[index]], maxFileBytes_);
+    });
+    return buffers;
+}
+
+std::vector<FileBuffer> BatchFileReader::readWithThreads(const std::vector<std::filesystem::path>& paths) const {
+    std::vector<FileBuffer> buffers(paths.size());
+    parallelFor(paths.size(), workerCount_, [&](std::size_t index) {
+        buffers[index] = readWhole(paths[index], maxFileBytes_);
+    });
+    return buffers;
+}
+
+} // namespace clamp::detail
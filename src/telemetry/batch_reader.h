@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace clamp::detail {
+
+struct FileBuffer {
+    enum class Status {
+        Ok,
+        Failed,
+        // Larger than maxFileBytes; left for the caller to stream instead.
+        Oversized
+    };
+
+    Status status{Status::Failed};
+    std::string data;
+};
+
+// Reads whole files in batches. On Linux builds with io_uring support the
+// opens and reads of a batch are submitted together and complete in whatever
+// order the device serves them; otherwise, or when the kernel refuses to set
+// up a ring or lacks its open and read opcodes, files are read on a small
+// thread pool. Files the ring fails to read are retried on the pool.
+class BatchFileReader {
+public:
+    enum class Backend {
+        IoUring,
+        ThreadPool
+    };
+
+    static constexpr std::size_t kDefaultMaxFileBytes = 8 * 1024 * 1024;
+
+    explicit BatchFileReader(std::size_t workerCount = 0,
+                             bool preferIoUring = true,
+                             std::size_t maxFileBytes = kDefaultMaxFileBytes);
+    ~BatchFileReader();
+
+    BatchFileReader(const BatchFileReader&) = delete;
+    BatchFileReader& operator=(const BatchFileReader&) = delete;
+
+    Backend backend() const;
+    const char* backendName() const;
+
+    // One buffer per path, in the order given.
+    std::vector<FileBuffer> read(const std::vector<std::filesystem::path>& paths);
+
+private:
+    class Ring;
+
+    std::vector<FileBuffer> readWithThreads(const std::vector<std::filesystem::path>& paths) const;
+
+    std::size_t workerCount_;
+    std::size_t maxFileBytes_;
+    std::unique_ptr<Ring> ring_;
+};
+
+} // namespace clamp::detail
@@ -0,0 +1,198 @@
+#include "bootstrap.h"
+
+#include "../common/parallel_for.h"
+
+#include <algorithm>
+
+namespace clamp::detail {
+
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(__clang__))
+#define CLAMP_BOOTSTRAP_AVX2 1
+#define CLAMP_BOOTSTRAP_INLINE __attribute__((always_inline)) inline
+#else
+#define CLAMP_BOOTSTRAP_AVX2 0
+#define CLAMP_BOOTSTRAP_INLINE inline
+#endif
+
+namespace {
+
+// Records are weighted in blocks that stay in L1 while every resample of a
+// chunk passes over them. Within a block each lane keeps its own sums, so the
+// loop has no cross-lane dependencies and vectorises: each lane hashes its
+// record index with the resample key, the Poisson lookup is a 32-bit integer
+// operation, and the values (shifted by their mean) are summed in single
+// precision per block and in double across blocks.
+constexpr std::size_t kLanes = 8;
+constexpr std::size_t kBlockSize = 2048;
+// Resamples handled together by one worker.
+constexpr std::size_t kResampleChunk = 16;
+
+// Poisson(1) CDF at k = 0..7, scaled to 31 bits: a draw u in [0, 2^31) has
+// weight #{k : u >= kPoissonCdf[k]}. Weights above 8 (probability 1.1e-6)
+// are folded into 8.
+constexpr std::int32_t kPoissonCdf[8] = {790015084,  1580030169, 1975037711, 2106706892,
+                                         2139624187, 2146207646, 2147304889, 2147461638};
+
+CLAMP_BOOTSTRAP_INLINE std::uint64_t mix64(std::uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+// Per-resample key: splitmix64 of the hashed stream and the resample number.
+std::uint64_t resampleKey(std::uint64_t stream, std::uint64_t resample) {
+    return mix64(mix64(stream) + (resample + 1) * 0x9E3779B97F4A7C15ull);
+}
+
+// The weight of record `index` in the resample with `key`. Two resamples only
+// hash a common input when their keys differ in the low bits alone, so their
+// weight sequences are unrelated rather than shifted copies of one another.
+CLAMP_BOOTSTRAP_INLINE std::int32_t poissonWeight(std::uint64_t key, std::uint64_t index) {
+    const auto draw = static_cast<std::int32_t>(static_cast<std::uint32_t>(mix64(key ^ index)) >> 1);
+    return (draw >= kPoissonCdf[0]) + (draw >= kPoissonCdf[1]) + (draw >= kPoissonCdf[2]) +
+           (draw >= kPoissonCdf[3]) + (draw >= kPoissonCdf[4]) + (draw >= kPoissonCdf[5]) +
+           (draw >= kPoissonCdf[6]) + (draw >= kPoissonCdf[7]);
+}
+
+struct WeightedSums {
+    double weight{0.0};
+    double stability{0.0};
+    double durationMs{0.0};
+};
+
+// Weighted sums of one block for one resample. Values are shifted by the
+// column means so the sums stay small.
+CLAMP_BOOTSTRAP_INLINE WeightedSums weighBlock(const float* stability,
+                                               const float* durationMs,
+                                               std::size_t begin,
+                                               std::size_t end,
+                                               std::uint64_t key) {
+    std::int32_t weight[kLanes] = {};
+    float stabilitySum[kLanes] = {};
+    float durationSum[kLanes] = {};
+    auto accumulate = [&](std::size_t lane, std::size_t index) {
+        const std::int32_t w = poissonWeight(key, index);
+        weight[lane] += w;
+        stabilitySum[lane] += static_cast<float>(w) * stability[index];
+        durationSum[lane] += static_cast<float>(w) * durationMs[index];
+    };
+
+    std::size_t index = begin;
+    for (; index + kLanes <= end; index += kLanes) {
+        for (std::size_t lane = 0; lane < kLanes; ++lane) {
+            accumulate(lane, index + lane);
+        }
+    }
+    for (std::size_t lane = 0; index < end; ++index, ++lane) {
+        accumulate(lane, index);
+    }
+
+    WeightedSums sums;
+    for (std::size_t lane = 0; lane < kLanes; ++lane) {
+        sums.weight += static_cast<double>(weight[lane]);
+        sums.stability += static_cast<double>(stabilitySum[lane]);
+        sums.durationMs += static_cast<double>(durationSum[lane]);
+    }
+    return sums;
+}
+
+WeightedSums weighBlockScalar(const float* stability,
+                              const float* durationMs,
+                              std::size_t begin,
+                              std::size_t end,
+                              std::uint64_t key) {
+    return weighBlock(stability, durationMs, begin, end, key);
+}
+
+#if CLAMP_BOOTSTRAP_AVX2
+__attribute__((target("avx2"))) WeightedSums weighBlockAvx2(const float* stability,
+                                                             const float* durationMs,
+                                                             std::size_t begin,
+                                                             std::size_t end,
+                                                             std::uint64_t key) {
+    return weighBlock(stability, durationMs, begin, end, key);
+}
+#endif
+
+using BlockKernel = WeightedSums (*)(const float*, const float*, std::size_t, std::size_t, std::uint64_t);
+
+BlockKernel blockKernel() {
+#if CLAMP_BOOTSTRAP_AVX2
+    static const BlockKernel selected = __builtin_cpu_supports("avx2") ? weighBlockAvx2 : weighBlockScalar;
+    return selected;
+#else
+    return weighBlockScalar;
+#endif
+}
+
+double columnMean(const double* values, std::size_t size) {
+    double sum = 0.0;
+    for (std::size_t i = 0; i < size; ++i) {
+        sum += values[i];
+    }
+    return size == 0 ? 0.0 : sum / static_cast<double>(size);
+}
+
+} // namespace
+
+ResampledMeans bootstrapMeans(const double* stability,
+                              const double* durationMs,
+                              std::size_t size,
+                              std::size_t resamples,
+                              std::uint64_t stream,
+                              std::size_t workerCount) {
+    ResampledMeans means;
+    means.stability.assign(resamples, 0.0);
+    means.durationMs.assign(resamples, 0.0);
+    if (size == 0 || resamples == 0) {
+        return means;
+    }
+
+    const double stabilityMean = columnMean(stability, size);
+    const double durationMean = columnMean(durationMs, size);
+    std::vector<float> shiftedStability(size);
+    std::vector<float> shiftedDuration(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        shiftedStability[i] = static_cast<float>(stability[i] - stabilityMean);
+        shiftedDuration[i] = static_cast<float>(durationMs[i] - durationMean);
+    }
+
+    const BlockKernel kernel = blockKernel();
+    const std::size_t chunks = (resamples + kResampleChunk - 1) / kResampleChunk;
+    parallelFor(chunks, workerCount, [&](std::size_t chunk) {
+        const std::size_t first = chunk * kResampleChunk;
+        const std::size_t count = std::min(kResampleChunk, resamples - first);
+        std::uint64_t keys[kResampleChunk];
+        WeightedSums totals[kResampleChunk] = {};
+        for (std::size_t r = 0; r < count; ++r) {
+            keys[r] = resampleKey(stream, first + r);
+        }
+        for (std::size_t begin = 0; begin < size; begin += kBlockSize) {
+            const std::size_t end = std::min(size, begin + kBlockSize);
+            for (std::size_t r = 0; r < count; ++r) {
+                const WeightedSums block = kernel(shiftedStability.data(), shiftedDuration.data(), begin, end, keys[r]);
+                totals[r].weight += block.weight;
+                totals[r].stability += block.stability;
+                totals[r].durationMs += block.durationMs;
+            }
+        }
+        for (std::size_t r = 0; r < count; ++r) {
+            // An all-zero draw (only plausible for a handful of records)
+            // leaves the replicate at the sample mean.
+            const double weight = totals[r].weight;
+            means.stability[first + r] = stabilityMean + (weight > 0.0 ? totals[r].stability / weight : 0.0);
+            means.durationMs[first + r] = durationMean + (weight > 0.0 ? totals[r].durationMs / weight : 0.0);
+        }
+    });
+    return means;
+}
+
+const char* bootstrapKernelName() {
+#if CLAMP_BOOTSTRAP_AVX2
+    return blockKernel() == weighBlockAvx2 ? "avx2" : "scalar";
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace clamp::detail
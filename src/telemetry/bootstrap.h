@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace clamp::detail {
+
+// Bootstrap replicates of two column means, one value per resample.
+struct ResampledMeans {
+    std::vector<double> stability;
+    std::vector<double> durationMs;
+};
+
+// Poisson bootstrap: in resample r every record is weighted by an independent
+// Poisson(1) draw instead of drawing n records with replacement, which is
+// equivalent for large n and needs no gather. Draws come from a counter-based
+// hash of (stream, r, record index), so every replicate is reproducible on its
+// own and results are identical for any worker count. Resamples are spread
+// over `workerCount` threads (0 selects hardware_concurrency()).
+ResampledMeans bootstrapMeans(const double* stability,
+                              const double* durationMs,
+                              std::size_t size,
+                              std::size_t resamples,
+                              std::uint64_t stream,
+                              std::size_t workerCount);
+
+// Name of the kernel selected for this CPU ("avx2" or "scalar").
+const char* bootstrapKernelName();
+
+} // namespace clamp::detail
@@ -0,0 +1,258 @@
+#include "compression.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#if !defined(CLAMP_HAS_ZLIB)
+#define CLAMP_HAS_ZLIB 0
+#endif
+#if !defined(CLAMP_HAS_ZSTD)
+#define CLAMP_HAS_ZSTD 0
+#endif
+
+#if CLAMP_HAS_ZLIB
+#include <zlib.h>
+#endif
+#if CLAMP_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace clamp::detail {
+namespace {
+
+constexpr std::size_t kInputChunkBytes = 256 * 1024;
+constexpr std::size_t kOutputChunkBytes = 256 * 1024;
+
+struct FileCloser {
+    void operator()(std::FILE* file) const { std::fclose(file); }
+};
+
+using FileHandle = std::unique_ptr<std::FILE, FileCloser>;
+
+FileHandle openForRead(const std::filesystem::path& path) {
+#if defined(_WIN32)
+    return FileHandle(_wfopen(path.c_str(), L"rb"));
+#else
+    return FileHandle(std::fopen(path.c_str(), "rb"));
+#endif
+}
+
+#if CLAMP_HAS_ZLIB
+bool gzipCompress(std::string_view input, std::string& output) {
+    z_stream stream{};
+    // 15 window bits plus 16 selects the gzip wrapper.
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+    output.resize(deflateBound(&stream, static_cast<uLong>(input.size())));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream.avail_in = static_cast<uInt>(input.size());
+    stream.next_out = reinterpret_cast<Bytef*>(output.data());
+    stream.avail_out = static_cast<uInt>(output.size());
+    const int status = deflate(&stream, Z_FINISH);
+    output.resize(stream.total_out);
+    deflateEnd(&stream);
+    return status == Z_STREAM_END;
+}
+
+bool gzipDecompress(std::FILE* file, const std::function<bool(std::string_view)>& consumer) {
+    z_stream stream{};
+    // 32 enables automatic gzip/zlib header detection.
+    if (inflateInit2(&stream, 15 + 32) != Z_OK) {
+        return false;
+    }
+    std::vector<char> input(kInputChunkBytes);
+    std::vector<char> output(kOutputChunkBytes);
+    bool ok = true;
+    bool midStream = false;
+    while (ok) {
+        const std::size_t got = std::fread(input.data(), 1, input.size(), file);
+        if (got == 0) {
+            ok = !std::ferror(file) && !midStream;
+            break;
+        }
+        stream.next_in = reinterpret_cast<Bytef*>(input.data());
+        stream.avail_in = static_cast<uInt>(got);
+        // A full output buffer may leave decoded bytes inside zlib, so keep
+        // inflating until it stops filling the buffer.
+        do {
+            stream.next_out = reinterpret_cast<Bytef*>(output.data());
+            stream.avail_out = static_cast<uInt>(output.size());
+            const int status = inflate(&stream, Z_NO_FLUSH);
+            if (status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR) {
+                ok = false;
+                break;
+            }
+            const std::size_t produced = output.size() - stream.avail_out;
+            if (produced > 0 && !consumer(std::string_view(output.data(), produced))) {
+                ok = false;
+                break;
+            }
+            if (status == Z_STREAM_END) {
+                // Another gzip member may follow.
+                inflateReset(&stream);
+                midStream = false;
+            } else if (status == Z_OK) {
+                midStream = true;
+            } else {
+                break;
+            }
+        } while (stream.avail_in > 0 || stream.avail_out == 0);
+    }
+    inflateEnd(&stream);
+    return ok;
+}
+#endif
+
+#if CLAMP_HAS_ZSTD
+bool zstdCompress(std::string_view input, std::string& output) {
+    output.resize(ZSTD_compressBound(input.size()));
+    const std::size_t written = ZSTD_compress(output.data(), output.size(), input.data(), input.size(), 3);
+    if (ZSTD_isError(written)) {
+        return false;
+    }
+    output.resize(written);
+    return true;
+}
+
+bool zstdDecompress(std::FILE* file, const std::function<bool(std::string_view)>& consumer) {
+    std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> context(ZSTD_createDCtx(), ZSTD_freeDCtx);
+    if (!context) {
+        return false;
+    }
+    std::vector<char> input(kInputChunkBytes);
+    std::vector<char> output(kOutputChunkBytes);
+    // Non-zero while a frame is incomplete.
+    std::size_t pending = 0;
+    for (;;) {
+        const std::size_t got = std::fread(input.data(), 1, input.size(), file);
+        if (got == 0) {
+            return !std::ferror(file) && pending == 0;
+        }
+        ZSTD_inBuffer in{input.data(), got, 0};
+        bool outputFull = false;
+        while (in.pos < in.size || outputFull) {
+            ZSTD_outBuffer out{output.data(), output.size(), 0};
+            pending = ZSTD_decompressStream(context.get(), &out, &in);
+            if (ZSTD_isError(pending)) {
+                return false;
+            }
+            if (out.pos > 0 && !consumer(std::string_view(output.data(), out.pos))) {
+                return false;
+            }
+            outputFull = out.pos == out.size;
+        }
+    }
+}
+#endif
+
+} // namespace
+
+TelemetryCompression compressionForPath(const std::filesystem::path& path) {
+    // Compared on the native string: this runs for every listed file, and
+    // extension()/stem() each build a new path.
+    const auto& name = path.native();
+    auto isSeparator = [](auto ch) { return ch == '/' || ch == std::filesystem::path::preferred_separator; };
+    auto endsWith = [&](std::string_view suffix) {
+        if (name.size() <= suffix.size() || isSeparator(name[name.size() - suffix.size() - 1])) {
+            return false;
+        }
+        return std::equal(suffix.begin(), suffix.end(), name.end() - static_cast<std::ptrdiff_t>(suffix.size()));
+    };
+    if (endsWith(".json.gz")) {
+        return TelemetryCompression::Gzip;
+    }
+    if (endsWith(".json.zst")) {
+        return TelemetryCompression::Zstd;
+    }
+    return TelemetryCompression::None;
+}
+
+const char* compressionExtension(TelemetryCompression compression) {
+    switch (compression) {
+    case TelemetryCompression::Gzip:
+        return ".gz";
+    case TelemetryCompression::Zstd:
+        return ".zst";
+    case TelemetryCompression::None:
+        break;
+    }
+    return "";
+}
+
+bool compressionSupported(TelemetryCompression compression) {
+    switch (compression) {
+    case TelemetryCompression::Gzip:
+        return CLAMP_HAS_ZLIB != 0;
+    case TelemetryCompression::Zstd:
+        return CLAMP_HAS_ZSTD != 0;
+    case TelemetryCompression::None:
+        break;
+    }
+    return true;
+}
+
+bool compressBuffer(std::string_view input, TelemetryCompression compression, std::string& output) {
+    switch (compression) {
+    case TelemetryCompression::Gzip:
+#if CLAMP_HAS_ZLIB
+        return gzipCompress(input, output);
+#else
+        return false;
+#endif
+    case TelemetryCompression::Zstd:
+#if CLAMP_HAS_ZSTD
+        return zstdCompress(input, output);
+#else
+        return false;
+#endif
+    case TelemetryCompression::None:
+        break;
+    }
+    output.assign(input);
+    return true;
+}
+
+bool decompressFile(const std::filesystem::path& path,
+                    TelemetryCompression compression,
+                    const std::function<bool(std::string_view)>& consumer) {
+    if (!compressionSupported(compression)) {
+        return false;
+    }
+    const FileHandle file = openForRead(path);
+    if (!file) {
+        return false;
+    }
+    switch (compression) {
+    case TelemetryCompression::Gzip:
+#if CLAMP_HAS_ZLIB
+        return gzipDecompress(file.get(), consumer);
+#else
+        return false;
+#endif
+    case TelemetryCompression::Zstd:
+#if CLAMP_HAS_ZSTD
+        return zstdDecompress(file.get(), consumer);
+#else
+        return false;
+#endif
+    case TelemetryCompression::None:
+        break;
+    }
+    std::vector<char> buffer(kInputChunkBytes);
+    for (;;) {
+        const std::size_t got = std::fread(buffer.data(), 1, buffer.size(), file.get());
+        if (got == 0) {
+            return !std::ferror(file.get());
+        }
+        if (!consumer(std::string_view(buffer.data(), got))) {
+            return false;
+        }
+    }
+}
+
+} // namespace clamp::detail
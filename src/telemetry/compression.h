@@ -0,0 +1,33 @@
+#pragma once
+
+#include "clamp/EntropyTelemetry.h"
+
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace clamp::detail {
+
+// Codec implied by a telemetry file name: "*.json.gz" or "*.json.zst";
+// TelemetryCompression::None for anything else.
+TelemetryCompression compressionForPath(const std::filesystem::path& path);
+
+// ".gz", ".zst" or "" for None.
+const char* compressionExtension(TelemetryCompression compression);
+
+// Whether the codec was found at configure time (None is always supported).
+bool compressionSupported(TelemetryCompression compression);
+
+// Compresses a complete document; gzip output carries a standard gzip header.
+bool compressBuffer(std::string_view input, TelemetryCompression compression, std::string& output);
+
+// Streams the decompressed contents of `path` to `consumer` in chunks of at
+// most a few hundred KiB. Concatenated gzip members and zstd frames are read
+// back to back. Returns false on a read or format error, or when `consumer`
+// returns false to stop early.
+bool decompressFile(const std::filesystem::path& path,
+                    TelemetryCompression compression,
+                    const std::function<bool(std::string_view)>& consumer);
+
+} // namespace clamp::detail
@@ -0,0 +1,194 @@
+#include "clamp/EntropyBackend.h"
+
+#include "clamp.h"
+#include "clamp/EntropyTelemetry.h"
+
+#include "../common/parallel_for.h"
+#include "entropy_mirror.h"
+#include "hip_entropy_backend.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+
+#ifndef CLAMP_HAS_HIP
+#define CLAMP_HAS_HIP 0
+#endif
+
+namespace clamp {
+
+namespace {
+
+constexpr const char* kBackendEnvironmentVariable = "CLAMP_ENTROPY_BACKEND";
+
+class CpuScalarBackend final : public EntropyBackend {
+public:
+    const char* name() const override { return "cpu-scalar"; }
+    std::string telemetryBackend() const override { return "CPU"; }
+    std::string deviceName() const override { return "host"; }
+    EntropyBackendCapabilities capabilities() const override { return {false, 1, "scalar"}; }
+
+protected:
+    std::optional<bool> run(const std::uint64_t* seeds, const int* states, std::size_t count) override {
+        return detail::scalarEntropyMirror(seeds, states, count);
+    }
+};
+
+class CpuParallelBackend final : public EntropyBackend {
+public:
+    explicit CpuParallelBackend(std::size_t workerCount)
+        : workerCount_(detail::resolveWorkerCount(workerCount)) {}
+
+    const char* name() const override { return "cpu-parallel"; }
+    std::string telemetryBackend() const override { return "CPU"; }
+    std::string deviceName() const override { return "host"; }
+    EntropyBackendCapabilities capabilities() const override {
+        return {false, workerCount_, detail::mirrorKernelName()};
+    }
+
+protected:
+    std::optional<bool> run(const std::uint64_t* seeds, const int* states, std::size_t count) override {
+        return detail::cpuEntropyMirror(seeds, states, count, workerCount_);
+    }
+
+private:
+    std::size_t workerCount_;
+};
+
+struct Selection {
+    std::mutex mutex;
+    std::shared_ptr<EntropyBackend> backend;
+};
+
+Selection& selection() {
+    static Selection instance;
+    return instance;
+}
+
+// Caller holds selection().mutex.
+bool selectFromEnvironmentLocked(Selection& current) {
+    const char* requested = std::getenv(kBackendEnvironmentVariable);
+    if (requested != nullptr && *requested != '\0') {
+        if (auto backend = makeEntropyBackend(requested)) {
+            current.backend = std::move(backend);
+            return true;
+        }
+    }
+    current.backend = makeEntropyBackend("auto");
+    return requested == nullptr || *requested == '\0';
+}
+
+} // namespace
+
+std::optional<bool> EntropyBackend::mirror(const std::vector<std::uint64_t>& seeds, const std::vector<int>& states) {
+    if (seeds.size() != states.size()) {
+        return false;
+    }
+    if (seeds.empty()) {
+        return true;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    const std::optional<bool> matched = run(seeds.data(), states.data(), seeds.size());
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    if (matched) {
+        entries_.fetch_add(seeds.size(), std::memory_order_relaxed);
+        nanoseconds_.fetch_add(
+            static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()),
+            std::memory_order_relaxed);
+    }
+    return matched;
+}
+
+double EntropyBackend::measuredThroughput() const {
+    const std::uint64_t nanoseconds = nanoseconds_.load(std::memory_order_relaxed);
+    if (nanoseconds == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(entries_.load(std::memory_order_relaxed)) * 1e9 / static_cast<double>(nanoseconds);
+}
+
+std::vector<std::string> entropyBackendNames() {
+    std::vector<std::string> names;
+#if CLAMP_HAS_HIP
+    names.emplace_back("hip");
+#endif
+    names.emplace_back("cpu-parallel");
+    names.emplace_back("cpu-scalar");
+    return names;
+}
+
+std::unique_ptr<EntropyBackend> makeEntropyBackend(std::string_view name, std::size_t workerCount) {
+    if (name == "auto") {
+        for (const std::string& candidate : entropyBackendNames()) {
+            if (auto backend = makeEntropyBackend(candidate, workerCount)) {
+                return backend;
+            }
+        }
+        return nullptr;
+    }
+    if (name == "cpu-parallel") {
+        return std::make_unique<CpuParallelBackend>(workerCount);
+    }
+    if (name == "cpu-scalar") {
+        return std::make_unique<CpuScalarBackend>();
+    }
+    if (name == "hip") {
+        return detail::makeHipEntropyBackend();
+    }
+    return nullptr;
+}
+
+std::vector<std::unique_ptr<EntropyBackend>> availableEntropyBackends(std::size_t workerCount) {
+    std::vector<std::unique_ptr<EntropyBackend>> backends;
+    for (const std::string& name : entropyBackendNames()) {
+        if (auto backend = makeEntropyBackend(name, workerCount)) {
+            backends.push_back(std::move(backend));
+        }
+    }
+    return backends;
+}
+
+std::shared_ptr<EntropyBackend> activeEntropyBackend() {
+    Selection& current = selection();
+    std::lock_guard<std::mutex> lock(current.mutex);
+    if (!current.backend) {
+        selectFromEnvironmentLocked(current);
+    }
+    return current.backend;
+}
+
+bool selectEntropyBackend(std::string_view name) {
+    auto backend = makeEntropyBackend(name);
+    if (!backend) {
+        return false;
+    }
+    Selection& current = selection();
+    std::lock_guard<std::mutex> lock(current.mutex);
+    current.backend = std::move(backend);
+    return true;
+}
+
+bool selectEntropyBackendFromEnvironment() {
+    Selection& current = selection();
+    std::lock_guard<std::mutex> lock(current.mutex);
+    return selectFromEnvironmentLocked(current);
+}
+
+bool runHipEntropyMirror(const std::vector<std::uint64_t>& seeds, const std::vector<int>& states) {
+    if (seeds.size() != states.size()) {
+        return false;
+    }
+    const std::shared_ptr<EntropyBackend> backend = activeEntropyBackend();
+    if (const auto matched = backend->mirror(seeds, states)) {
+        // Telemetry is only attributed to a device once it has done the work.
+        if (backend->capabilities().device) {
+            if (auto* telemetry = EntropyTelemetry::activeInstance()) {
+                telemetry->setBackendMetadata(backend->telemetryBackend(), backend->deviceName());
+            }
+        }
+        return *matched;
+    }
+    return detail::cpuEntropyMirror(seeds.data(), states.data(), seeds.size(), 0);
+}
+
+} // namespace clamp
@@ -0,0 +1,148 @@
+#include "entropy_mirror.h"
+
+#include "../common/parallel_for.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace clamp::detail {
+
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(__clang__))
+#define CLAMP_MIRROR_AVX2 1
+#define CLAMP_MIRROR_INLINE __attribute__((always_inline)) inline
+#else
+#define CLAMP_MIRROR_AVX2 0
+#define CLAMP_MIRROR_INLINE inline
+#endif
+
+namespace {
+
+// 32k entries are 384 KiB of seeds and states, so a copied chunk is still in
+// L2 when it is compared.
+constexpr std::size_t kChunkEntries = 32 * 1024;
+// Below this many entries the mirror runs on the calling thread.
+constexpr std::size_t kParallelMinEntries = 256 * 1024;
+
+// OR of the XOR of both buffers: zero exactly when they match. The loop has no
+// early exit, so it vectorises; chunks are small enough that a mismatch costs
+// at most one chunk of extra work.
+CLAMP_MIRROR_INLINE bool chunkMatches(const std::uint64_t* seeds,
+                                      const std::uint64_t* seedsOut,
+                                      const int* states,
+                                      const int* statesOut,
+                                      std::size_t count) {
+    std::uint64_t seedBits = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        seedBits |= seeds[i] ^ seedsOut[i];
+    }
+    unsigned int stateBits = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        stateBits |= static_cast<unsigned int>(states[i] ^ statesOut[i]);
+    }
+    return seedBits == 0 && stateBits == 0;
+}
+
+bool chunkMatchesScalar(const std::uint64_t* seeds,
+                        const std::uint64_t* seedsOut,
+                        const int* states,
+                        const int* statesOut,
+                        std::size_t count) {
+    return chunkMatches(seeds, seedsOut, states, statesOut, count);
+}
+
+#if CLAMP_MIRROR_AVX2
+__attribute__((target("avx2"))) bool chunkMatchesAvx2(const std::uint64_t* seeds,
+                                                       const std::uint64_t* seedsOut,
+                                                       const int* states,
+                                                       const int* statesOut,
+                                                       std::size_t count) {
+    return chunkMatches(seeds, seedsOut, states, statesOut, count);
+}
+#endif
+
+using ChunkKernel = bool (*)(const std::uint64_t*, const std::uint64_t*, const int*, const int*, std::size_t);
+
+ChunkKernel chunkKernel() {
+#if CLAMP_MIRROR_AVX2
+    static const ChunkKernel selected = __builtin_cpu_supports("avx2") ? chunkMatchesAvx2 : chunkMatchesScalar;
+    return selected;
+#else
+    return chunkMatchesScalar;
+#endif
+}
+
+// Runs fn(begin, end) over chunks of [0, count) until one returns false.
+template <typename Fn>
+bool allChunks(std::size_t count, std::size_t workerCount, Fn&& fn) {
+    const std::size_t chunks = (count + kChunkEntries - 1) / kChunkEntries;
+    const std::size_t workers = count < kParallelMinEntries ? 1 : workerCount;
+    std::atomic<bool> matched{true};
+    parallelFor(chunks, workers, [&](std::size_t chunk) {
+        if (!matched.load(std::memory_order_relaxed)) {
+            return;
+        }
+        const std::size_t begin = chunk * kChunkEntries;
+        const std::size_t end = std::min(count, begin + kChunkEntries);
+        if (!fn(begin, end)) {
+            matched.store(false, std::memory_order_relaxed);
+        }
+    });
+    return matched.load();
+}
+
+} // namespace
+
+bool cpuEntropyMirror(const std::uint64_t* seeds, const int* states, std::size_t count, std::size_t workerCount) {
+    if (count == 0) {
+        return true;
+    }
+    // Left uninitialised: every entry is written by its chunk's copy.
+    const std::unique_ptr<std::uint64_t[]> seedsOut(new std::uint64_t[count]);
+    const std::unique_ptr<int[]> statesOut(new int[count]);
+    const ChunkKernel kernel = chunkKernel();
+    return allChunks(count, workerCount, [&](std::size_t begin, std::size_t end) {
+        std::memcpy(seedsOut.get() + begin, seeds + begin, (end - begin) * sizeof(std::uint64_t));
+        std::memcpy(statesOut.get() + begin, states + begin, (end - begin) * sizeof(int));
+        return kernel(seeds + begin, seedsOut.get() + begin, states + begin, statesOut.get() + begin, end - begin);
+    });
+}
+
+bool scalarEntropyMirror(const std::uint64_t* seeds, const int* states, std::size_t count) {
+    std::vector<std::uint64_t> seedsOut(count);
+    std::vector<int> statesOut(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        seedsOut[i] = seeds[i];
+        statesOut[i] = states[i];
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        if (seedsOut[i] != seeds[i] || statesOut[i] != states[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool mirrorMatches(const std::uint64_t* seeds,
+                   const std::uint64_t* seedsOut,
+                   const int* states,
+                   const int* statesOut,
+                   std::size_t count,
+                   std::size_t workerCount) {
+    const ChunkKernel kernel = chunkKernel();
+    return allChunks(count, workerCount, [&](std::size_t begin, std::size_t end) {
+        return kernel(seeds + begin, seedsOut + begin, states + begin, statesOut + begin, end - begin);
+    });
+}
+
+const char* mirrorKernelName() {
+#if CLAMP_MIRROR_AVX2
+    return chunkKernel() == chunkMatchesAvx2 ? "avx2" : "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace clamp::detail
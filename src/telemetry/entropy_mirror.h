@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace clamp::detail {
+
+// Host implementation of the entropy mirror: seeds and states are copied into
+// fresh buffers chunk by chunk and each chunk is compared against its source
+// while still in cache. Chunks are spread over `workerCount` threads (0 selects
+// hardware_concurrency()); small inputs stay on the calling thread.
+bool cpuEntropyMirror(const std::uint64_t* seeds, const int* states, std::size_t count, std::size_t workerCount);
+
+// Reference mirror: one thread, element by element, stopping at the first
+// difference.
+bool scalarEntropyMirror(const std::uint64_t* seeds, const int* states, std::size_t count);
+
+// Whether two seed/state buffer pairs are identical, compared in parallel
+// chunks with a vectorised XOR/OR reduction (AVX2 when available).
+bool mirrorMatches(const std::uint64_t* seeds,
+                   const std::uint64_t* seedsOut,
+                   const int* states,
+                   const int* statesOut,
+                   std::size_t count,
+                   std::size_t workerCount);
+
+// Name of the compare kernel selected for this CPU: "avx2", "sse2" (the x86-64
+// baseline) or "scalar".
+const char* mirrorKernelName();
+
+} // namespace clamp::detail
@@ -1,5 +1,9 @@
 #include "clamp/EntropyTelemetry.h"
 
+#include "compression.h"
+
+#include <algorithm>
+#include <cmath>
 #include <ctime>
 #include <filesystem>
 #include <fstream>
@@ -52,6 +56,62 @@ std::string escapeJson(const std::string& value) {
     return oss.str();
 }
 
+using OverheadClock = std::chrono::steady_clock;
+
+std::uint64_t elapsedNs(OverheadClock::time_point start) {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(OverheadClock::now() - start).count());
+}
+
+// Times the enclosing scope when `active`; used for the sampled acquire/release counters.
+class SampledTimer {
+public:
+    SampledTimer(bool active, std::atomic<std::uint64_t>& samples, std::atomic<std::uint64_t>& totalNs)
+        : active_(active), samples_(samples), totalNs_(totalNs) {
+        if (active_) {
+            start_ = OverheadClock::now();
+        }
+    }
+
+    ~SampledTimer() {
+        if (active_) {
+            totalNs_.fetch_add(elapsedNs(start_), std::memory_order_relaxed);
+            samples_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    SampledTimer(const SampledTimer&) = delete;
+    SampledTimer& operator=(const SampledTimer&) = delete;
+
+private:
+    bool active_;
+    std::atomic<std::uint64_t>& samples_;
+    std::atomic<std::uint64_t>& totalNs_;
+    OverheadClock::time_point start_{};
+};
+
+bool shouldSample(std::atomic<std::uint64_t>& calls) {
+    return calls.fetch_add(1, std::memory_order_relaxed) % EntropyTelemetry::kOverheadSampleInterval == 0;
+}
+
+std::size_t heapStringBytes(const std::string& value) {
+    static const std::size_t inlineCapacity = std::string{}.capacity();
+    return value.capacity() > inlineCapacity ? value.capacity() + 1 : 0;
+}
+
+double estimateTotalNs(std::uint64_t calls, std::uint64_t samples, std::uint64_t sampledNs) {
+    if (samples == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(sampledNs) / static_cast<double>(samples) * static_cast<double>(calls);
+}
+
+// Parameters of the per-release score (see ReleaseScorer).
+constexpr double kReleaseScoreAlpha = 1.0 / 32.0;
+constexpr double kReleaseScoreHalfWidth = 3.0;
+constexpr double kReleaseScoreRelativeFloor = 0.05;
+constexpr double kReleaseScoreAbsoluteFloorMs = 0.005;
+
 std::filesystem::path resolveDirectory(const std::filesystem::path& directory) {
     if (directory.empty()) {
         return std::filesystem::current_path() / "telemetry";
@@ -64,7 +124,46 @@ std::filesystem::path resolveDirectory(const std::filesystem::path& directory) {
 
 } // namespace
 
+std::size_t TelemetryOverhead::totalBytes() const {
+    return recordBytes + stringBytes;
+}
+
+double TelemetryOverhead::estimatedAcquireNs() const {
+    return estimateTotalNs(acquireCalls, acquireSamples, acquireSampledNs);
+}
+
+double TelemetryOverhead::estimatedReleaseNs() const {
+    return estimateTotalNs(releaseCalls, releaseSamples, releaseSampledNs);
+}
+
+std::string TelemetryOverhead::toJson() const {
+    std::ostringstream oss;
+    oss << "{";
+    oss << "\"record_count\":" << recordCount << ",";
+    oss << "\"record_bytes\":" << recordBytes << ",";
+    oss << "\"string_bytes\":" << stringBytes << ",";
+    oss << "\"total_bytes\":" << totalBytes() << ",";
+    oss << "\"sample_interval\":" << EntropyTelemetry::kOverheadSampleInterval << ",";
+    oss << "\"acquire_calls\":" << acquireCalls << ",";
+    oss << "\"acquire_samples\":" << acquireSamples << ",";
+    oss << "\"acquire_sampled_ns\":" << acquireSampledNs << ",";
+    oss << "\"release_calls\":" << releaseCalls << ",";
+    oss << "\"release_samples\":" << releaseSamples << ",";
+    oss << "\"release_sampled_ns\":" << releaseSampledNs << ",";
+    oss << "\"serialization_count\":" << serializationCount << ",";
+    oss << "\"serialization_ns\":" << serializationNs << ",";
+    oss << "\"serialized_bytes\":" << serializedBytes << ",";
+    oss << "\"lock_acquisitions\":" << lockAcquisitions << ",";
+    oss << "\"lock_contentions\":" << lockContentions << ",";
+    oss << "\"lock_wait_ns\":" << lockWaitNs;
+    oss << "}";
+    return oss.str();
+}
+
 std::size_t EntropyTelemetry::recordAcquire(const std::string& context, std::uint64_t seed) {
+    SampledTimer timer(shouldSample(counters_.acquireCalls),
+                       counters_.acquireSamples,
+                       counters_.acquireSampledNs);
     AnchorTelemetryRecord record;
     record.context = context;
     record.seed = seed;
@@ -72,7 +171,7 @@ std::size_t EntropyTelemetry::recordAcquire(const std::string& context, std::uin
     record.acquiredAt = std::chrono::system_clock::now();
 
     setActiveInstance(this);
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto lock = lockRecords();
     if (backend_.empty()) {
         backend_ = "CPU";
     }
@@ -85,21 +184,17 @@ std::size_t EntropyTelemetry::recordAcquire(const std::string& context, std::uin
     return records_.size() - 1;
 }
 
-void EntropyTelemetry::recordRelease(std::size_t recordId,
-                                     const std::string& context,
-                                     std::uint64_t seed,
-                                     double stabilityScore) {
-    const auto now = std::chrono::system_clock::now();
-
-    std::lock_guard<std::mutex> lock(mutex_);
+AnchorTelemetryRecord* EntropyTelemetry::releaseLocked(std::size_t recordId,
+                                                      const std::string& context,
+                                                      std::uint64_t seed,
+                                                      std::chrono::system_clock::time_point now) {
     if (recordId >= records_.size()) {
-        return;
+        return nullptr;
     }
 
     auto& record = records_[recordId];
     record.releasedAt = now;
     record.durationMs = std::chrono::duration<double, std::milli>(now - record.acquiredAt).count();
-    record.stabilityScore = stabilityScore;
     record.backend = backend_;
     record.deviceName = deviceName_;
     if (record.context.empty()) {
@@ -108,10 +203,162 @@ void EntropyTelemetry::recordRelease(std::size_t recordId,
     if (record.seed == 0) {
         record.seed = seed;
     }
+    return &record;
+}
+
+void EntropyTelemetry::recordRelease(std::size_t recordId,
+                                     const std::string& context,
+                                     std::uint64_t seed,
+                                     double stabilityScore) {
+    SampledTimer timer(shouldSample(counters_.releaseCalls),
+                       counters_.releaseSamples,
+                       counters_.releaseSampledNs);
+    const auto now = std::chrono::system_clock::now();
+    auto lock = lockRecords();
+    if (auto* record = releaseLocked(recordId, context, seed, now)) {
+        record->stabilityScore = stabilityScore;
+    }
+}
+
+EntropyTelemetry::ContextDurationStats& EntropyTelemetry::contextStatsLocked(const std::string& context) {
+    if (lastContext_ == nullptr || *lastContext_ != context) {
+        auto& entry = *contextStats_.try_emplace(context).first;
+        lastContext_ = &entry.first;
+        lastContextStats_ = &entry.second;
+    }
+    return *lastContextStats_;
+}
+
+void EntropyTelemetry::recordRelease(std::size_t recordId, const std::string& context, std::uint64_t seed) {
+    SampledTimer timer(shouldSample(counters_.releaseCalls),
+                       counters_.releaseSamples,
+                       counters_.releaseSampledNs);
+    const auto now = std::chrono::system_clock::now();
+    auto lock = lockRecords();
+    auto* record = releaseLocked(recordId, context, seed, now);
+    if (record == nullptr) {
+        return;
+    }
+
+    ContextDurationStats& stats = contextStatsLocked(record->context);
+    const double duration = record->durationMs;
+    if (!std::isfinite(duration)) {
+        record->stabilityScore = 0.0;
+        return;
+    }
+    const double spread = stats.scorer.spreadMs();
+    record->stabilityScore = stats.scorer.observe(duration);
+
+    if (!changePointOptions_.enabled) {
+        return;
+    }
+    const auto shift = stats.detector.observe(duration, spread, changePointOptions_);
+    if (!shift) {
+        return;
+    }
+    TelemetryChangePoint changePoint;
+    changePoint.context = record->context;
+    changePoint.recordIndex = recordId;
+    changePoint.detectedAt = record->releasedAt.value_or(now);
+    changePoint.baselineMs = shift->baselineMs;
+    changePoint.observedMs = duration;
+    changePoint.increase = shift->increase;
+    ++changePointCount_;
+    if (changePoints_.size() == kRetainedChangePoints) {
+        changePoints_.pop_front();
+    }
+    changePoints_.push_back(changePoint);
+    auto callback = changePointCallback_;
+    lock.unlock();
+    if (callback) {
+        callback(changePoint);
+    }
+}
+
+double ReleaseScorer::observe(double durationMs) {
+    const double diff = durationMs - mean_;
+    double score = 1.0;
+    if (count_ != 0) {
+        // The spread is bounded below by a few percent of the typical duration
+        // (or a few microseconds), which is scheduling noise. A release that
+        // deviates by kReleaseScoreHalfWidth spreads scores 0.5.
+        const double floor = std::max(kReleaseScoreRelativeFloor * std::abs(mean_), kReleaseScoreAbsoluteFloorMs);
+        const double width2 = kReleaseScoreHalfWidth * kReleaseScoreHalfWidth * (variance_ + floor * floor);
+        score = width2 / (width2 + diff * diff);
+    }
+
+    // Exponentially weighted mean and variance. Until 1 / kReleaseScoreAlpha
+    // samples have been seen the weight is 1 / count, so early statistics are
+    // plain running averages instead of being biased to zero.
+    ++count_;
+    const double alpha = count_ * kReleaseScoreAlpha < 1.0 ? 1.0 / static_cast<double>(count_) : kReleaseScoreAlpha;
+    const double increment = alpha * diff;
+    mean_ += increment;
+    variance_ = (1.0 - alpha) * (variance_ + diff * increment);
+    return score;
+}
+
+double ReleaseScorer::spreadMs() const {
+    return std::sqrt(variance_);
+}
+
+std::optional<ChangePointDetector::Shift> ChangePointDetector::observe(double durationMs,
+                                                                       double spreadMs,
+                                                                       const ChangePointOptions& options) {
+    // Page-Hinkley test in both directions against the running mean of the
+    // current regime. Tolerance and threshold scale with the spread, floored
+    // like the release score's so near-constant holds do not alarm on jitter.
+    const double baseline = regimeMean_;
+    ++regimeCount_;
+    regimeMean_ += (durationMs - regimeMean_) / static_cast<double>(regimeCount_);
+    if (regimeCount_ <= options.warmup) {
+        return std::nullopt;
+    }
+
+    const double scale = std::max({spreadMs,
+                                   kReleaseScoreRelativeFloor * std::abs(regimeMean_),
+                                   kReleaseScoreAbsoluteFloorMs});
+    const double deviation = durationMs - regimeMean_;
+    const double tolerance = options.tolerance * scale;
+    const double threshold = options.threshold * scale;
+    upSum_ += deviation - tolerance;
+    upMin_ = std::min(upMin_, upSum_);
+    downSum_ += deviation + tolerance;
+    downMax_ = std::max(downMax_, downSum_);
+    const bool increase = upSum_ - upMin_ > threshold;
+    const bool decrease = downMax_ - downSum_ > threshold;
+    if (!increase && !decrease) {
+        return std::nullopt;
+    }
+
+    // The shifted distribution becomes the next regime's baseline.
+    *this = ChangePointDetector();
+    return Shift{baseline, increase};
+}
+
+void EntropyTelemetry::setChangePointOptions(ChangePointOptions options) {
+    auto lock = lockRecords();
+    changePointOptions_ = options;
+}
+
+void EntropyTelemetry::setChangePointCallback(std::function<void(const TelemetryChangePoint&)> callback) {
+    auto lock = lockRecords();
+    changePointCallback_ = std::move(callback);
+}
+
+std::vector<TelemetryChangePoint> EntropyTelemetry::changePoints() const {
+    auto lock = lockRecords();
+    return {changePoints_.begin(), changePoints_.end()};
+}
+
+std::uint64_t EntropyTelemetry::changePointCount() const {
+    auto lock = lockRecords();
+    return changePointCount_;
 }
 
 std::string EntropyTelemetry::toJson() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    const auto start = OverheadClock::now();
+    auto lock = lockRecords();
 
     double scoreSum = 0.0;
     for (const auto& record : records_) {
@@ -126,6 +373,21 @@ std::string EntropyTelemetry::toJson() const {
     oss << "\"device_name\":\"" << escapeJson(deviceName_) << "\",";
     oss << "\"stability_score\":" << std::fixed << std::setprecision(6) << averageScore << ",";
     oss << std::defaultfloat;
+    oss << "\"telemetry_overhead\":" << overheadLocked().toJson() << ",";
+    oss << "\"change_point_count\":" << changePointCount_ << ",";
+    oss << "\"change_points\":[";
+    for (std::size_t i = 0; i < changePoints_.size(); ++i) {
+        const auto& changePoint = changePoints_[i];
+        oss << (i > 0 ? "," : "") << "{";
+        oss << "\"context\":\"" << escapeJson(changePoint.context) << "\",";
+        oss << "\"record_index\":" << changePoint.recordIndex << ",";
+        oss << "\"detected_at\":\"" << escapeJson(formatTime(changePoint.detectedAt)) << "\",";
+        oss << "\"direction\":\"" << (changePoint.increase ? "increase" : "decrease") << "\",";
+        oss << "\"baseline_ms\":" << changePoint.baselineMs << ",";
+        oss << "\"observed_ms\":" << changePoint.observedMs;
+        oss << "}";
+    }
+    oss << "],";
     oss << "\"records\": [";
     for (std::size_t i = 0; i < records_.size(); ++i) {
         if (i > 0) {
@@ -151,14 +413,59 @@ std::string EntropyTelemetry::toJson() const {
         oss << "}";
     }
     oss << "] }";
-    return oss.str();
+    std::string payload = oss.str();
+    counters_.serializationCount.fetch_add(1, std::memory_order_relaxed);
+    counters_.serializationNs.fetch_add(elapsedNs(start), std::memory_order_relaxed);
+    counters_.serializedBytes.fetch_add(payload.size(), std::memory_order_relaxed);
+    return payload;
 }
 
 std::vector<AnchorTelemetryRecord> EntropyTelemetry::records() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto lock = lockRecords();
     return records_;
 }
 
+TelemetryOverhead EntropyTelemetry::overhead() const {
+    auto lock = lockRecords();
+    return overheadLocked();
+}
+
+TelemetryOverhead EntropyTelemetry::overheadLocked() const {
+    TelemetryOverhead result;
+    result.recordCount = records_.size();
+    result.recordBytes = records_.capacity() * sizeof(AnchorTelemetryRecord);
+    result.stringBytes = heapStringBytes(backend_) + heapStringBytes(deviceName_);
+    for (const auto& record : records_) {
+        result.stringBytes += heapStringBytes(record.context) + heapStringBytes(record.threadId) +
+                              heapStringBytes(record.backend) + heapStringBytes(record.deviceName);
+    }
+    result.acquireCalls = counters_.acquireCalls.load(std::memory_order_relaxed);
+    result.acquireSamples = counters_.acquireSamples.load(std::memory_order_relaxed);
+    result.acquireSampledNs = counters_.acquireSampledNs.load(std::memory_order_relaxed);
+    result.releaseCalls = counters_.releaseCalls.load(std::memory_order_relaxed);
+    result.releaseSamples = counters_.releaseSamples.load(std::memory_order_relaxed);
+    result.releaseSampledNs = counters_.releaseSampledNs.load(std::memory_order_relaxed);
+    result.serializationCount = counters_.serializationCount.load(std::memory_order_relaxed);
+    result.serializationNs = counters_.serializationNs.load(std::memory_order_relaxed);
+    result.serializedBytes = counters_.serializedBytes.load(std::memory_order_relaxed);
+    result.lockAcquisitions = counters_.lockAcquisitions.load(std::memory_order_relaxed);
+    result.lockContentions = counters_.lockContentions.load(std::memory_order_relaxed);
+    result.lockWaitNs = counters_.lockWaitNs.load(std::memory_order_relaxed);
+    return result;
+}
+
+std::unique_lock<std::mutex> EntropyTelemetry::lockRecords() const {
+    std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+    counters_.lockAcquisitions.fetch_add(1, std::memory_order_relaxed);
+    if (!lock.owns_lock()) {
+        const auto start = OverheadClock::now();
+        lock.lock();
+        counters_.lockContentions.fetch_add(1, std::memory_order_relaxed);
+        counters_.lockWaitNs.fetch_add(elapsedNs(start), std::memory_order_relaxed);
+    }
+    return lock;
+}
+
 void EntropyTelemetry::merge(const EntropyTelemetry& other) {
     if (!other.backend().empty() || !other.deviceName().empty()) {
         setBackendMetadata(other.backend(), other.deviceName());
@@ -171,12 +478,12 @@ void EntropyTelemetry::mergeRecords(const std::vector<AnchorTelemetryRecord>& ex
         return;
     }
 
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto lock = lockRecords();
     records_.insert(records_.end(), externalRecords.begin(), externalRecords.end());
 }
 
 void EntropyTelemetry::alignToReference(const std::chrono::system_clock::time_point& reference) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto lock = lockRecords();
     if (records_.empty()) {
         return;
     }
@@ -217,18 +524,44 @@ bool EntropyTelemetry::writeJSON(const std::filesystem::path& directory,
         return false;
     }
 
-    const auto filename = makeFilename(filenameHint);
+    const auto compression = compression_.load(std::memory_order_relaxed);
+    const auto filename = makeFilename(filenameHint) + detail::compressionExtension(compression);
     const auto fullPath = resolvedDir / filename;
-    std::ofstream out(fullPath);
+    if (compression == TelemetryCompression::None) {
+        std::ofstream out(fullPath);
+        if (!out) {
+            return false;
+        }
+        out << payload;
+        return out.good();
+    }
+
+    std::string compressed;
+    if (!detail::compressBuffer(payload, compression, compressed)) {
+        return false;
+    }
+    std::ofstream out(fullPath, std::ios::binary);
     if (!out) {
         return false;
     }
-    out << payload;
+    out.write(compressed.data(), static_cast<std::streamsize>(compressed.size()));
     return out.good();
 }
 
+void EntropyTelemetry::setCompression(TelemetryCompression compression) {
+    compression_.store(compression, std::memory_order_relaxed);
+}
+
+TelemetryCompression EntropyTelemetry::compression() const {
+    return compression_.load(std::memory_order_relaxed);
+}
+
+bool EntropyTelemetry::compressionSupported(TelemetryCompression compression) {
+    return detail::compressionSupported(compression);
+}
+
 void EntropyTelemetry::setBackendMetadata(std::string backend, std::string deviceName) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto lock = lockRecords();
     if (!backend.empty()) {
         backend_ = std::move(backend);
     }
@@ -242,7 +575,7 @@ void EntropyTelemetry::setBackendMetadata(std::string backend, std::string devic
 }
 
 void EntropyTelemetry::ensureBackendTag(const std::string& backend, const std::string& deviceName) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto lock = lockRecords();
     bool changed = false;
     if (!backend.empty() && backend_ != backend) {
         backend_ = backend;
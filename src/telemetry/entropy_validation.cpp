@@ -1,14 +1,19 @@
-#include "clamp.h"
-#include "clamp/EntropyTelemetry.h"
+#include "hip_entropy_backend.h"
+
+#include "entropy_mirror.h"
 
-#include <algorithm>
 #include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
 #include <vector>
 
-#include <hip/hip_runtime.h>
-
 #ifndef CLAMP_HAS_HIP
-#define CLAMP_HAS_HIP 1
+#define CLAMP_HAS_HIP 0
+#endif
+
+#if CLAMP_HAS_HIP
+#include <hip/hip_runtime.h>
 #endif
 
 namespace clamp {
@@ -22,35 +27,33 @@ void clampMirrorKernel(const std::uint64_t* seedsIn,
                        std::size_t count);
 #endif
 
-bool runHipEntropyMirror(const std::vector<std::uint64_t>& seeds, const std::vector<int>& states) {
-#if CLAMP_HAS_HIP
-    if (seeds.size() != states.size()) {
-        return false;
-    }
-
-    int deviceCount = 0;
-    if (hipGetDeviceCount(&deviceCount) != hipSuccess || deviceCount == 0) {
-        return true;
-    }
+namespace {
 
-    int activeDevice = 0;
-    if (hipGetDevice(&activeDevice) != hipSuccess) {
-        activeDevice = 0;
-    }
-    hipDeviceProp_t props{};
-    if (hipGetDeviceProperties(&props, activeDevice) == hipSuccess) {
-        if (auto* telemetry = EntropyTelemetry::activeInstance()) {
-            telemetry->setBackendMetadata("HIP", props.name);
-        }
-    } else {
-        if (auto* telemetry = EntropyTelemetry::activeInstance()) {
-            telemetry->setBackendMetadata("HIP", "hip-device");
-        }
-    }
-
-    const std::size_t count = seeds.size();
-    if (count == 0) {
-        return true;
+#if CLAMP_HAS_HIP
+// Round-trips the buffers through the device that was current when the
+// backend was created. run() returns nullopt when any HIP call fails.
+class HipEntropyBackend final : public EntropyBackend {
+public:
+    HipEntropyBackend(int device, std::string deviceName, int computeUnits)
+        : device_(device), deviceName_(std::move(deviceName)), computeUnits_(computeUnits) {}
+
+    const char* name() const override { return "hip"; }
+    std::string telemetryBackend() const override { return "HIP"; }
+    std::string deviceName() const override { return deviceName_; }
+    EntropyBackendCapabilities capabilities() const override { return {true, static_cast<std::size_t>(computeUnits_), "hip"}; }
+
+protected:
+    std::optional<bool> run(const std::uint64_t* seeds, const int* states, std::size_t count) override;
+
+private:
+    int device_;
+    std::string deviceName_;
+    int computeUnits_;
+};
+
+std::optional<bool> HipEntropyBackend::run(const std::uint64_t* seeds, const int* states, std::size_t count) {
+    if (hipSetDevice(device_) != hipSuccess) {
+        return std::nullopt;
     }
 
     std::uint64_t* dSeedsIn = nullptr;
@@ -79,28 +82,28 @@ bool runHipEntropyMirror(const std::vector<std::uint64_t>& seeds, const std::vec
 
     if (hipMalloc(reinterpret_cast<void**>(&dSeedsIn), count * sizeof(std::uint64_t)) != hipSuccess) {
         cleanup();
-        return true;
+        return std::nullopt;
     }
     if (hipMalloc(reinterpret_cast<void**>(&dSeedsOut), count * sizeof(std::uint64_t)) != hipSuccess) {
         cleanup();
-        return true;
+        return std::nullopt;
     }
     if (hipMalloc(reinterpret_cast<void**>(&dStatesIn), count * sizeof(int)) != hipSuccess) {
         cleanup();
-        return true;
+        return std::nullopt;
     }
     if (hipMalloc(reinterpret_cast<void**>(&dStatesOut), count * sizeof(int)) != hipSuccess) {
         cleanup();
-        return true;
+        return std::nullopt;
     }
 
-    if (hipMemcpy(dSeedsIn, seeds.data(), count * sizeof(std::uint64_t), hipMemcpyHostToDevice) != hipSuccess) {
+    if (hipMemcpy(dSeedsIn, seeds, count * sizeof(std::uint64_t), hipMemcpyHostToDevice) != hipSuccess) {
         cleanup();
-        return true;
+        return std::nullopt;
     }
-    if (hipMemcpy(dStatesIn, states.data(), count * sizeof(int), hipMemcpyHostToDevice) != hipSuccess) {
+    if (hipMemcpy(dStatesIn, states, count * sizeof(int), hipMemcpyHostToDevice) != hipSuccess) {
         cleanup();
-        return true;
+        return std::nullopt;
     }
 
     const unsigned int threadsPerBlock = 64;
@@ -119,33 +122,54 @@ bool runHipEntropyMirror(const std::vector<std::uint64_t>& seeds, const std::vec
                        count);
     if (hipGetLastError() != hipSuccess) {
         cleanup();
-        return true;
+        return std::nullopt;
     }
     if (hipDeviceSynchronize() != hipSuccess) {
         cleanup();
-        return true;
+        return std::nullopt;
     }
 
     std::vector<std::uint64_t> seedsOut(count, 0);
     std::vector<int> statesOut(count, 0);
     if (hipMemcpy(seedsOut.data(), dSeedsOut, count * sizeof(std::uint64_t), hipMemcpyDeviceToHost) != hipSuccess) {
         cleanup();
-        return true;
+        return std::nullopt;
     }
     if (hipMemcpy(statesOut.data(), dStatesOut, count * sizeof(int), hipMemcpyDeviceToHost) != hipSuccess) {
         cleanup();
-        return true;
+        return std::nullopt;
     }
 
     cleanup();
 
-    return std::equal(seeds.begin(), seeds.end(), seedsOut.begin()) &&
-           std::equal(states.begin(), states.end(), statesOut.begin());
+    return detail::mirrorMatches(seeds, seedsOut.data(), states, statesOut.data(), count, 0);
+}
+#endif
+
+} // namespace
+
+namespace detail {
+
+std::unique_ptr<EntropyBackend> makeHipEntropyBackend() {
+#if CLAMP_HAS_HIP
+    int deviceCount = 0;
+    if (hipGetDeviceCount(&deviceCount) != hipSuccess || deviceCount == 0) {
+        return nullptr;
+    }
+    int activeDevice = 0;
+    if (hipGetDevice(&activeDevice) != hipSuccess) {
+        activeDevice = 0;
+    }
+    hipDeviceProp_t props{};
+    if (hipGetDeviceProperties(&props, activeDevice) != hipSuccess) {
+        return std::make_unique<HipEntropyBackend>(activeDevice, "hip-device", 1);
+    }
+    return std::make_unique<HipEntropyBackend>(activeDevice, std::string(props.name), props.multiProcessorCount);
 #else
-    (void)seeds;
-    (void)states;
-    return true;
+    return nullptr;
 #endif
 }
 
+} // namespace detail
+
 } // namespace clamp
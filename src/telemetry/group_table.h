@@ -0,0 +1,100 @@
+#pragma once
+
+#include "partial_stats.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace clamp::detail {
+
+// Open-addressing hash table from encoded group key to PartialStats. Slots only
+// hold the cached hash and an index into a dense entry array, so probing stays
+// within a small contiguous array and growing never re-hashes key strings.
+// Entries keep first-insertion order, which keeps merges deterministic.
+class GroupTable {
+public:
+    using Entry = std::pair<std::string, PartialStats>;
+
+    // Fields are joined with a unit separator, which cannot appear unescaped
+    // inside a JSON string.
+    static constexpr char kKeySeparator = '\x1f';
+
+    explicit GroupTable(std::size_t expectedGroups = 0) { rehash(capacityFor(expectedGroups)); }
+
+    PartialStats& at(std::string_view key) {
+        const std::uint64_t hash = std::hash<std::string_view>{}(key);
+        std::size_t slot = static_cast<std::size_t>(hash) & mask_;
+        for (;;) {
+            Slot& candidate = slots_[slot];
+            if (candidate.index == kEmpty) {
+                break;
+            }
+            if (candidate.hash == hash && entries_[candidate.index].first == key) {
+                return entries_[candidate.index].second;
+            }
+            slot = (slot + 1) & mask_;
+        }
+        // Keep the load factor at or below 1/2 so probe sequences stay short
+        // even with many thousands of groups.
+        if ((entries_.size() + 1) * 2 > slots_.size()) {
+            rehash(slots_.size() * 2);
+            return at(key);
+        }
+        slots_[slot] = Slot{hash, static_cast<std::uint32_t>(entries_.size())};
+        entries_.emplace_back(std::string(key), PartialStats{});
+        return entries_.back().second;
+    }
+
+    std::size_t size() const { return entries_.size(); }
+    const std::vector<Entry>& entries() const { return entries_; }
+    std::vector<Entry> release() {
+        auto released = std::move(entries_);
+        entries_.clear();
+        slots_.assign(capacityFor(0), Slot{});
+        mask_ = slots_.size() - 1;
+        return released;
+    }
+
+private:
+    static constexpr std::uint32_t kEmpty = UINT32_MAX;
+
+    struct Slot {
+        std::uint64_t hash{0};
+        std::uint32_t index{kEmpty};
+    };
+
+    static std::size_t capacityFor(std::size_t groups) {
+        std::size_t capacity = 16;
+        while (capacity < groups * 2) {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    void rehash(std::size_t capacity) {
+        std::vector<Slot> previous(capacity, Slot{});
+        previous.swap(slots_);
+        mask_ = capacity - 1;
+        for (const Slot& occupied : previous) {
+            if (occupied.index == kEmpty) {
+                continue;
+            }
+            std::size_t slot = static_cast<std::size_t>(occupied.hash) & mask_;
+            while (slots_[slot].index != kEmpty) {
+                slot = (slot + 1) & mask_;
+            }
+            slots_[slot] = occupied;
+        }
+    }
+
+    std::vector<Slot> slots_;
+    std::vector<Entry> entries_;
+    std::size_t mask_{0};
+};
+
+} // namespace clamp::detail
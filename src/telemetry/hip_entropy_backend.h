@@ -0,0 +1,13 @@
+#pragma once
+
+#include "clamp/EntropyBackend.h"
+
+#include <memory>
+
+namespace clamp::detail {
+
+// The HIP backend bound to the current device; nullptr when HIP is not
+// compiled in or no device is present.
+std::unique_ptr<EntropyBackend> makeHipEntropyBackend();
+
+} // namespace clamp::detail
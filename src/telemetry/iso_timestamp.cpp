@@ -0,0 +1,157 @@
+#include "iso_timestamp.h"
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+
+namespace clamp::detail {
+namespace {
+
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+constexpr std::int64_t kMsPerDay = 86'400'000;
+
+// Howard Hinnant's days_from_civil: days since 1970-01-01 for a proleptic
+// Gregorian date.
+std::int64_t daysFromCivil(std::int64_t year, unsigned month, unsigned day) {
+    year -= month <= 2 ? 1 : 0;
+    const std::int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const auto yearOfEra = static_cast<unsigned>(year - era * 400);
+    const unsigned dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + static_cast<std::int64_t>(dayOfEra) - 719468;
+}
+
+unsigned daysInMonth(std::int64_t year, unsigned month) {
+    static constexpr unsigned kDays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month == 2 && year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)) {
+        return 29;
+    }
+    return kDays[month - 1];
+}
+
+bool readDigits(const char* p, int count, unsigned& value) {
+    value = 0;
+    for (int i = 0; i < count; ++i) {
+        const unsigned digit = static_cast<unsigned>(p[i] - '0');
+        if (digit > 9) {
+            return false;
+        }
+        value = value * 10 + digit;
+    }
+    return true;
+}
+
+// Telemetry files carry thousands of records per day, so the date part of
+// consecutive timestamps almost always repeats.
+struct DayCache {
+    std::uint32_t dateKey{0};
+    std::int64_t epochDays{0};
+};
+
+bool parseFixedFormat(std::string_view value, double& result) {
+    // YYYY-MM-DDTHH:MM:SS
+    constexpr std::size_t kBaseLength = 19;
+    if (value.size() < kBaseLength) {
+        return false;
+    }
+    const char* p = value.data();
+    if (p[4] != '-' || p[7] != '-' || (p[10] != 'T' && p[10] != 't') || p[13] != ':' || p[16] != ':') {
+        return false;
+    }
+    unsigned year = 0;
+    unsigned month = 0;
+    unsigned day = 0;
+    unsigned hour = 0;
+    unsigned minute = 0;
+    unsigned second = 0;
+    if (!readDigits(p, 4, year) || !readDigits(p + 5, 2, month) || !readDigits(p + 8, 2, day) ||
+        !readDigits(p + 11, 2, hour) || !readDigits(p + 14, 2, minute) || !readDigits(p + 17, 2, second)) {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month) || hour > 23 || minute > 59 ||
+        second > 59) {
+        return false;
+    }
+
+    std::size_t pos = kBaseLength;
+    unsigned millis = 0;
+    if (pos < value.size() && value[pos] == '.') {
+        ++pos;
+        unsigned scale = 100;
+        const std::size_t fractionBegin = pos;
+        while (pos < value.size() && value[pos] >= '0' && value[pos] <= '9' && pos - fractionBegin < 3) {
+            millis += static_cast<unsigned>(value[pos] - '0') * scale;
+            scale /= 10;
+            ++pos;
+        }
+        if (pos == fractionBegin) {
+            return false;
+        }
+    }
+    if (pos < value.size() && value[pos] == 'Z') {
+        ++pos;
+    }
+    if (pos != value.size()) {
+        return false;
+    }
+
+    thread_local DayCache cache;
+    const std::uint32_t dateKey = year * 10000 + month * 100 + day;
+    if (cache.dateKey != dateKey) {
+        cache.dateKey = dateKey;
+        cache.epochDays = daysFromCivil(year, month, day);
+    }
+    const std::int64_t dayMs = (static_cast<std::int64_t>(hour) * 3600 + minute * 60 + second) * 1000 + millis;
+    result = static_cast<double>(cache.epochDays * kMsPerDay + dayMs);
+    return true;
+}
+
+} // namespace
+
+double parseIsoTimestampMs(std::string_view value) {
+    double result = 0.0;
+    if (parseFixedFormat(value, result)) {
+        return result;
+    }
+    return parseIsoTimestampMsLocale(value);
+}
+
+double parseIsoTimestampMsLocale(std::string_view value) {
+#if defined(__cpp_lib_chrono) && __cpp_lib_chrono >= 201907L
+    using namespace std::chrono;
+    std::istringstream stream{std::string(value)};
+    sys_time<milliseconds> tp{};
+    stream >> std::chrono::parse("%FT%TZ", tp);
+    if (!stream.fail()) {
+        return static_cast<double>(tp.time_since_epoch().count());
+    }
+    stream.clear();
+    stream.str(std::string(value));
+    stream >> std::chrono::parse("%FT%T", tp);
+    if (!stream.fail()) {
+        return static_cast<double>(tp.time_since_epoch().count());
+    }
+    return kNaN;
+#else
+    // Standard libraries without std::chrono::parse: read the same fields
+    // with std::get_time and convert without consulting the local time zone.
+    std::istringstream stream{std::string(value)};
+    std::tm parsed{};
+    stream >> std::get_time(&parsed, "%Y-%m-%dT%H:%M:%S");
+    if (stream.fail()) {
+        return kNaN;
+    }
+    const std::int64_t days = daysFromCivil(static_cast<std::int64_t>(parsed.tm_year) + 1900,
+                                            static_cast<unsigned>(parsed.tm_mon + 1),
+                                            static_cast<unsigned>(parsed.tm_mday));
+    const std::int64_t seconds =
+        static_cast<std::int64_t>(parsed.tm_hour) * 3600 + parsed.tm_min * 60 + parsed.tm_sec;
+    return static_cast<double>(days * kMsPerDay + seconds * 1000);
+#endif
+}
+
+} // namespace clamp::detail
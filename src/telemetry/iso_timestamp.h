@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string_view>
+
+namespace clamp::detail {
+
+// Milliseconds since the Unix epoch for an ISO-8601 UTC timestamp, or NaN.
+// The fixed `YYYY-MM-DDTHH:MM:SS[.fff][Z]` layout written by EntropyTelemetry
+// is decoded by hand; anything else goes through parseIsoTimestampMsLocale.
+double parseIsoTimestampMs(std::string_view value);
+
+// The stream-based parser used before the fixed-format fast path.
+double parseIsoTimestampMsLocale(std::string_view value);
+
+} // namespace clamp::detail
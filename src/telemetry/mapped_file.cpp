@@ -0,0 +1,144 @@
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <utility>
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace clamp::detail {
+
+namespace {
+
+#if !defined(_WIN32)
+bool readAll(int fd, std::string& buffer, std::size_t size) {
+    buffer.resize(size);
+    std::size_t offset = 0;
+    while (offset < size) {
+        const ssize_t got = ::read(fd, buffer.data() + offset, size - offset);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            buffer.resize(offset);
+            return got == 0;
+        }
+        offset += static_cast<std::size_t>(got);
+    }
+    return true;
+}
+#endif
+
+} // namespace
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : mapping_(std::exchange(other.mapping_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      buffer_(std::move(other.buffer_)),
+      open_(std::exchange(other.open_, false)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        mapping_ = std::exchange(other.mapping_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        buffer_ = std::move(other.buffer_);
+        open_ = std::exchange(other.open_, false);
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::filesystem::path& path) {
+    close();
+#if defined(_WIN32)
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) {
+        return false;
+    }
+    buffer_.resize(static_cast<std::size_t>(in.tellg()));
+    in.seekg(0);
+    if (!in.read(buffer_.data(), static_cast<std::streamsize>(buffer_.size()))) {
+        buffer_.clear();
+        return false;
+    }
+    open_ = true;
+    return true;
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    const auto size = static_cast<std::size_t>(info.st_size);
+    if (size >= kMapThreshold) {
+        void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            ::madvise(mapping, size, MADV_SEQUENTIAL);
+            ::close(fd);
+            mapping_ = mapping;
+            size_ = size;
+            open_ = true;
+            return true;
+        }
+    }
+    // Small files, and anything mmap refuses (pipes, some FUSE mounts), are read.
+    const bool ok = readAll(fd, buffer_, size);
+    ::close(fd);
+    open_ = ok;
+    if (!ok) {
+        buffer_.clear();
+    }
+    return ok;
+#endif
+}
+
+void MappedFile::close() {
+#if !defined(_WIN32)
+    if (mapping_ != nullptr) {
+        ::munmap(mapping_, size_);
+    }
+#endif
+    mapping_ = nullptr;
+    size_ = 0;
+    buffer_.clear();
+    open_ = false;
+}
+
+void MappedFile::release(std::size_t offset) {
+#if !defined(_WIN32)
+    if (mapping_ == nullptr) {
+        return;
+    }
+    static const auto pageSize = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const std::size_t length = std::min(offset, size_) / pageSize * pageSize;
+    if (length > 0) {
+        ::madvise(mapping_, length, MADV_DONTNEED);
+    }
+#else
+    (void)offset;
+#endif
+}
+
+std::string_view MappedFile::view() const {
+    if (mapping_ != nullptr) {
+        return {static_cast<const char*>(mapping_), size_};
+    }
+    return buffer_;
+}
+
+} // namespace clamp::detail
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace clamp::detail {
+
+// Read-only view of a file's contents. Files of at least kMapThreshold bytes
+// are mmap'ed with MADV_SEQUENTIAL; smaller ones are read into an owned buffer
+// because a mapping costs more than copying a few pages.
+class MappedFile {
+public:
+    static constexpr std::size_t kMapThreshold = 64 * 1024;
+
+    MappedFile() = default;
+    explicit MappedFile(const std::filesystem::path& path) { open(path); }
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool open(const std::filesystem::path& path);
+    void close();
+
+    // Tells the kernel the mapped bytes before `offset` will not be read again
+    // so their pages can be dropped; a no-op for buffered files.
+    void release(std::size_t offset);
+
+    bool isOpen() const { return open_; }
+    bool isMapped() const { return mapping_ != nullptr; }
+    std::string_view view() const;
+
+private:
+    void* mapping_{nullptr};
+    std::size_t size_{0};
+    std::string buffer_;
+    bool open_{false};
+};
+
+} // namespace clamp::detail
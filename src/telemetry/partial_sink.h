@@ -0,0 +1,90 @@
+#pragma once
+
+#include "clamp/TemporalAggregator.h"
+
+#include "aggregate_partial.h"
+#include "group_table.h"
+#include "telemetry_scanner.h"
+#include "time_buckets.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace clamp::detail {
+
+// What a sink extracts from each record, derived from the aggregator options.
+// The filter is applied by the scanner and, unlike the other fields, is not
+// part of the cache layout: filtered partials are never cached.
+struct SinkConfig {
+    unsigned fields{0};
+    std::int64_t bucketWidthMs{0};
+    std::size_t maxBuckets{0};
+    const RecordFilter* filter{nullptr};
+};
+
+inline SinkConfig sinkConfig(const TemporalAggregator::Options& options) {
+    const auto& groupBy = options.groupBy;
+    const unsigned fields = (groupBy.context ? TelemetryScanner::kFieldContext : 0u) |
+                            (groupBy.backend ? TelemetryScanner::kFieldBackend : 0u) |
+                            (groupBy.deviceName ? TelemetryScanner::kFieldDeviceName : 0u) |
+                            (groupBy.threadId ? TelemetryScanner::kFieldThreadId : 0u);
+    return {fields, static_cast<std::int64_t>(options.bucketWidth.count()), options.maxBuckets, nullptr};
+}
+
+// Accumulates scanned records into a FilePartial, its time buckets and, when
+// grouping, a GroupTable.
+class PartialSink final : public RecordSink {
+public:
+    PartialSink(FilePartial& partial, const SinkConfig& config)
+        : partial_(partial), grouped_(config.fields != 0) {
+        if (config.bucketWidthMs > 0) {
+            partial_.timeline = TimeBuckets(config.bucketWidthMs, config.maxBuckets);
+        }
+    }
+
+    // Compresses the sketches and moves the per-group statistics into the partial.
+    void finish() {
+        partial_.compress();
+        partial_.timeline.compress();
+        if (grouped_) {
+            partial_.groups = groups_.release();
+            for (auto& group : partial_.groups) {
+                group.second.compress();
+            }
+        }
+    }
+
+    // Groups accumulated so far, for sinks that are never finished.
+    const GroupTable& groups() const { return groups_; }
+
+    void onRecord(const ParsedRecord& record) override {
+        partial_.add(record.stabilityScore, record.timestampMs, record.durationMs);
+        if (partial_.timeline.enabled() && record.hasTimestamp) {
+            partial_.timeline.add(record.timestampMs, record.stabilityScore, record.durationMs);
+        }
+        if (grouped_) {
+            // Unselected fields are empty, so the key always has four parts.
+            key_.clear();
+            key_.append(record.context).push_back(GroupTable::kKeySeparator);
+            key_.append(record.backend).push_back(GroupTable::kKeySeparator);
+            key_.append(record.deviceName).push_back(GroupTable::kKeySeparator);
+            key_.append(record.threadId);
+            groups_.at(key_).add(record.stabilityScore, record.timestampMs, record.durationMs);
+        }
+    }
+
+private:
+    FilePartial& partial_;
+    bool grouped_;
+    GroupTable groups_;
+    std::string key_;
+};
+
+// Turns merged statistics into the public summary; defined with the aggregator.
+TemporalAggregator::Summary buildSummary(const PartialStats& total,
+                                         const std::vector<GroupTable::Entry>& groups,
+                                         const TimeBuckets& timeline);
+
+} // namespace clamp::detail
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "quantile_sketch.h"
+#include "running_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace clamp::detail {
+
+// Mergeable statistics for one set of records: a file, a group or a time bucket.
+struct PartialStats {
+    void add(double stabilityScore, double timestampMs, double durationMs) {
+        if (std::isfinite(stabilityScore)) {
+            stability.add(stabilityScore);
+            stabilitySketch.add(stabilityScore);
+        }
+        if (std::isfinite(durationMs)) {
+            duration.add(durationMs);
+            durationSketch.add(durationMs);
+        }
+        if (std::isfinite(timestampMs)) {
+            minTimestamp = std::min(minTimestamp, timestampMs);
+            maxTimestamp = std::max(maxTimestamp, timestampMs);
+        }
+    }
+
+    void merge(const PartialStats& other) {
+        stability.merge(other.stability);
+        duration.merge(other.duration);
+        stabilitySketch.merge(other.stabilitySketch);
+        durationSketch.merge(other.durationSketch);
+        minTimestamp = std::min(minTimestamp, other.minTimestamp);
+        maxTimestamp = std::max(maxTimestamp, other.maxTimestamp);
+    }
+
+    // Folds buffered sketch samples so the partial is compact to store.
+    void compress() {
+        stabilitySketch.compress();
+        durationSketch.compress();
+    }
+
+    RunningStats stability;
+    RunningStats duration;
+    TDigest stabilitySketch;
+    TDigest durationSketch;
+    double minTimestamp{std::numeric_limits<double>::infinity()};
+    double maxTimestamp{-std::numeric_limits<double>::infinity()};
+};
+
+} // namespace clamp::detail
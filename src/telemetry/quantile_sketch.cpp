@@ -0,0 +1,167 @@
+#include "quantile_sketch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace clamp::detail {
+namespace {
+
+// k1 scale function: k(q) = compression / (2*pi) * asin(2q - 1). A centroid
+// may span at most one unit of k, which keeps centroids small near q = 0 and
+// q = 1. Advancing k by one is a fixed rotation a = 2*pi / compression of the
+// angle asin(2q - 1), so the next quantile limit follows from the angle-sum
+// identity with a single sqrt instead of asin/sin per centroid.
+class ScaleStep {
+public:
+    explicit ScaleStep(double compression)
+        : cosStep_(std::cos(2.0 * std::numbers::pi / compression)),
+          sinStep_(std::sin(2.0 * std::numbers::pi / compression)) {}
+
+    // Largest quantile a centroid starting at q may reach.
+    double next(double q) const {
+        const double x = std::clamp(2.0 * q - 1.0, -1.0, 1.0);
+        if (x >= cosStep_) {
+            return 1.0;
+        }
+        return (1.0 + x * cosStep_ + std::sqrt(1.0 - x * x) * sinStep_) / 2.0;
+    }
+
+private:
+    double cosStep_;
+    double sinStep_;
+};
+
+double interpolate(double x, double x0, double y0, double x1, double y1) {
+    if (x1 <= x0) {
+        return y0;
+    }
+    return y0 + (x - x0) / (x1 - x0) * (y1 - y0);
+}
+
+} // namespace
+
+void TDigest::add(double value, double weight) {
+    if (!std::isfinite(value) || weight <= 0.0) {
+        return;
+    }
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+    buffer_.push_back({value, weight});
+    bufferedWeight_ += weight;
+    if (buffer_.size() >= bufferLimit()) {
+        compress();
+    }
+}
+
+void TDigest::merge(const TDigest& other) {
+    if (other.empty()) {
+        return;
+    }
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+    buffer_.insert(buffer_.end(), other.buffer_.begin(), other.buffer_.end());
+    bufferedWeight_ += other.bufferedWeight_;
+    if (other.centroids_.empty()) {
+        if (buffer_.size() >= bufferLimit()) {
+            compress();
+        }
+        return;
+    }
+    fold(other.centroids_, other.totalWeight_);
+}
+
+void TDigest::compress() {
+    if (!buffer_.empty()) {
+        fold({}, 0.0);
+    }
+}
+
+void TDigest::fold(const std::vector<Centroid>& sortedExtra, double extraWeight) {
+    // Only the raw buffer needs sorting; existing and incoming centroids are
+    // already ordered and are merged linearly.
+    auto byMean = [](const Centroid& lhs, const Centroid& rhs) {
+        return lhs.mean < rhs.mean;
+    };
+    std::sort(buffer_.begin(), buffer_.end(), byMean);
+    std::vector<Centroid> merged(centroids_.size() + buffer_.size() + sortedExtra.size());
+    const auto middle =
+        std::merge(centroids_.begin(), centroids_.end(), buffer_.begin(), buffer_.end(), merged.begin(), byMean);
+    if (!sortedExtra.empty()) {
+        std::copy(sortedExtra.begin(), sortedExtra.end(), middle);
+        std::inplace_merge(merged.begin(), middle, merged.end(), byMean);
+    }
+    const double total = totalWeight_ + bufferedWeight_ + extraWeight;
+
+    // Greedily combine neighbours in place while the combined centroid stays
+    // within one unit of the scale function.
+    const ScaleStep step(compression_);
+    std::size_t out = 0;
+    double weightSoFar = 0.0;
+    double weightLimit = total * step.next(0.0);
+    // Accumulate weight * mean so each combined centroid needs one division.
+    double sum = merged.front().mean * merged.front().weight;
+    double weight = merged.front().weight;
+    for (std::size_t i = 1; i < merged.size(); ++i) {
+        const Centroid next = merged[i];
+        if (weightSoFar + weight + next.weight <= weightLimit) {
+            sum += next.mean * next.weight;
+            weight += next.weight;
+        } else {
+            merged[out++] = Centroid{sum / weight, weight};
+            weightSoFar += weight;
+            weightLimit = total * step.next(weightSoFar / total);
+            sum = next.mean * next.weight;
+            weight = next.weight;
+        }
+    }
+    merged[out++] = Centroid{sum / weight, weight};
+    merged.resize(out);
+
+    centroids_ = std::move(merged);
+    buffer_.clear();
+    totalWeight_ = total;
+    bufferedWeight_ = 0.0;
+}
+
+double TDigest::quantile(double q) const {
+    if (!buffer_.empty()) {
+        TDigest compressed = *this;
+        compressed.compress();
+        return compressed.quantile(q);
+    }
+    if (centroids_.empty()) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    q = std::clamp(q, 0.0, 1.0);
+    const double target = q * totalWeight_;
+
+    // Each centroid's mass is centred on its mean; interpolate between centres
+    // and towards the exact min/max at either end.
+    double cumulative = 0.0;
+    double previousCentre = 0.0;
+    double previousMean = min_;
+    for (const auto& centroid : centroids_) {
+        const double centre = cumulative + centroid.weight / 2.0;
+        if (target < centre) {
+            return interpolate(target, previousCentre, previousMean, centre, centroid.mean);
+        }
+        cumulative += centroid.weight;
+        previousCentre = centre;
+        previousMean = centroid.mean;
+    }
+    return interpolate(target, previousCentre, previousMean, totalWeight_, max_);
+}
+
+TDigest TDigest::fromCentroids(std::vector<Centroid> centroids, double min, double max, double compression) {
+    TDigest digest(compression);
+    digest.centroids_ = std::move(centroids);
+    for (const auto& centroid : digest.centroids_) {
+        digest.totalWeight_ += centroid.weight;
+    }
+    digest.min_ = min;
+    digest.max_ = max;
+    return digest;
+}
+
+} // namespace clamp::detail
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace clamp::detail {
+
+// Merging t-digest (Dunning & Ertl) with the arcsine scale function. Memory is
+// bounded by the compression parameter rather than the number of samples:
+// incoming values are buffered and folded into at most ~compression centroids,
+// with finer resolution near the tails where p99/p999 live. Digests merge by
+// pooling centroids, so per-file sketches combine without the raw records.
+class TDigest {
+public:
+    struct Centroid {
+        double mean{0.0};
+        double weight{0.0};
+    };
+
+    static constexpr double kDefaultCompression = 100.0;
+
+    TDigest() = default;
+    explicit TDigest(double compression)
+        : compression_(compression) {}
+
+    void add(double value, double weight = 1.0);
+    void merge(const TDigest& other);
+
+    // Folds buffered samples into the centroid list.
+    void compress();
+
+    // Estimated value at quantile q in [0, 1]; NaN when empty.
+    double quantile(double q) const;
+
+    double totalWeight() const { return totalWeight_ + bufferedWeight_; }
+    bool empty() const { return totalWeight() == 0.0; }
+    double min() const { return min_; }
+    double max() const { return max_; }
+    double compression() const { return compression_; }
+
+    // Centroids in ascending order of mean; call compress() first to include
+    // buffered samples.
+    const std::vector<Centroid>& centroids() const { return centroids_; }
+
+    // Rebuilds a digest from serialised state (see centroids(), min(), max()).
+    static TDigest fromCentroids(std::vector<Centroid> centroids, double min, double max,
+                                 double compression = kDefaultCompression);
+
+private:
+    // Merges the sorted buffer, the current centroids and `sortedExtra` (with
+    // total weight `extraWeight`) and recompresses.
+    void fold(const std::vector<Centroid>& sortedExtra, double extraWeight);
+
+    std::size_t bufferLimit() const { return static_cast<std::size_t>(compression_) * 5; }
+
+    double compression_{kDefaultCompression};
+    std::vector<Centroid> centroids_;
+    std::vector<Centroid> buffer_;
+    double totalWeight_{0.0};
+    double bufferedWeight_{0.0};
+    double min_{std::numeric_limits<double>::infinity()};
+    double max_{-std::numeric_limits<double>::infinity()};
+};
+
+} // namespace clamp::detail
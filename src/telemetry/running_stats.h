@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+
+namespace clamp::detail {
+
+// Welford accumulator. merge() applies the Chan et al. pairwise update, so
+// partial statistics gathered on different threads or files can be combined
+// without revisiting the samples. remove() reverses add() for sliding windows;
+// rounding error accumulates over many removals, so long-lived windows should
+// occasionally rebuild from their samples.
+struct RunningStats {
+    void add(double value) {
+        ++count;
+        const double delta = value - mean;
+        mean += delta / static_cast<double>(count);
+        const double delta2 = value - mean;
+        m2 += delta * delta2;
+    }
+
+    // `value` must have been added before.
+    void remove(double value) {
+        if (count <= 1) {
+            *this = RunningStats{};
+            return;
+        }
+        --count;
+        const double delta = value - mean;
+        mean -= delta / static_cast<double>(count);
+        m2 -= delta * (value - mean);
+        if (m2 < 0.0) {
+            m2 = 0.0;
+        }
+    }
+
+    void merge(const RunningStats& other) {
+        if (other.count == 0) {
+            return;
+        }
+        if (count == 0) {
+            *this = other;
+            return;
+        }
+        const double lhsCount = static_cast<double>(count);
+        const double rhsCount = static_cast<double>(other.count);
+        const double total = lhsCount + rhsCount;
+        const double delta = other.mean - mean;
+        mean += delta * (rhsCount / total);
+        m2 += other.m2 + delta * delta * (lhsCount * rhsCount / total);
+        count += other.count;
+    }
+
+    double variance() const {
+        if (count < 2) {
+            return 0.0;
+        }
+        return m2 / static_cast<double>(count - 1);
+    }
+
+    double mean{0.0};
+    double m2{0.0};
+    std::size_t count{0};
+};
+
+} // namespace clamp::detail
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace clamp::detail {
+
+// Minimal readers for the flat documents written by
+// TemporalAggregator::writeSummary; `from` restricts the search to the text
+// that starts there. Strings are returned as they appear (JSON-escaped).
+
+// Offset just past the colon following "key", or npos.
+inline std::size_t findSummaryKey(std::string_view json, std::string_view key, std::size_t from = 0) {
+    if (from == std::string_view::npos) {
+        return std::string_view::npos;
+    }
+    std::string quoted;
+    quoted.reserve(key.size() + 2);
+    quoted.append("\"").append(key).append("\"");
+    const auto pos = json.find(quoted, from);
+    if (pos == std::string_view::npos) {
+        return pos;
+    }
+    const auto colon = json.find(':', pos + quoted.size());
+    return colon == std::string_view::npos ? colon : colon + 1;
+}
+
+inline double readSummaryNumber(std::string_view json, std::string_view key, std::size_t from = 0) {
+    auto pos = findSummaryKey(json, key, from);
+    if (pos == std::string_view::npos) {
+        return 0.0;
+    }
+    while (pos < json.size() && json[pos] == ' ') {
+        ++pos;
+    }
+    double value = 0.0;
+    std::from_chars(json.data() + pos, json.data() + json.size(), value);
+    return value;
+}
+
+inline std::string readSummaryString(std::string_view json, std::string_view key, std::size_t from = 0) {
+    const auto pos = findSummaryKey(json, key, from);
+    if (pos == std::string_view::npos) {
+        return {};
+    }
+    const auto open = json.find('"', pos);
+    if (open == std::string_view::npos) {
+        return {};
+    }
+    auto close = open + 1;
+    while (close < json.size() && json[close] != '"') {
+        close += json[close] == '\\' ? 2 : 1;
+    }
+    if (close >= json.size()) {
+        return {};
+    }
+    return std::string(json.substr(open + 1, close - open - 1));
+}
+
+} // namespace clamp::detail
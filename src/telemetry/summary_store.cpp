@@ -0,0 +1,442 @@
+#include "clamp/SummaryStore.h"
+
+#include "aggregate_cache.h"
+#include "iso_timestamp.h"
+#include "mapped_file.h"
+#include "summary_json.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <system_error>
+#include <type_traits>
+
+namespace clamp {
+namespace {
+
+constexpr std::array<char, 8> kRowsMagic{'C', 'L', 'S', 'U', 'M', 'R', 'O', 'W'};
+constexpr std::array<char, 8> kIndexMagic{'C', 'L', 'S', 'U', 'M', 'I', 'D', 'X'};
+constexpr std::uint32_t kStoreVersion = 1;
+
+// On-disk row. Every field has a fixed width so row i lives at a computable
+// offset and appending never rewrites earlier data.
+struct StoredRow {
+    std::int64_t timestampMs;
+    std::uint64_t sessionCount;
+    double meanStability;
+    double stabilityVariance;
+    double driftIndex;
+    double stabilityP50;
+    double stabilityP99;
+    double durationP50;
+    double durationP99;
+    char digest[SummaryStore::kMaxDigestLength + 1];
+};
+
+static_assert(std::is_trivially_copyable_v<StoredRow>);
+static_assert(sizeof(StoredRow) == 152);
+
+struct RowsHeader {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t rowSize;
+};
+
+struct IndexHeader {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t reserved;
+    std::uint64_t indexedRows;
+};
+
+std::filesystem::path rowsPath(const std::filesystem::path& directory) {
+    return directory / "summaries.rows";
+}
+
+std::filesystem::path indexPath(const std::filesystem::path& directory) {
+    return directory / "summaries.idx";
+}
+
+// FNV-1a: the index is persisted, so the hash must not vary between builds.
+std::uint64_t hashDigest(std::string_view digest) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (const char ch : digest) {
+        hash ^= static_cast<unsigned char>(ch);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Row::digest holds the plain value: summaries keep strings JSON-escaped, so
+// the common escapes are undone on the way in and redone by toJson().
+std::string unescapeJson(std::string_view value) {
+    std::string plain;
+    plain.reserve(value.size());
+    for (std::size_t i = 0; i < value.size(); ++i) {
+        if (value[i] != '\\' || i + 1 == value.size()) {
+            plain += value[i];
+            continue;
+        }
+        const char ch = value[++i];
+        plain += ch == 'n' ? '\n' : ch == 't' ? '\t' : ch;
+    }
+    return plain;
+}
+
+std::string escapeJson(std::string_view value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (const char ch : value) {
+        switch (ch) {
+        case '"':
+            escaped += "\\\"";
+            break;
+        case '\\':
+            escaped += "\\\\";
+            break;
+        case '\n':
+            escaped += "\\n";
+            break;
+        case '\t':
+            escaped += "\\t";
+            break;
+        default:
+            escaped += ch;
+        }
+    }
+    return escaped;
+}
+
+std::string_view storedDigest(const StoredRow& row) {
+    const char* end = std::find(row.digest, row.digest + sizeof(row.digest), '\0');
+    return std::string_view(row.digest, static_cast<std::size_t>(end - row.digest));
+}
+
+} // namespace
+
+bool SummaryStore::open(const std::filesystem::path& directory) {
+    directory_ = directory;
+    rows_.clear();
+    byTime_.clear();
+    byDigest_.clear();
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+    const auto path = rowsPath(directory_);
+    if (!std::filesystem::exists(path)) {
+        std::ofstream out(path, std::ios::binary);
+        const RowsHeader header{kRowsMagic, kStoreVersion, static_cast<std::uint32_t>(sizeof(StoredRow))};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        return out.good();
+    }
+
+    const detail::MappedFile file(path);
+    if (!file.isOpen() || file.view().size() < sizeof(RowsHeader)) {
+        return false;
+    }
+    const std::string_view contents = file.view();
+    RowsHeader header{};
+    std::memcpy(&header, contents.data(), sizeof(header));
+    if (header.magic != kRowsMagic || header.version != kStoreVersion || header.rowSize != sizeof(StoredRow)) {
+        return false;
+    }
+    // A torn trailing row from an interrupted append is cut off, so the next
+    // append() lands on a row boundary.
+    const std::size_t rowBytes = (contents.size() - sizeof(RowsHeader)) / sizeof(StoredRow) * sizeof(StoredRow);
+    rows_.assign(contents.data() + sizeof(RowsHeader), rowBytes);
+    if (sizeof(RowsHeader) + rowBytes != contents.size()) {
+        std::filesystem::resize_file(path, sizeof(RowsHeader) + rowBytes, ec);
+        if (ec) {
+            return false;
+        }
+    }
+    const auto rowCount = static_cast<std::uint32_t>(size());
+
+    std::uint32_t indexed = 0;
+    const detail::MappedFile index(indexPath(directory_));
+    if (index.isOpen() && index.view().size() >= sizeof(IndexHeader)) {
+        const std::string_view data = index.view();
+        IndexHeader indexHeader{};
+        std::memcpy(&indexHeader, data.data(), sizeof(indexHeader));
+        const std::size_t expected = sizeof(IndexHeader) +
+                                     indexHeader.indexedRows * (sizeof(TimeEntry) + sizeof(DigestEntry));
+        if (indexHeader.magic == kIndexMagic && indexHeader.version == kStoreVersion &&
+            indexHeader.indexedRows <= rowCount && data.size() == expected) {
+            indexed = static_cast<std::uint32_t>(indexHeader.indexedRows);
+            byTime_.resize(indexed);
+            byDigest_.resize(indexed);
+            const char* cursor = data.data() + sizeof(IndexHeader);
+            std::memcpy(byTime_.data(), cursor, indexed * sizeof(TimeEntry));
+            cursor += indexed * sizeof(TimeEntry);
+            std::memcpy(byDigest_.data(), cursor, indexed * sizeof(DigestEntry));
+        }
+    }
+
+    if (indexed < rowCount) {
+        // Entries for equal keys stay in row order: indexed ones come first and
+        // stable_sort keeps the appended tail behind them.
+        for (std::uint32_t row = indexed; row < rowCount; ++row) {
+            byTime_.push_back(timeEntry(row));
+            byDigest_.push_back(digestEntry(row));
+        }
+        std::stable_sort(byTime_.begin(), byTime_.end(), [](const TimeEntry& lhs, const TimeEntry& rhs) {
+            return lhs.timestampMs < rhs.timestampMs;
+        });
+        std::stable_sort(byDigest_.begin(), byDigest_.end(), [](const DigestEntry& lhs, const DigestEntry& rhs) {
+            return lhs.hash < rhs.hash;
+        });
+        saveIndex();
+    }
+    return true;
+}
+
+bool SummaryStore::append(const Row& row) {
+    if (directory_.empty()) {
+        return false;
+    }
+    StoredRow stored{};
+    stored.timestampMs = row.timestampMs;
+    stored.sessionCount = row.sessionCount;
+    stored.meanStability = row.meanStability;
+    stored.stabilityVariance = row.stabilityVariance;
+    stored.driftIndex = row.driftIndex;
+    stored.stabilityP50 = row.stabilityP50;
+    stored.stabilityP99 = row.stabilityP99;
+    stored.durationP50 = row.durationP50;
+    stored.durationP99 = row.durationP99;
+    std::memcpy(stored.digest, row.digest.data(), std::min(row.digest.size(), kMaxDigestLength));
+
+    std::ofstream out(rowsPath(directory_), std::ios::binary | std::ios::app);
+    if (!out.is_open()) {
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(&stored), sizeof(stored));
+    out.flush();
+    if (!out.good()) {
+        return false;
+    }
+    // The on-disk index catches up with appended rows on the next open().
+    rows_.append(reinterpret_cast<const char*>(&stored), sizeof(stored));
+    indexRow(static_cast<std::uint32_t>(size() - 1));
+    return true;
+}
+
+bool SummaryStore::append(const TemporalAggregator::Summary& summary,
+                          std::string_view digest,
+                          std::int64_t timestampMs) {
+    Row row;
+    row.timestampMs = timestampMs;
+    row.digest = std::string(digest);
+    row.sessionCount = summary.sessionCount;
+    row.meanStability = summary.meanStability;
+    row.stabilityVariance = summary.stabilityVariance;
+    row.driftIndex = summary.driftIndex;
+    row.stabilityP50 = summary.stabilityQuantiles.p50;
+    row.stabilityP99 = summary.stabilityQuantiles.p99;
+    row.durationP50 = summary.durationQuantiles.p50;
+    row.durationP99 = summary.durationQuantiles.p99;
+    return append(row);
+}
+
+bool SummaryStore::appendSummaryFile(const std::filesystem::path& summaryPath) {
+    const detail::MappedFile file(summaryPath);
+    if (!file.isOpen()) {
+        return false;
+    }
+    const std::string_view json = file.view();
+    if (detail::findSummaryKey(json, "session_count") == std::string_view::npos) {
+        return false;
+    }
+
+    Row row;
+    row.sessionCount = static_cast<std::size_t>(detail::readSummaryNumber(json, "session_count"));
+    row.meanStability = detail::readSummaryNumber(json, "mean_stability");
+    row.stabilityVariance = detail::readSummaryNumber(json, "stability_variance");
+    row.driftIndex = detail::readSummaryNumber(json, "drift_index");
+    // Top-level quantiles precede any per-group ones in writeSummary output.
+    const auto stabilityQuantiles = detail::findSummaryKey(json, "stability_quantiles");
+    if (stabilityQuantiles != std::string_view::npos) {
+        row.stabilityP50 = detail::readSummaryNumber(json, "p50", stabilityQuantiles);
+        row.stabilityP99 = detail::readSummaryNumber(json, "p99", stabilityQuantiles);
+    }
+    const auto durationQuantiles = detail::findSummaryKey(json, "duration_ms_quantiles");
+    if (durationQuantiles != std::string_view::npos) {
+        row.durationP50 = detail::readSummaryNumber(json, "p50", durationQuantiles);
+        row.durationP99 = detail::readSummaryNumber(json, "p99", durationQuantiles);
+    }
+
+    const auto buildInfo = detail::findSummaryKey(json, "build_info");
+    double resolvedAt = std::numeric_limits<double>::quiet_NaN();
+    if (buildInfo != std::string_view::npos) {
+        row.digest = unescapeJson(detail::readSummaryString(json, "digest", buildInfo));
+        resolvedAt = detail::parseIsoTimestampMs(detail::readSummaryString(json, "resolved_at", buildInfo));
+    }
+    if (std::isfinite(resolvedAt)) {
+        row.timestampMs = static_cast<std::int64_t>(resolvedAt);
+    } else {
+        detail::FileIdentity identity;
+        if (!detail::statFileIdentity(summaryPath, identity)) {
+            return false;
+        }
+        row.timestampMs = identity.mtimeNs / 1'000'000;
+    }
+    return append(row);
+}
+
+std::vector<SummaryStore::Row> SummaryStore::range(std::int64_t fromMs, std::int64_t toMs) const {
+    std::vector<Row> rows;
+    auto it = std::lower_bound(byTime_.begin(), byTime_.end(), fromMs, [](const TimeEntry& entry, std::int64_t value) {
+        return entry.timestampMs < value;
+    });
+    for (; it != byTime_.end() && it->timestampMs < toMs; ++it) {
+        rows.push_back(rowAt(it->row));
+    }
+    return rows;
+}
+
+std::vector<SummaryStore::Row> SummaryStore::latest(std::size_t count) const {
+    std::vector<Row> rows;
+    const std::size_t first = byTime_.size() > count ? byTime_.size() - count : 0;
+    rows.reserve(byTime_.size() - first);
+    for (std::size_t i = first; i < byTime_.size(); ++i) {
+        rows.push_back(rowAt(byTime_[i].row));
+    }
+    return rows;
+}
+
+std::vector<SummaryStore::Row> SummaryStore::findDigest(std::string_view digest) const {
+    digest = digest.substr(0, kMaxDigestLength);
+    const std::uint64_t hash = hashDigest(digest);
+    auto it = std::lower_bound(byDigest_.begin(), byDigest_.end(), hash, [](const DigestEntry& entry, std::uint64_t value) {
+        return entry.hash < value;
+    });
+    std::vector<Row> rows;
+    for (; it != byDigest_.end() && it->hash == hash; ++it) {
+        Row row = rowAt(it->row);
+        if (row.digest == digest) {
+            rows.push_back(std::move(row));
+        }
+    }
+    std::stable_sort(rows.begin(), rows.end(), [](const Row& lhs, const Row& rhs) {
+        return lhs.timestampMs < rhs.timestampMs;
+    });
+    return rows;
+}
+
+std::size_t SummaryStore::size() const {
+    return rows_.size() / sizeof(StoredRow);
+}
+
+std::string SummaryStore::toJson(const std::vector<Row>& rows) {
+    std::ostringstream out;
+    out << std::setprecision(9);
+    out << "{\"rows\":[";
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+        const Row& row = rows[i];
+        out << (i == 0 ? "" : ",") << "{";
+        out << "\"timestamp_ms\":" << row.timestampMs << ",";
+        out << "\"digest\":\"" << escapeJson(row.digest) << "\",";
+        out << "\"session_count\":" << row.sessionCount << ",";
+        out << "\"mean_stability\":" << row.meanStability << ",";
+        out << "\"stability_variance\":" << row.stabilityVariance << ",";
+        out << "\"drift_index\":" << row.driftIndex << ",";
+        out << "\"stability_p50\":" << row.stabilityP50 << ",";
+        out << "\"stability_p99\":" << row.stabilityP99 << ",";
+        out << "\"duration_p50\":" << row.durationP50 << ",";
+        out << "\"duration_p99\":" << row.durationP99;
+        out << "}";
+    }
+    out << "]}";
+    return out.str();
+}
+
+bool SummaryStore::exportJson(const std::vector<Row>& rows, const std::filesystem::path& outputPath) {
+    std::ofstream out(outputPath);
+    if (!out.is_open()) {
+        return false;
+    }
+    out << toJson(rows) << '\n';
+    return out.good();
+}
+
+SummaryStore::Row SummaryStore::rowAt(std::uint32_t index) const {
+    StoredRow stored{};
+    std::memcpy(&stored, rows_.data() + static_cast<std::size_t>(index) * sizeof(StoredRow), sizeof(stored));
+    Row row;
+    row.timestampMs = stored.timestampMs;
+    row.digest = std::string(storedDigest(stored));
+    row.sessionCount = static_cast<std::size_t>(stored.sessionCount);
+    row.meanStability = stored.meanStability;
+    row.stabilityVariance = stored.stabilityVariance;
+    row.driftIndex = stored.driftIndex;
+    row.stabilityP50 = stored.stabilityP50;
+    row.stabilityP99 = stored.stabilityP99;
+    row.durationP50 = stored.durationP50;
+    row.durationP99 = stored.durationP99;
+    return row;
+}
+
+SummaryStore::TimeEntry SummaryStore::timeEntry(std::uint32_t index) const {
+    std::int64_t timestampMs = 0;
+    std::memcpy(&timestampMs,
+                rows_.data() + static_cast<std::size_t>(index) * sizeof(StoredRow) + offsetof(StoredRow, timestampMs),
+                sizeof(timestampMs));
+    return TimeEntry{timestampMs, index, 0};
+}
+
+SummaryStore::DigestEntry SummaryStore::digestEntry(std::uint32_t index) const {
+    StoredRow stored{};
+    std::memcpy(&stored, rows_.data() + static_cast<std::size_t>(index) * sizeof(StoredRow), sizeof(stored));
+    return DigestEntry{hashDigest(storedDigest(stored)), index, 0};
+}
+
+void SummaryStore::indexRow(std::uint32_t index) {
+    // Rows usually arrive in time order, so the time insert is an append.
+    const TimeEntry time = timeEntry(index);
+    byTime_.insert(std::upper_bound(byTime_.begin(), byTime_.end(), time,
+                                    [](const TimeEntry& lhs, const TimeEntry& rhs) {
+                                        return lhs.timestampMs < rhs.timestampMs;
+                                    }),
+                   time);
+    const DigestEntry digest = digestEntry(index);
+    byDigest_.insert(std::upper_bound(byDigest_.begin(), byDigest_.end(), digest,
+                                      [](const DigestEntry& lhs, const DigestEntry& rhs) {
+                                          return lhs.hash < rhs.hash;
+                                      }),
+                     digest);
+}
+
+bool SummaryStore::saveIndex() const {
+    std::string payload;
+    payload.reserve(sizeof(IndexHeader) + byTime_.size() * (sizeof(TimeEntry) + sizeof(DigestEntry)));
+    const IndexHeader header{kIndexMagic, kStoreVersion, 0, byTime_.size()};
+    payload.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    payload.append(reinterpret_cast<const char*>(byTime_.data()), byTime_.size() * sizeof(TimeEntry));
+    payload.append(reinterpret_cast<const char*>(byDigest_.data()), byDigest_.size() * sizeof(DigestEntry));
+
+    // Same temp-and-rename pattern as the aggregate cache.
+    const auto path = indexPath(directory_);
+    auto tempPath = path;
+    tempPath += ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            return false;
+        }
+        out.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+        if (!out.good()) {
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    return !ec;
+}
+
+} // namespace clamp
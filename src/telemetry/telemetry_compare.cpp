@@ -0,0 +1,623 @@
+#include "clamp/TelemetryComparator.h"
+
+#include "../common/parallel_for.h"
+#include "bootstrap.h"
+#include "compression.h"
+#include "mapped_file.h"
+#include "running_stats.h"
+#include "summary_json.h"
+#include "telemetry_scanner.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <map>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+namespace clamp {
+namespace {
+
+constexpr const char* kUnknown = "@unknown";
+
+// Escapes a path for a JSON string; backend and device names are already
+// escaped as read from the summaries.
+std::string escapeJson(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (const char ch : value) {
+        switch (ch) {
+        case '"':
+            escaped += "\\\"";
+            break;
+        case '\\':
+            escaped += "\\\\";
+            break;
+        case '\n':
+            escaped += "\\n";
+            break;
+        case '\t':
+            escaped += "\\t";
+            break;
+        default:
+            escaped += ch;
+        }
+    }
+    return escaped;
+}
+
+bool isCpuBackend(const std::string& backend) {
+    std::string lower(backend);
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+    return lower == "cpu" || lower == "host";
+}
+
+double varianceRatio(double variance, double baseline) {
+    if (baseline > 0.0) {
+        return variance / baseline;
+    }
+    return variance > 0.0 ? std::numeric_limits<double>::infinity() : 1.0;
+}
+
+// Offset one past the '}' or ']' closing the value that opens at `open`,
+// skipping brackets inside strings; npos when it is not closed.
+std::size_t closingOffset(std::string_view json, std::size_t open) {
+    int depth = 0;
+    for (std::size_t pos = open; pos < json.size(); ++pos) {
+        const char ch = json[pos];
+        if (ch == '"') {
+            for (++pos; pos < json.size() && json[pos] != '"'; pos += json[pos] == '\\' ? 2 : 1) {
+            }
+        } else if (ch == '{' || ch == '[') {
+            ++depth;
+        } else if ((ch == '}' || ch == ']') && --depth == 0) {
+            return pos + 1;
+        }
+    }
+    return std::string_view::npos;
+}
+
+TemporalAggregator::Quantiles readQuantiles(std::string_view json, std::string_view key) {
+    TemporalAggregator::Quantiles quantiles;
+    const auto pos = detail::findSummaryKey(json, key);
+    if (pos != std::string_view::npos) {
+        quantiles.p50 = detail::readSummaryNumber(json, "p50", pos);
+        quantiles.p90 = detail::readSummaryNumber(json, "p90", pos);
+        quantiles.p99 = detail::readSummaryNumber(json, "p99", pos);
+        quantiles.p999 = detail::readSummaryNumber(json, "p999", pos);
+    }
+    return quantiles;
+}
+
+// A key of one group object; empty when the group does not carry it.
+std::string readGroupField(std::string_view group, std::string_view key) {
+    return detail::findSummaryKey(group, key) == std::string_view::npos ? std::string{}
+                                                                        : detail::readSummaryString(group, key);
+}
+
+// The value every group agrees on, or empty.
+std::string sharedGroupField(const std::vector<TemporalAggregator::GroupSummary>& groups,
+                             std::string TemporalAggregator::GroupKey::*field) {
+    if (groups.empty()) {
+        return {};
+    }
+    const std::string& first = groups.front().key.*field;
+    for (const auto& group : groups) {
+        if (group.key.*field != first) {
+            return {};
+        }
+    }
+    return first;
+}
+
+std::optional<TelemetryComparator::Entry> loadEntry(const std::filesystem::path& path) {
+    const detail::MappedFile file(path);
+    if (!file.isOpen()) {
+        return std::nullopt;
+    }
+    const std::string_view contents = file.view();
+    if (detail::findSummaryKey(contents, "session_count") == std::string_view::npos) {
+        return std::nullopt;
+    }
+
+    // Split off the groups array so top-level keys are not matched inside it.
+    std::string_view groups;
+    std::string topLevel;
+    const auto groupsKey = detail::findSummaryKey(contents, "groups");
+    const auto groupsOpen = groupsKey == std::string_view::npos ? groupsKey : contents.find('[', groupsKey);
+    const auto groupsEnd = groupsOpen == std::string_view::npos ? groupsOpen : closingOffset(contents, groupsOpen);
+    std::string_view json = contents;
+    if (groupsEnd != std::string_view::npos) {
+        groups = contents.substr(groupsOpen + 1, groupsEnd - groupsOpen - 2);
+        topLevel.reserve(contents.size() - groups.size());
+        topLevel.append(contents.substr(0, groupsOpen + 1)).append(contents.substr(groupsEnd - 1));
+        json = topLevel;
+    }
+
+    TelemetryComparator::Entry entry;
+    entry.path = path;
+    TemporalAggregator::Summary& summary = entry.summary;
+    summary.sessionCount = static_cast<std::size_t>(detail::readSummaryNumber(json, "session_count"));
+    summary.meanStability = detail::readSummaryNumber(json, "mean_stability");
+    summary.stabilityVariance = detail::readSummaryNumber(json, "stability_variance");
+    summary.driftIndex = detail::readSummaryNumber(json, "drift_index");
+    summary.stabilityQuantiles = readQuantiles(json, "stability_quantiles");
+    summary.durationQuantiles = readQuantiles(json, "duration_ms_quantiles");
+
+    for (std::size_t pos = groups.find('{'); pos != std::string_view::npos; pos = groups.find('{', pos)) {
+        const auto end = closingOffset(groups, pos);
+        if (end == std::string_view::npos) {
+            break;
+        }
+        const std::string_view object = groups.substr(pos, end - pos);
+        TemporalAggregator::GroupSummary group;
+        group.key.context = readGroupField(object, "context");
+        group.key.backend = readGroupField(object, "backend");
+        group.key.deviceName = readGroupField(object, "device_name");
+        group.key.threadId = readGroupField(object, "thread_id");
+        group.sessionCount = static_cast<std::size_t>(detail::readSummaryNumber(object, "session_count"));
+        group.meanStability = detail::readSummaryNumber(object, "mean_stability");
+        group.stabilityVariance = detail::readSummaryNumber(object, "stability_variance");
+        group.driftIndex = detail::readSummaryNumber(object, "drift_index");
+        group.stabilityQuantiles = readQuantiles(object, "stability_quantiles");
+        group.durationQuantiles = readQuantiles(object, "duration_ms_quantiles");
+        summary.groups.push_back(std::move(group));
+        pos = end;
+    }
+
+    entry.backend = detail::readSummaryString(json, "backend");
+    entry.deviceName = detail::readSummaryString(json, "device_name");
+    if (entry.backend.empty()) {
+        entry.backend = sharedGroupField(summary.groups, &TemporalAggregator::GroupKey::backend);
+        if (entry.deviceName.empty()) {
+            entry.deviceName = sharedGroupField(summary.groups, &TemporalAggregator::GroupKey::deviceName);
+        }
+    }
+    if (entry.backend.empty()) {
+        entry.backend = kUnknown;
+    }
+    if (entry.deviceName.empty()) {
+        entry.deviceName = kUnknown;
+    }
+    return entry;
+}
+
+TelemetryComparator::Comparison compareStats(double mean,
+                                             double variance,
+                                             double drift,
+                                             double otherMean,
+                                             double otherVariance,
+                                             double otherDrift,
+                                             double significanceMs) {
+    TelemetryComparator::Comparison comparison;
+    comparison.meanDelta = mean - otherMean;
+    comparison.driftSkew = drift - otherDrift;
+    comparison.varianceRatio = varianceRatio(variance, otherVariance);
+    comparison.driftSignificant = std::abs(comparison.driftSkew) > significanceMs;
+    return comparison;
+}
+
+// JSON has no infinity; an undefined ratio is written as null.
+void writeNumber(std::ostream& out, double value) {
+    if (std::isfinite(value)) {
+        out << value;
+    } else {
+        out << "null";
+    }
+}
+
+template <typename Field>
+void writeMatrix(std::ostream& out, const TelemetryComparator::Result& result, const char* name, Field field) {
+    const std::size_t size = result.backends.size();
+    out << "\"" << name << "\":[";
+    for (std::size_t row = 0; row < size; ++row) {
+        out << (row == 0 ? "[" : ",[");
+        for (std::size_t column = 0; column < size; ++column) {
+            if (column != 0) {
+                out << ",";
+            }
+            field(out, result.at(row, column));
+        }
+        out << "]";
+    }
+    out << "]";
+}
+
+bool writeReport(const TelemetryComparator::Result& result,
+                 const TelemetryComparator::Entry* baseline,
+                 const std::filesystem::path& outputPath) {
+    std::error_code ec;
+    const auto parent = outputPath.parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, ec);
+    }
+    std::ofstream out(outputPath);
+    if (!out.is_open()) {
+        return false;
+    }
+
+    out << std::fixed << std::setprecision(6);
+    out << "{\"baseline\":";
+    if (baseline == nullptr) {
+        out << "null";
+    } else {
+        out << "{\"path\":\"" << escapeJson(baseline->path.string()) << "\",";
+        out << "\"backend\":\"" << baseline->backend << "\",";
+        out << "\"deviceName\":\"" << baseline->deviceName << "\",";
+        out << "\"meanStability\":" << baseline->summary.meanStability << ",";
+        out << "\"variance\":" << baseline->summary.stabilityVariance << ",";
+        out << "\"driftIndex\":" << baseline->summary.driftIndex << "}";
+    }
+
+    out << ",\"entries\":[";
+    for (std::size_t i = 0; i < result.entries.size(); ++i) {
+        const auto& entry = result.entries[i];
+        out << (i == 0 ? "" : ",") << "{";
+        out << "\"path\":\"" << escapeJson(entry.path.string()) << "\",";
+        out << "\"backend\":\"" << entry.backend << "\",";
+        out << "\"deviceName\":\"" << entry.deviceName << "\",";
+        out << "\"sessionCount\":" << entry.summary.sessionCount << ",";
+        out << "\"meanDelta\":" << entry.meanDelta << ",";
+        out << "\"driftSkew\":" << entry.driftSkew << ",";
+        out << "\"varianceRatio\":";
+        writeNumber(out, entry.varianceRatio);
+        out << ",\"driftSignificant\":" << (entry.driftSignificant ? "true" : "false") << "}";
+    }
+
+    out << "],\"backends\":[";
+    for (std::size_t i = 0; i < result.backends.size(); ++i) {
+        const auto& backend = result.backends[i];
+        out << (i == 0 ? "" : ",") << "{";
+        out << "\"backend\":\"" << backend.backend << "\",";
+        out << "\"deviceName\":\"" << backend.deviceName << "\",";
+        out << "\"summaryCount\":" << backend.summaryCount << ",";
+        out << "\"sessionCount\":" << backend.sessionCount << ",";
+        out << "\"meanStability\":" << backend.meanStability << ",";
+        out << "\"variance\":" << backend.stabilityVariance << ",";
+        out << "\"driftIndex\":" << backend.driftIndex << "}";
+    }
+
+    out << "],\"matrix\":{";
+    writeMatrix(out, result, "meanDelta", [](std::ostream& os, const auto& cell) { os << cell.meanDelta; });
+    out << ",";
+    writeMatrix(out, result, "driftSkew", [](std::ostream& os, const auto& cell) { os << cell.driftSkew; });
+    out << ",";
+    writeMatrix(out, result, "varianceRatio",
+                [](std::ostream& os, const auto& cell) { writeNumber(os, cell.varianceRatio); });
+    out << ",";
+    writeMatrix(out, result, "driftSignificant",
+                [](std::ostream& os, const auto& cell) { os << (cell.driftSignificant ? "true" : "false"); });
+    out << "}}\n";
+    return out.good();
+}
+
+
+// Collects finite (stability, duration) pairs per backend/device of one file.
+class RecordCollector : public detail::RecordSink {
+public:
+    void onRecord(const detail::ParsedRecord& record) override {
+        if (!std::isfinite(record.stabilityScore) || !std::isfinite(record.durationMs)) {
+            return;
+        }
+        const std::string_view backend = record.backend.empty() ? std::string_view(kUnknown) : record.backend;
+        const std::string_view deviceName =
+            record.deviceName.empty() ? std::string_view(kUnknown) : record.deviceName;
+        // Files usually hold a single backend, so the last one is checked first.
+        if (last_ == nullptr || last_->backend != backend || last_->deviceName != deviceName) {
+            last_ = nullptr;
+            for (auto& records : backends) {
+                if (records.backend == backend && records.deviceName == deviceName) {
+                    last_ = &records;
+                    break;
+                }
+            }
+            if (last_ == nullptr) {
+                backends.push_back({std::string(backend), std::string(deviceName), {}, {}});
+                last_ = &backends.back();
+            }
+        }
+        last_->stability.push_back(record.stabilityScore);
+        last_->durationMs.push_back(record.durationMs);
+    }
+
+    std::vector<TelemetryComparator::BackendRecords> backends;
+
+private:
+    TelemetryComparator::BackendRecords* last_{nullptr};
+};
+
+std::vector<TelemetryComparator::BackendRecords> loadRecords(const std::filesystem::path& path) {
+    RecordCollector collector;
+    constexpr unsigned kFields = detail::TelemetryScanner::kFieldBackend | detail::TelemetryScanner::kFieldDeviceName;
+    const auto compression = detail::compressionForPath(path);
+    if (compression == TelemetryCompression::None) {
+        const detail::MappedFile file(path);
+        if (file.isOpen()) {
+            detail::TelemetryScanner::scan(file.view(), collector, kFields);
+        }
+    } else {
+        detail::TelemetryScanner scanner(collector, kFields);
+        if (detail::decompressFile(path, compression, [&](std::string_view chunk) {
+                scanner.feed(chunk);
+                return true;
+            })) {
+            scanner.finish();
+        }
+    }
+    return std::move(collector.backends);
+}
+
+double mean(const std::vector<double>& values) {
+    double sum = 0.0;
+    for (const double value : values) {
+        sum += value;
+    }
+    return values.empty() ? 0.0 : sum / static_cast<double>(values.size());
+}
+
+// Linearly interpolated quantile of sorted values.
+double sortedQuantile(const std::vector<double>& sorted, double probability) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    const double position = probability * static_cast<double>(sorted.size() - 1);
+    const auto below = static_cast<std::size_t>(position);
+    const std::size_t above = std::min(below + 1, sorted.size() - 1);
+    return sorted[below] + (sorted[above] - sorted[below]) * (position - static_cast<double>(below));
+}
+
+// Percentile interval of lhs[r] - rhs[r] over the replicates.
+TelemetryComparator::Interval percentileInterval(double estimate,
+                                                 const std::vector<double>& lhs,
+                                                 const std::vector<double>& rhs,
+                                                 double confidence,
+                                                 std::vector<double>& scratch) {
+    TelemetryComparator::Interval interval;
+    interval.estimate = estimate;
+    interval.lower = estimate;
+    interval.upper = estimate;
+    if (lhs.empty()) {
+        return interval;
+    }
+    scratch.resize(lhs.size());
+    for (std::size_t r = 0; r < lhs.size(); ++r) {
+        scratch[r] = lhs[r] - rhs[r];
+    }
+    std::sort(scratch.begin(), scratch.end());
+    const double tail = (1.0 - std::clamp(confidence, 0.0, 1.0)) / 2.0;
+    interval.lower = sortedQuantile(scratch, tail);
+    interval.upper = sortedQuantile(scratch, 1.0 - tail);
+    interval.significant = interval.lower > 0.0 || interval.upper < 0.0;
+    return interval;
+}
+
+void writeInterval(std::ostream& out, const TelemetryComparator::Interval& interval) {
+    out << "{\"estimate\":" << interval.estimate << ",\"lower\":" << interval.lower << ",\"upper\":"
+        << interval.upper << ",\"significant\":" << (interval.significant ? "true" : "false") << "}";
+}
+
+bool writeBootstrapReport(const TelemetryComparator::BootstrapResult& result, const std::filesystem::path& outputPath) {
+    std::error_code ec;
+    const auto parent = outputPath.parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, ec);
+    }
+    std::ofstream out(outputPath);
+    if (!out.is_open()) {
+        return false;
+    }
+
+    out << std::setprecision(9);
+    out << "{\"resamples\":" << result.resamples << ",\"confidence\":" << result.confidence << ",\"backends\":[";
+    for (std::size_t i = 0; i < result.backends.size(); ++i) {
+        const auto& backend = result.backends[i];
+        out << (i == 0 ? "" : ",") << "{";
+        out << "\"backend\":\"" << backend.backend << "\",";
+        out << "\"deviceName\":\"" << backend.deviceName << "\",";
+        out << "\"recordCount\":" << backend.recordCount << ",";
+        out << "\"meanStability\":" << backend.meanStability << ",";
+        out << "\"meanDurationMs\":" << backend.meanDurationMs << "}";
+    }
+    const std::size_t size = result.backends.size();
+    auto writeCells = [&](const char* name, auto field) {
+        out << "\"" << name << "\":[";
+        for (std::size_t row = 0; row < size; ++row) {
+            out << (row == 0 ? "[" : ",[");
+            for (std::size_t column = 0; column < size; ++column) {
+                if (column != 0) {
+                    out << ",";
+                }
+                writeInterval(out, field(result.at(row, column)));
+            }
+            out << "]";
+        }
+        out << "]";
+    };
+    out << "],\"matrix\":{";
+    writeCells("meanStabilityDelta", [](const auto& cell) { return cell.meanStabilityDelta; });
+    out << ",";
+    writeCells("meanDurationDeltaMs", [](const auto& cell) { return cell.meanDurationDeltaMs; });
+    out << "}}\n";
+    return out.good();
+}
+
+} // namespace
+
+TelemetryComparator::Result TelemetryComparator::compare(const std::vector<std::filesystem::path>& summaryPaths,
+                                                         const std::filesystem::path& outputPath) const {
+    Result result;
+
+    // Each file lands in its own slot, so the entry order never depends on
+    // which thread parsed it.
+    std::vector<std::optional<Entry>> loaded(summaryPaths.size());
+    detail::parallelFor(
+        summaryPaths.size(), options_.workerCount, [&](std::size_t i) { loaded[i] = loadEntry(summaryPaths[i]); },
+        16);
+    result.entries.reserve(summaryPaths.size());
+    for (auto& entry : loaded) {
+        if (entry) {
+            result.entries.push_back(std::move(*entry));
+        }
+    }
+
+    const Entry* baseline = nullptr;
+    for (const auto& entry : result.entries) {
+        if (isCpuBackend(entry.backend) || isCpuBackend(entry.deviceName)) {
+            baseline = &entry;
+            break;
+        }
+    }
+    if (baseline == nullptr && !result.entries.empty()) {
+        baseline = &result.entries.front();
+    }
+    if (baseline != nullptr) {
+        result.baselineBackend = baseline->backend;
+        const auto& base = baseline->summary;
+        for (auto& entry : result.entries) {
+            const auto comparison =
+                compareStats(entry.summary.meanStability, entry.summary.stabilityVariance, entry.summary.driftIndex,
+                             base.meanStability, base.stabilityVariance, base.driftIndex,
+                             options_.driftSignificanceMs);
+            entry.meanDelta = comparison.meanDelta;
+            entry.driftSkew = comparison.driftSkew;
+            entry.varianceRatio = comparison.varianceRatio;
+            entry.driftSignificant = comparison.driftSignificant;
+        }
+    }
+
+    // Pool summaries per backend/device. Sessions are merged with the Chan
+    // update, so the pooled variance is that of all sessions together.
+    struct Pool {
+        detail::RunningStats stability;
+        double driftWeighted{0.0};
+        std::size_t summaryCount{0};
+    };
+    std::map<std::pair<std::string, std::string>, Pool> pools;
+    for (const auto& entry : result.entries) {
+        Pool& pool = pools[{entry.backend, entry.deviceName}];
+        const auto& summary = entry.summary;
+        detail::RunningStats sessions;
+        sessions.count = summary.sessionCount;
+        sessions.mean = summary.meanStability;
+        sessions.m2 = summary.sessionCount > 1
+                          ? summary.stabilityVariance * static_cast<double>(summary.sessionCount - 1)
+                          : 0.0;
+        pool.stability.merge(sessions);
+        pool.driftWeighted += summary.driftIndex * static_cast<double>(summary.sessionCount);
+        ++pool.summaryCount;
+    }
+    result.backends.reserve(pools.size());
+    for (const auto& [key, pool] : pools) {
+        Backend backend;
+        backend.backend = key.first;
+        backend.deviceName = key.second;
+        backend.summaryCount = pool.summaryCount;
+        backend.sessionCount = pool.stability.count;
+        backend.meanStability = pool.stability.mean;
+        backend.stabilityVariance = pool.stability.variance();
+        backend.driftIndex =
+            pool.stability.count == 0 ? 0.0 : pool.driftWeighted / static_cast<double>(pool.stability.count);
+        result.backends.push_back(std::move(backend));
+    }
+
+    const std::size_t size = result.backends.size();
+    result.matrix.resize(size * size);
+    for (std::size_t row = 0; row < size; ++row) {
+        const auto& lhs = result.backends[row];
+        for (std::size_t column = 0; column < size; ++column) {
+            const auto& rhs = result.backends[column];
+            result.matrix[row * size + column] =
+                compareStats(lhs.meanStability, lhs.stabilityVariance, lhs.driftIndex, rhs.meanStability,
+                             rhs.stabilityVariance, rhs.driftIndex, options_.driftSignificanceMs);
+        }
+    }
+
+    if (!outputPath.empty()) {
+        result.wroteOutput = writeReport(result, baseline, outputPath);
+    }
+    return result;
+}
+
+TelemetryComparator::BootstrapResult TelemetryComparator::bootstrap(
+    const std::vector<std::filesystem::path>& telemetryPaths,
+    const std::filesystem::path& outputPath) const {
+    std::vector<std::vector<BackendRecords>> perFile(telemetryPaths.size());
+    detail::parallelFor(telemetryPaths.size(), options_.workerCount,
+                        [&](std::size_t i) { perFile[i] = loadRecords(telemetryPaths[i]); });
+    std::vector<BackendRecords> records;
+    for (auto& file : perFile) {
+        for (auto& backend : file) {
+            records.push_back(std::move(backend));
+        }
+    }
+    return bootstrap(std::move(records), outputPath);
+}
+
+TelemetryComparator::BootstrapResult TelemetryComparator::bootstrap(std::vector<BackendRecords> records,
+                                                                    const std::filesystem::path& outputPath) const {
+    // Entries for the same backend/device are concatenated in input order.
+    std::map<std::pair<std::string, std::string>, BackendRecords> merged;
+    for (auto& entry : records) {
+        auto [it, inserted] = merged.try_emplace({entry.backend, entry.deviceName});
+        BackendRecords& target = it->second;
+        const std::size_t size = std::min(entry.stability.size(), entry.durationMs.size());
+        if (inserted) {
+            target.backend = std::move(entry.backend);
+            target.deviceName = std::move(entry.deviceName);
+        }
+        target.stability.insert(target.stability.end(), entry.stability.begin(), entry.stability.begin() + size);
+        target.durationMs.insert(target.durationMs.end(), entry.durationMs.begin(), entry.durationMs.begin() + size);
+    }
+
+    BootstrapResult result;
+    result.resamples = options_.resamples;
+    result.confidence = options_.confidence;
+    std::vector<detail::ResampledMeans> replicates;
+    replicates.reserve(merged.size());
+    for (const auto& [key, backend] : merged) {
+        BootstrapBackend summary;
+        summary.backend = backend.backend;
+        summary.deviceName = backend.deviceName;
+        summary.recordCount = backend.stability.size();
+        summary.meanStability = mean(backend.stability);
+        summary.meanDurationMs = mean(backend.durationMs);
+        // Each backend draws from its own stream, so the replicates of two
+        // backends are independent.
+        replicates.push_back(detail::bootstrapMeans(backend.stability.data(), backend.durationMs.data(),
+                                                    backend.stability.size(), options_.resamples,
+                                                    options_.seed + result.backends.size(), options_.workerCount));
+        result.backends.push_back(std::move(summary));
+    }
+
+    const std::size_t size = result.backends.size();
+    result.matrix.resize(size * size);
+    std::vector<double> scratch;
+    for (std::size_t row = 0; row < size; ++row) {
+        for (std::size_t column = 0; column < size; ++column) {
+            const auto& lhs = result.backends[row];
+            const auto& rhs = result.backends[column];
+            BootstrapComparison& cell = result.matrix[row * size + column];
+            if (row == column) {
+                continue;
+            }
+            cell.meanStabilityDelta =
+                percentileInterval(lhs.meanStability - rhs.meanStability, replicates[row].stability,
+                                   replicates[column].stability, options_.confidence, scratch);
+            cell.meanDurationDeltaMs =
+                percentileInterval(lhs.meanDurationMs - rhs.meanDurationMs, replicates[row].durationMs,
+                                   replicates[column].durationMs, options_.confidence, scratch);
+        }
+    }
+
+    if (!outputPath.empty()) {
+        result.wroteOutput = writeBootstrapReport(result, outputPath);
+    }
+    return result;
+}
+
+} // namespace clamp
@@ -0,0 +1,510 @@
+#include "telemetry_scanner.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define CLAMP_SCANNER_X86 1
+#else
+#define CLAMP_SCANNER_X86 0
+#endif
+
+#if CLAMP_SCANNER_X86 && (defined(__GNUC__) || defined(__clang__))
+#define CLAMP_SCANNER_AVX2 1
+#else
+#define CLAMP_SCANNER_AVX2 0
+#endif
+
+namespace clamp::detail {
+namespace {
+
+constexpr std::string_view kRecordsKey{"records"};
+constexpr std::string_view kStabilityKey{"stability_score"};
+constexpr std::string_view kAcquiredKey{"acquired_at"};
+constexpr std::string_view kDurationKey{"duration_ms"};
+
+constexpr int kContextSlot = 0;
+constexpr int kBackendSlot = 1;
+constexpr int kDeviceSlot = 2;
+constexpr int kThreadSlot = 3;
+constexpr int kDocumentSlotOffset = 3;
+
+// '[' and ']' differ from '{' and '}' only in bit 0x20, so OR-ing it in lets
+// a single comparison catch both bracket kinds.
+bool isStructural(char ch) {
+    const char folded = static_cast<char>(ch | 0x20);
+    return ch == '"' || folded == '{' || folded == '}';
+}
+
+const char* findStructuralScalar(const char* p, const char* end) {
+    while (p < end && !isStructural(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+const char* findQuoteOrEscapeScalar(const char* p, const char* end) {
+    while (p < end && *p != '"' && *p != '\\') {
+        ++p;
+    }
+    return p;
+}
+
+#if CLAMP_SCANNER_X86
+const char* findStructuralSse2(const char* p, const char* end) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i open = _mm_set1_epi8('{');
+    const __m128i close = _mm_set1_epi8('}');
+    const __m128i fold = _mm_set1_epi8(0x20);
+    while (end - p >= 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i folded = _mm_or_si128(chunk, fold);
+        const __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                          _mm_or_si128(_mm_cmpeq_epi8(folded, open), _mm_cmpeq_epi8(folded, close)));
+        const int mask = _mm_movemask_epi8(hits);
+        if (mask != 0) {
+            return p + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+        p += 16;
+    }
+    return findStructuralScalar(p, end);
+}
+
+const char* findQuoteOrEscapeSse2(const char* p, const char* end) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i escape = _mm_set1_epi8('\\');
+    while (end - p >= 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, escape)));
+        if (mask != 0) {
+            return p + __builtin_ctz(static_cast<unsigned>(mask));
+        }
+        p += 16;
+    }
+    return findQuoteOrEscapeScalar(p, end);
+}
+#endif
+
+#if CLAMP_SCANNER_AVX2
+__attribute__((target("avx2"))) const char* findStructuralAvx2(const char* p, const char* end) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i open = _mm256_set1_epi8('{');
+    const __m256i close = _mm256_set1_epi8('}');
+    const __m256i fold = _mm256_set1_epi8(0x20);
+    while (end - p >= 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        const __m256i folded = _mm256_or_si256(chunk, fold);
+        const __m256i hits = _mm256_or_si256(
+            _mm256_cmpeq_epi8(chunk, quote),
+            _mm256_or_si256(_mm256_cmpeq_epi8(folded, open), _mm256_cmpeq_epi8(folded, close)));
+        const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hits));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+    return findStructuralSse2(p, end);
+}
+
+__attribute__((target("avx2"))) const char* findQuoteOrEscapeAvx2(const char* p, const char* end) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i escape = _mm256_set1_epi8('\\');
+    while (end - p >= 32) {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        const unsigned mask = static_cast<unsigned>(
+            _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, escape))));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+    return findQuoteOrEscapeSse2(p, end);
+}
+#endif
+
+struct Kernels {
+    const char* (*findStructural)(const char*, const char*);
+    const char* (*findQuoteOrEscape)(const char*, const char*);
+    const char* name;
+};
+
+Kernels selectKernels() {
+#if CLAMP_SCANNER_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        return {findStructuralAvx2, findQuoteOrEscapeAvx2, "avx2"};
+    }
+#endif
+#if CLAMP_SCANNER_X86
+    return {findStructuralSse2, findQuoteOrEscapeSse2, "sse2"};
+#else
+    return {findStructuralScalar, findQuoteOrEscapeScalar, "scalar"};
+#endif
+}
+
+const Kernels& kernels() {
+    static const Kernels selected = selectKernels();
+    return selected;
+}
+
+bool isNumberChar(char ch) {
+    return (ch >= '0' && ch <= '9') || ch == '-' || ch == '+' || ch == '.' || ch == 'e' || ch == 'E';
+}
+
+// Clinger's fast path for the plain decimals EntropyTelemetry writes ("0.75",
+// "12.500"): with at most 15 significant digits the mantissa and the power of
+// ten are both exact doubles, so one division gives the correctly rounded
+// result. Anything else (exponents, longer mantissas) is left to from_chars,
+// which is markedly slower on some standard libraries.
+bool parseShortDecimal(const char* p, const char* end, double& out) {
+    static constexpr double kPowersOfTen[] = {1e0, 1e1, 1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                              1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+    const bool negative = p < end && *p == '-';
+    if (negative) {
+        ++p;
+    }
+    std::uint64_t mantissa = 0;
+    int digits = 0;
+    int fractionDigits = 0;
+    const char* const integerBegin = p;
+    while (p < end && *p >= '0' && *p <= '9') {
+        mantissa = mantissa * 10 + static_cast<std::uint64_t>(*p - '0');
+        ++digits;
+        ++p;
+    }
+    if (p == integerBegin) {
+        return false;
+    }
+    if (p < end && *p == '.') {
+        ++p;
+        const char* const fractionBegin = p;
+        while (p < end && *p >= '0' && *p <= '9') {
+            mantissa = mantissa * 10 + static_cast<std::uint64_t>(*p - '0');
+            ++digits;
+            ++p;
+        }
+        fractionDigits = static_cast<int>(p - fractionBegin);
+        if (fractionDigits == 0) {
+            return false;
+        }
+    }
+    if (p != end || digits > 15) {
+        return false;
+    }
+    const double value = static_cast<double>(mantissa) / kPowersOfTen[fractionDigits];
+    out = negative ? -value : value;
+    return true;
+}
+
+const char* skipWhitespace(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) {
+        ++p;
+    }
+    return p;
+}
+
+// Returns one past the closing quote of the string opening at `p[-1]`, or
+// nullptr when the string is unterminated. `escaped` reports whether the
+// contents contain backslash escapes.
+const char* skipString(const char* p, const char* end, bool& escaped) {
+    const auto& kernel = kernels();
+    escaped = false;
+    for (;;) {
+        p = kernel.findQuoteOrEscape(p, end);
+        if (p >= end) {
+            return nullptr;
+        }
+        if (*p == '"') {
+            return p + 1;
+        }
+        escaped = true;
+        p += 2;
+    }
+}
+
+} // namespace
+
+TelemetryScanner::TelemetryScanner(RecordSink& sink, unsigned fields, const RecordFilter* filter)
+    : sink_(sink),
+      fields_(fields),
+      filter_(filter != nullptr && filter->active() ? filter : nullptr),
+      captured_(fields) {
+    if (filter_ != nullptr) {
+        captured_ |= (filter_->contexts.empty() ? 0u : kFieldContext) | (filter_->backends.empty() ? 0u : kFieldBackend);
+    }
+}
+
+std::size_t TelemetryScanner::scan(std::string_view json, RecordSink& sink, unsigned fields, const RecordFilter* filter) {
+    TelemetryScanner scanner(sink, fields, filter);
+    scanner.feed(json);
+    return scanner.finish();
+}
+
+void TelemetryScanner::feed(std::string_view chunk) {
+    std::size_t offset = 0;
+    if (!carry_.empty()) {
+        // Top up the carried token from the new chunk in growing steps until it
+        // completes, then continue scanning the chunk in place.
+        std::size_t tail = carry_.size();
+        std::size_t step = 256;
+        for (;;) {
+            const std::size_t take = std::min(step, chunk.size() - offset);
+            carry_.append(chunk.data() + offset, take);
+            offset += take;
+            const std::size_t resume = scanBuffer(carry_.data(), carry_.size(), false, tail);
+            if (resume >= tail) {
+                offset = resume - tail;
+                carry_.clear();
+                break;
+            }
+            carry_.erase(0, resume);
+            tail -= resume;
+            if (offset == chunk.size()) {
+                return;
+            }
+            step *= 2;
+        }
+    }
+    const std::size_t remaining = chunk.size() - offset;
+    const std::size_t resume = scanBuffer(chunk.data() + offset, remaining, false, remaining);
+    carry_.assign(chunk.data() + offset + resume, remaining - resume);
+}
+
+std::size_t TelemetryScanner::finish() {
+    if (!carry_.empty()) {
+        scanBuffer(carry_.data(), carry_.size(), true, carry_.size());
+        carry_.clear();
+    }
+    return emitted_;
+}
+
+int TelemetryScanner::capturedField(std::string_view key) const {
+    if (key == "context") {
+        return (captured_ & kFieldContext) != 0 ? kContextSlot : -1;
+    }
+    if (key == "backend") {
+        return (captured_ & kFieldBackend) != 0 ? kBackendSlot : -1;
+    }
+    if (key == "deviceName" || key == "device_name") {
+        return (captured_ & kFieldDeviceName) != 0 ? kDeviceSlot : -1;
+    }
+    if (key == "thread_id") {
+        return (captured_ & kFieldThreadId) != 0 ? kThreadSlot : -1;
+    }
+    return -1;
+}
+
+std::size_t TelemetryScanner::scanBuffer(const char* data, std::size_t size, bool final, std::size_t stopAfter) {
+    const auto& kernel = kernels();
+    const char* p = data;
+    const char* const end = data + size;
+
+    for (;;) {
+        p = kernel.findStructural(p, end);
+        if (p >= end) {
+            return size;
+        }
+        if (static_cast<std::size_t>(p - data) >= stopAfter) {
+            return static_cast<std::size_t>(p - data);
+        }
+        const char* const tokenStart = p;
+        const auto pending = static_cast<std::size_t>(tokenStart - data);
+        switch (*p) {
+        case '{':
+            ++depth_;
+            if (recordsDepth_ >= 0 && depth_ == recordsDepth_ + 1) {
+                inRecord_ = true;
+                rejected_ = false;
+                record_ = ParsedRecord{};
+                if (captured_ != 0) {
+                    for (int slot = kContextSlot; slot <= kThreadSlot; ++slot) {
+                        fieldValues_[slot].clear();
+                    }
+                }
+            }
+            recordsKeyPending_ = false;
+            ++p;
+            break;
+        case '}':
+            if (inRecord_ && depth_ == recordsDepth_ + 1) {
+                inRecord_ = false;
+                record_.hasTimestamp = std::isfinite(record_.timestampMs);
+                if (!record_.hasTimestamp) {
+                    record_.timestampMs = static_cast<double>(recordIndex_);
+                }
+                ++recordIndex_;
+                auto inherited = [this](int slot) -> std::string_view {
+                    const auto& own = fieldValues_[slot];
+                    return own.empty() ? std::string_view(fieldValues_[slot + kDocumentSlotOffset]) : own;
+                };
+                if (filter_ != nullptr && !rejected_) {
+                    rejected_ = !filter_->acceptsTime(record_.hasTimestamp ? record_.timestampMs
+                                                                            : std::numeric_limits<double>::quiet_NaN()) ||
+                                !RecordFilter::accepts(filter_->contexts, fieldValues_[kContextSlot]) ||
+                                !RecordFilter::accepts(filter_->backends, inherited(kBackendSlot));
+                }
+                if (!rejected_) {
+                    if (fields_ != 0) {
+                        // Fields captured only for the filter stay empty.
+                        const auto selected = [this](unsigned field, std::string_view value) {
+                            return (fields_ & field) != 0 ? value : std::string_view{};
+                        };
+                        record_.context = selected(kFieldContext, fieldValues_[kContextSlot]);
+                        record_.backend = selected(kFieldBackend, inherited(kBackendSlot));
+                        record_.deviceName = selected(kFieldDeviceName, inherited(kDeviceSlot));
+                        record_.threadId = selected(kFieldThreadId, fieldValues_[kThreadSlot]);
+                    }
+                    sink_.onRecord(record_);
+                    ++emitted_;
+                }
+            }
+            --depth_;
+            ++p;
+            break;
+        case '[':
+            ++depth_;
+            if (recordsKeyPending_ && depth_ == 2) {
+                recordsDepth_ = depth_;
+            }
+            recordsKeyPending_ = false;
+            ++p;
+            break;
+        case ']':
+            if (depth_ == recordsDepth_) {
+                recordsDepth_ = -1;
+            }
+            --depth_;
+            ++p;
+            break;
+        default: {
+            // '"': a key if followed by ':', otherwise a string value we skip.
+            const char* begin = p + 1;
+            bool escaped = false;
+            p = skipString(begin, end, escaped);
+            if (p == nullptr) {
+                return final ? size : pending;
+            }
+            const std::string_view text(begin, static_cast<std::size_t>(p - 1 - begin));
+            const char* next = skipWhitespace(p, end);
+            if (next >= end) {
+                if (!final) {
+                    return pending;
+                }
+                break;
+            }
+            if (*next != ':' || escaped) {
+                break;
+            }
+            if (depth_ == 1 && text == kRecordsKey) {
+                recordsKeyPending_ = true;
+                p = next + 1;
+                break;
+            }
+            recordsKeyPending_ = false;
+            const bool atRecord = inRecord_ && depth_ == recordsDepth_ + 1;
+            if (atRecord && rejected_) {
+                p = next + 1;
+                break;
+            }
+            if (captured_ != 0 && (atRecord || depth_ == 1)) {
+                int slot = capturedField(text);
+                if (!atRecord && slot != kBackendSlot && slot != kDeviceSlot) {
+                    slot = -1;
+                }
+                if (slot >= 0) {
+                    const char* value = skipWhitespace(next + 1, end);
+                    if (value >= end) {
+                        if (!final) {
+                            return pending;
+                        }
+                        p = value;
+                        break;
+                    }
+                    if (*value != '"') {
+                        p = value;
+                        break;
+                    }
+                    const char* valueBegin = value + 1;
+                    bool valueEscaped = false;
+                    value = skipString(valueBegin, end, valueEscaped);
+                    if (value == nullptr) {
+                        return final ? size : pending;
+                    }
+                    auto& captured = fieldValues_[atRecord ? slot : slot + kDocumentSlotOffset];
+                    captured.assign(valueBegin, static_cast<std::size_t>(value - 1 - valueBegin));
+                    if (atRecord && filter_ != nullptr) {
+                        rejected_ = (slot == kContextSlot && !RecordFilter::accepts(filter_->contexts, captured)) ||
+                                    (slot == kBackendSlot && !captured.empty() &&
+                                     !RecordFilter::accepts(filter_->backends, captured));
+                    }
+                    p = value;
+                    break;
+                }
+            }
+            if (!atRecord) {
+                p = next + 1;
+                break;
+            }
+            double* number = text == kStabilityKey ? &record_.stabilityScore
+                             : text == kDurationKey ? &record_.durationMs
+                                                    : nullptr;
+            const bool isAcquired = number == nullptr && text == kAcquiredKey;
+            if (number == nullptr && !isAcquired) {
+                p = next + 1;
+                break;
+            }
+            const char* value = skipWhitespace(next + 1, end);
+            if (value >= end && !final) {
+                return pending;
+            }
+            if (number != nullptr) {
+                // A number is only complete once a delimiter follows it; "1e"
+                // at a chunk boundary may still grow into "1e-3".
+                const char* numberEnd = value;
+                while (numberEnd < end && isNumberChar(*numberEnd)) {
+                    ++numberEnd;
+                }
+                if (numberEnd == end && !final) {
+                    return pending;
+                }
+                double parsed = 0.0;
+                if (parseShortDecimal(value, numberEnd, parsed)) {
+                    *number = parsed;
+                    value = numberEnd;
+                } else {
+                    const auto result = std::from_chars(value, numberEnd, parsed);
+                    if (result.ec == std::errc{}) {
+                        *number = parsed;
+                        value = result.ptr;
+                    }
+                }
+            } else if (value < end && *value == '"') {
+                const char* stampBegin = value + 1;
+                bool stampEscaped = false;
+                value = skipString(stampBegin, end, stampEscaped);
+                if (value == nullptr) {
+                    return final ? size : pending;
+                }
+                if (!stampEscaped) {
+                    record_.timestampMs = parseIsoTimestampMs(
+                        std::string_view(stampBegin, static_cast<std::size_t>(value - 1 - stampBegin)));
+                }
+                if (filter_ != nullptr && !filter_->acceptsTime(record_.timestampMs)) {
+                    rejected_ = true;
+                }
+            }
+            p = value;
+            break;
+        }
+        }
+    }
+}
+
+const char* TelemetryScanner::kernelName() {
+    return kernels().name;
+}
+
+} // namespace clamp::detail
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "iso_timestamp.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace clamp::detail {
+
+// String fields are raw (still JSON-escaped) views that stay valid only for
+// the duration of RecordSink::onRecord, and are only filled when requested via
+// TelemetryScanner's field mask.
+struct ParsedRecord {
+    double stabilityScore{std::numeric_limits<double>::quiet_NaN()};
+    double timestampMs{std::numeric_limits<double>::quiet_NaN()};
+    double durationMs{std::numeric_limits<double>::quiet_NaN()};
+    // False when timestampMs is the record-index fallback.
+    bool hasTimestamp{false};
+    std::string_view context;
+    std::string_view backend;
+    std::string_view deviceName;
+    std::string_view threadId;
+};
+
+// Record predicates evaluated inside the scanner. Once acquired_at or a record's
+// own context/backend rules a record out, its remaining values are skipped
+// without being parsed and the sink never sees it. String values are compared
+// raw (still JSON-escaped).
+struct RecordFilter {
+    // Half-open window on acquired_at; records without a parsable timestamp
+    // fail any window.
+    bool windowed{false};
+    double fromMs{-std::numeric_limits<double>::infinity()};
+    double toMs{std::numeric_limits<double>::infinity()};
+    // Accepted values; empty accepts everything. A record without its own
+    // backend is matched on the document-level one.
+    std::vector<std::string> contexts;
+    std::vector<std::string> backends;
+
+    bool active() const { return windowed || !contexts.empty() || !backends.empty(); }
+    bool acceptsTime(double timestampMs) const {
+        return !windowed || (timestampMs >= fromMs && timestampMs < toMs);
+    }
+    static bool accepts(const std::vector<std::string>& values, std::string_view value) {
+        return values.empty() || std::find(values.begin(), values.end(), value) != values.end();
+    }
+};
+
+class RecordSink {
+public:
+    virtual ~RecordSink() = default;
+    virtual void onRecord(const ParsedRecord& record) = 0;
+};
+
+// Single-pass scanner for EntropyTelemetry documents. It walks the structural
+// characters of the buffer with SIMD (AVX2 or SSE2, scalar elsewhere), only
+// materialises `stability_score`, `duration_ms` and `acquired_at` from objects
+// directly inside the top-level "records" array, and never allocates. Records
+// without a parsable timestamp receive their index within the document,
+// matching the previous parsers.
+//
+// Grouping fields are captured on request. A record without its own `backend`
+// or `deviceName` inherits the document-level value, as EntropyTelemetry
+// writes both. An optional RecordFilter drops records during the scan; records
+// without a timestamp still receive their index among all records.
+//
+// Input may arrive in arbitrary chunks through feed(); a token cut by a chunk
+// boundary is completed from the next chunk via a small carry buffer, so
+// memory use is bounded by the longest token rather than the document.
+class TelemetryScanner {
+public:
+    enum Field : unsigned {
+        kFieldContext = 1u << 0,
+        kFieldBackend = 1u << 1,
+        kFieldDeviceName = 1u << 2,
+        kFieldThreadId = 1u << 3
+    };
+
+    // `filter` must outlive the scanner.
+    explicit TelemetryScanner(RecordSink& sink, unsigned fields = 0, const RecordFilter* filter = nullptr);
+
+    void feed(std::string_view chunk);
+    // Flushes a trailing token and returns the number of records delivered.
+    std::size_t finish();
+    std::size_t emitted() const { return emitted_; }
+
+    // Scans a complete document in one call.
+    static std::size_t scan(std::string_view json,
+                            RecordSink& sink,
+                            unsigned fields = 0,
+                            const RecordFilter* filter = nullptr);
+
+    // Name of the kernel selected for this CPU ("avx2", "sse2" or "scalar").
+    static const char* kernelName();
+
+private:
+    // Scans data[0, size) and returns the offset of the first byte not yet
+    // consumed. Parser state only changes when a whole token has been read, so
+    // scanning can resume from that offset once more input is available.
+    // Stops early once the consumed offset reaches `stopAfter`.
+    std::size_t scanBuffer(const char* data, std::size_t size, bool final, std::size_t stopAfter);
+
+    // Index into fieldValues_ for a key, or -1 when it is not captured.
+    int capturedField(std::string_view key) const;
+
+    RecordSink& sink_;
+    unsigned fields_;
+    const RecordFilter* filter_;
+    // fields_ plus whatever the filter needs to see.
+    unsigned captured_;
+    int depth_{0};
+    int recordsDepth_{-1};
+    bool recordsKeyPending_{false};
+    bool inRecord_{false};
+    // Set once the filter has ruled out the current record.
+    bool rejected_{false};
+    ParsedRecord record_;
+    std::size_t emitted_{0};
+    std::size_t recordIndex_{0};
+    std::string carry_;
+    // Per-record values for context, backend, deviceName and thread_id,
+    // followed by the document-level backend and deviceName.
+    std::string fieldValues_[6];
+};
+
+} // namespace clamp::detail
@@ -1,16 +1,31 @@
 #include "clamp/TemporalAggregator.h"
 
+#include "../common/bounded_queue.h"
+#include "../common/parallel_for.h"
+#include "aggregate_cache.h"
+#include "aggregate_partial.h"
+#include "batch_reader.h"
+#include "compression.h"
+#include "group_table.h"
+#include "mapped_file.h"
+#include "partial_sink.h"
+#include "telemetry_scanner.h"
+#include "time_buckets.h"
+
 #include <algorithm>
-#include <cctype>
-#include <chrono>
 #include <cmath>
-#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <future>
 #include <iomanip>
 #include <limits>
 #include <optional>
-#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
 
 #if __has_include(<nlohmann/json.hpp>)
 #include <nlohmann/json.hpp>
@@ -22,146 +37,331 @@
 namespace clamp {
 namespace {
 
-struct ParsedRecord {
-    double stabilityScore{std::numeric_limits<double>::quiet_NaN()};
-    double timestampMs{std::numeric_limits<double>::quiet_NaN()};
-};
+using detail::FilePartial;
+using detail::GroupTable;
+using detail::PartialSink;
+using detail::SinkConfig;
 
-struct RunningStats {
-    void add(double value) {
-        ++count;
-        const double delta = value - mean;
-        mean += delta / static_cast<double>(count);
-        const double delta2 = value - mean;
-        m2 += delta * delta2;
+// Everything that changes what a cached partial contains.
+std::uint64_t cacheLayout(const SinkConfig& config) {
+    std::uint64_t layout = config.fields;
+    layout = layout * 1000003u ^ static_cast<std::uint64_t>(config.bucketWidthMs);
+    layout = layout * 1000003u ^ static_cast<std::uint64_t>(config.bucketWidthMs > 0 ? config.maxBuckets : 0);
+    return layout;
+}
+
+TemporalAggregator::GroupKey decodeGroupKey(std::string_view encoded) {
+    std::string* fields[4];
+    TemporalAggregator::GroupKey key;
+    fields[0] = &key.context;
+    fields[1] = &key.backend;
+    fields[2] = &key.deviceName;
+    fields[3] = &key.threadId;
+    for (std::string* field : fields) {
+        const auto separator = encoded.find(GroupTable::kKeySeparator);
+        field->assign(encoded.substr(0, separator));
+        encoded.remove_prefix(separator == std::string_view::npos ? encoded.size() : separator + 1);
     }
+    return key;
+}
 
-    double variance() const {
-        if (count < 2) {
-            return 0.0;
-        }
-        return m2 / static_cast<double>(count - 1);
+TemporalAggregator::Quantiles quantiles(const detail::TDigest& sketch) {
+    TemporalAggregator::Quantiles result;
+    if (sketch.empty()) {
+        return result;
     }
+    result.p50 = sketch.quantile(0.5);
+    result.p90 = sketch.quantile(0.9);
+    result.p99 = sketch.quantile(0.99);
+    result.p999 = sketch.quantile(0.999);
+    return result;
+}
 
-    double mean{0.0};
-    double m2{0.0};
-    std::size_t count{0};
-};
+void writeQuantiles(std::ostream& out, const char* name, const TemporalAggregator::Quantiles& values) {
+    out << "\"" << name << "\":{";
+    out << "\"p50\":" << values.p50 << ",";
+    out << "\"p90\":" << values.p90 << ",";
+    out << "\"p99\":" << values.p99 << ",";
+    out << "\"p999\":" << values.p999 << "}";
+}
 
-double parseIsoTimestampMs(const std::string& value) {
-    using namespace std::chrono;
-    std::istringstream stream(value);
-    sys_time<milliseconds> tp{};
-    stream >> std::chrono::parse("%FT%TZ", tp);
-    if (!stream.fail()) {
-        return static_cast<double>(tp.time_since_epoch().count());
-    }
-    stream.clear();
-    stream.str(value);
-    stream >> std::chrono::parse("%FT%T", tp);
-    if (!stream.fail()) {
-        return static_cast<double>(tp.time_since_epoch().count());
-    }
-    return std::numeric_limits<double>::quiet_NaN();
+double driftIndex(const detail::PartialStats& stats) {
+    if (stats.stability.count > 1 && std::isfinite(stats.minTimestamp) && std::isfinite(stats.maxTimestamp)) {
+        return stats.maxTimestamp - stats.minTimestamp;
+    }
+    return 0.0;
 }
 
-#if CLAMP_HAS_NLOHMANN_JSON
-std::vector<ParsedRecord> parseWithNlohmann(std::istream& stream) {
-    nlohmann::json data = nlohmann::json::parse(stream, nullptr, false);
-    if (data.is_discarded()) {
-        return {};
+// Large files are fed to the scanner in windows and the pages behind the
+// cursor are dropped, so resident memory stays flat however big the file is.
+constexpr std::size_t kScanWindowBytes = 8 * 1024 * 1024;
+
+// Decompressed chunks in flight between the decompression thread and the
+// scanner; bounds memory while letting inflate and parsing overlap.
+constexpr std::size_t kDecompressQueueDepth = 4;
+// Below this compressed size a helper thread costs more than it overlaps, so
+// the file is decompressed and scanned on the calling thread.
+constexpr std::uintmax_t kPipelineMinBytes = 256 * 1024;
+
+// Returns nothing when the archive is truncated or corrupt, so a partial
+// built from part of the file is never merged or cached.
+std::optional<FilePartial> summariseCompressed(const std::filesystem::path& path,
+                                               TelemetryCompression compression,
+                                               const SinkConfig& config) {
+    FilePartial partial;
+    PartialSink sink(partial, config);
+    detail::TelemetryScanner scanner(sink, config.fields, config.filter);
+    std::error_code ec;
+    if (std::filesystem::file_size(path, ec) < kPipelineMinBytes || ec) {
+        const bool complete = detail::decompressFile(path, compression, [&](std::string_view chunk) {
+            scanner.feed(chunk);
+            return true;
+        });
+        if (!complete) {
+            return std::nullopt;
+        }
+        scanner.finish();
+        sink.finish();
+        return partial;
     }
-    const auto* records = data.contains("records") ? data["records"].get_ptr<const nlohmann::json::array_t*>() : nullptr;
-    if (records == nullptr) {
-        return {};
+    detail::BoundedQueue<std::string> chunks(kDecompressQueueDepth);
+    bool complete = false;
+    std::thread decompressor([&] {
+        complete = detail::decompressFile(path, compression, [&](std::string_view chunk) {
+            return chunks.push(std::string(chunk));
+        });
+        chunks.close();
+    });
+    std::string chunk;
+    while (chunks.pop(chunk)) {
+        scanner.feed(chunk);
     }
-    std::vector<ParsedRecord> parsed;
-    parsed.reserve(records->size());
-    for (const auto& entry : *records) {
-        ParsedRecord record;
-        if (entry.contains("stability_score")) {
-            record.stabilityScore = entry["stability_score"].get<double>();
-        }
-        if (entry.contains("acquired_at") && entry["acquired_at"].is_string()) {
-            record.timestampMs = parseIsoTimestampMs(entry["acquired_at"].get<std::string>());
-        }
-        if (!std::isfinite(record.timestampMs)) {
-            record.timestampMs = static_cast<double>(parsed.size());
-        }
-        parsed.push_back(record);
+    decompressor.join();
+    if (!complete) {
+        return std::nullopt;
     }
-    return parsed;
+    scanner.finish();
+    sink.finish();
+    return partial;
 }
-#endif
 
-std::vector<ParsedRecord> parseFallback(std::istream& stream) {
-    std::vector<ParsedRecord> parsed;
-    std::string line;
-    ParsedRecord record;
-    bool inRecord = false;
-    while (std::getline(stream, line)) {
-        auto trimmed = line;
-        trimmed.erase(std::remove_if(trimmed.begin(), trimmed.end(), [](unsigned char ch) {
-            return std::isspace(ch);
-        }), trimmed.end());
-        if (trimmed.find('{') != std::string::npos) {
-            inRecord = true;
-            record = ParsedRecord{};
-        }
-        auto keyPos = trimmed.find("\"stability_score\"");
-        if (keyPos != std::string::npos) {
-            const auto colon = trimmed.find(':', keyPos + std::strlen("\"stability_score\""));
-            if (colon != std::string::npos) {
-                auto token = trimmed.substr(colon + 1);
-                std::size_t begin = 0;
-                while (begin < token.size() && std::isspace(static_cast<unsigned char>(token[begin]))) {
-                    ++begin;
-                }
-                std::size_t end = token.size();
-                while (end > begin && (std::isspace(static_cast<unsigned char>(token[end - 1])) ||
-                                        token[end - 1] == ',' || token[end - 1] == '}' || token[end - 1] == ']')) {
-                    --end;
+// Returns nothing for a file that cannot be opened or decompressed.
+std::optional<FilePartial> summariseFile(const std::filesystem::path& path, const SinkConfig& config) {
+    if (const auto compression = detail::compressionForPath(path); compression != TelemetryCompression::None) {
+        return summariseCompressed(path, compression, config);
+    }
+    detail::MappedFile file(path);
+    if (!file.isOpen()) {
+        return std::nullopt;
+    }
+    FilePartial partial;
+    PartialSink sink(partial, config);
+    detail::TelemetryScanner scanner(sink, config.fields, config.filter);
+    const std::string_view contents = file.view();
+    for (std::size_t offset = 0; offset < contents.size(); offset += kScanWindowBytes) {
+        scanner.feed(contents.substr(offset, kScanWindowBytes));
+        file.release(offset + kScanWindowBytes);
+    }
+    scanner.finish();
+    sink.finish();
+    return partial;
+}
+
+FilePartial summariseBuffer(std::string_view contents, const SinkConfig& config) {
+    FilePartial partial;
+    PartialSink sink(partial, config);
+    detail::TelemetryScanner::scan(contents, sink, config.fields, config.filter);
+    sink.finish();
+    return partial;
+}
+
+struct TelemetryFile {
+    std::filesystem::path path;
+    std::string cacheKey;
+    detail::FileIdentity identity;
+};
+
+// Glob match over '/'-separated paths: '*' and '?' never cross a '/', '**'
+// does, and "**/" also matches no directory at all.
+bool globMatch(std::string_view pattern, std::string_view text) {
+    while (!pattern.empty()) {
+        const char ch = pattern.front();
+        if (ch == '*') {
+            const bool anyDepth = pattern.size() > 1 && pattern[1] == '*';
+            const std::string_view rest = pattern.substr(anyDepth ? 2 : 1);
+            if (anyDepth && !rest.empty() && rest.front() == '/' && globMatch(rest.substr(1), text)) {
+                return true;
+            }
+            for (std::size_t i = 0;; ++i) {
+                if (globMatch(rest, text.substr(i))) {
+                    return true;
                 }
-                if (begin < end) {
-                    try {
-                        record.stabilityScore = std::stod(token.substr(begin, end - begin));
-                    } catch (...) {
-                    }
+                if (i == text.size() || (!anyDepth && text[i] == '/')) {
+                    return false;
                 }
             }
         }
-        keyPos = trimmed.find("\"acquired_at\"");
-        if (keyPos != std::string::npos) {
-            const auto colon = trimmed.find(':', keyPos + std::strlen("\"acquired_at\""));
-            if (colon != std::string::npos) {
-                auto firstQuote = trimmed.find('"', colon);
-                auto secondQuote = trimmed.find('"', firstQuote + 1);
-                if (firstQuote != std::string::npos && secondQuote != std::string::npos) {
-                    record.timestampMs = parseIsoTimestampMs(trimmed.substr(firstQuote + 1, secondQuote - firstQuote - 1));
+        if (text.empty()) {
+            return false;
+        }
+        const auto classEnd = ch == '[' ? pattern.find(']', 2) : std::string_view::npos;
+        if (ch == '?') {
+            if (text.front() == '/') {
+                return false;
+            }
+        } else if (classEnd != std::string_view::npos) {
+            const bool negated = pattern[1] == '!' || pattern[1] == '^';
+            const std::string_view members = pattern.substr(negated ? 2 : 1, classEnd - (negated ? 2 : 1));
+            bool matched = false;
+            for (std::size_t i = 0; i < members.size(); ++i) {
+                if (i + 2 < members.size() && members[i + 1] == '-') {
+                    matched = matched || (text.front() >= members[i] && text.front() <= members[i + 2]);
+                    i += 2;
+                } else {
+                    matched = matched || text.front() == members[i];
                 }
             }
+            if (matched == negated || text.front() == '/') {
+                return false;
+            }
+            pattern.remove_prefix(classEnd);
+        } else if (ch != text.front()) {
+            return false;
+        }
+        pattern.remove_prefix(1);
+        text.remove_prefix(1);
+    }
+    return text.empty();
+}
+
+bool matchesAny(const std::vector<std::string>& patterns, std::string_view relative, std::string_view name) {
+    return std::any_of(patterns.begin(), patterns.end(), [&](const std::string& pattern) {
+        return globMatch(pattern, pattern.find('/') == std::string::npos ? name : relative);
+    });
+}
+
+// Whether the query narrows the file set, so other files' cache entries must
+// be kept rather than dropped as deleted.
+bool selectsSubset(const TemporalAggregator::Query& query) {
+    return query.recursive || !query.include.empty() || !query.exclude.empty();
+}
+
+detail::RecordFilter recordFilter(const TemporalAggregator::Query& query) {
+    detail::RecordFilter filter;
+    filter.windowed = query.fromMs.has_value() || query.toMs.has_value();
+    if (query.fromMs) {
+        filter.fromMs = static_cast<double>(*query.fromMs);
+    }
+    if (query.toMs) {
+        filter.toMs = static_cast<double>(*query.toMs);
+    }
+    filter.contexts = query.contexts;
+    filter.backends = query.backends;
+    return filter;
+}
+
+std::vector<TelemetryFile> listTelemetryFiles(const std::filesystem::path& telemetryDir,
+                                              const TemporalAggregator::Query& query,
+                                              bool withIdentity) {
+    std::vector<TelemetryFile> files;
+    const detail::DirectoryStat directory(telemetryDir);
+    // `relative` uses '/' separators, so the file name is what follows the last.
+    auto consider = [&](const std::filesystem::directory_entry& entry, std::string relative) {
+        if (!entry.is_regular_file()) {
+            return;
+        }
+        const std::string_view name = std::string_view(relative).substr(relative.rfind('/') + 1);
+        // Compressed files are listed only when their codec was built in.
+        const auto compression = detail::compressionForPath(entry.path());
+        if (compression == TelemetryCompression::None
+                ? name.size() <= 5 || name.substr(name.size() - 5) != ".json"
+                : !detail::compressionSupported(compression)) {
+            return;
         }
-        if (trimmed.find('}') != std::string::npos && inRecord) {
-            inRecord = false;
-            if (!std::isfinite(record.timestampMs)) {
-                record.timestampMs = static_cast<double>(parsed.size());
+        if ((!query.include.empty() && !matchesAny(query.include, relative, name)) ||
+            matchesAny(query.exclude, relative, name)) {
+            return;
+        }
+        TelemetryFile file;
+        file.path = entry.path();
+        if (withIdentity && !directory.identity(relative, file.identity)) {
+            return;
+        }
+        // Relative paths keep top-level keys identical to file names.
+        file.cacheKey = std::move(relative);
+        files.push_back(std::move(file));
+    };
+
+    if (query.recursive) {
+        std::error_code ec;
+        std::filesystem::recursive_directory_iterator it(
+            telemetryDir, std::filesystem::directory_options::skip_permission_denied, ec);
+        for (; !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+            std::string relative = it->path().lexically_relative(telemetryDir).generic_string();
+            if (it->is_directory(ec)) {
+                const std::string name = it->path().filename().string();
+                if (matchesAny(query.exclude, relative + "/", name)) {
+                    it.disable_recursion_pending();
+                }
+                continue;
             }
-            parsed.push_back(record);
+            consider(*it, std::move(relative));
+        }
+    } else {
+        for (const auto& entry : std::filesystem::directory_iterator(telemetryDir)) {
+            consider(entry, entry.path().filename().string());
         }
     }
-    return parsed;
+    // Every key is relative to the same directory, so this is path order.
+    std::sort(files.begin(), files.end(), [](const TelemetryFile& lhs, const TelemetryFile& rhs) {
+        return lhs.cacheKey < rhs.cacheKey;
+    });
+    return files;
 }
 
-std::vector<ParsedRecord> parseTelemetryFile(const std::filesystem::path& path) {
-    std::ifstream in(path);
-    if (!in.is_open()) {
-        return {};
+// Number of files whose contents are held in memory per batch; the next batch
+// is read while the current one is parsed. partials[i] receives pending[i].
+constexpr std::size_t kReadBatchFiles = 256;
+
+void summariseBatched(const std::vector<TelemetryFile>& files,
+                      const std::vector<std::size_t>& pending,
+                      std::size_t workerCount,
+                      const SinkConfig& config,
+                      std::vector<std::optional<FilePartial>>& partials) {
+    detail::BatchFileReader reader(workerCount);
+    auto readBatch = [&](std::size_t begin) {
+        std::vector<std::filesystem::path> paths;
+        const std::size_t end = std::min(pending.size(), begin + kReadBatchFiles);
+        for (std::size_t i = begin; i < end; ++i) {
+            paths.push_back(files[pending[i]].path);
+        }
+        return reader.read(paths);
+    };
+
+    std::vector<detail::FileBuffer> current = readBatch(0);
+    for (std::size_t begin = 0; begin < pending.size(); begin += kReadBatchFiles) {
+        const std::size_t next = begin + kReadBatchFiles;
+        std::future<std::vector<detail::FileBuffer>> prefetch;
+        if (next < pending.size()) {
+            prefetch = std::async(std::launch::async, readBatch, next);
+        }
+        detail::parallelFor(current.size(), workerCount, [&](std::size_t index) {
+            auto& buffer = current[index];
+            auto& partial = partials[begin + index];
+            if (buffer.status == detail::FileBuffer::Status::Ok) {
+                partial = summariseBuffer(buffer.data, config);
+            } else {
+                // Oversized files are streamed; one the batch failed to read
+                // gets a second attempt through the per-file path rather than
+                // an empty partial that the cache would keep.
+                partial = summariseFile(files[pending[begin + index]].path, config);
+            }
+            std::string().swap(buffer.data);
+        });
+        if (prefetch.valid()) {
+            current = prefetch.get();
+        }
     }
-#if CLAMP_HAS_NLOHMANN_JSON
-    return parseWithNlohmann(in);
-#else
-    return parseFallback(in);
-#endif
 }
 
 struct BuildInfo {
@@ -176,12 +376,13 @@ std::optional<BuildInfo> loadBuildInfo(const std::filesystem::path& snapshotPath
     if (snapshotPath.empty() || !std::filesystem::exists(snapshotPath)) {
         return std::nullopt;
     }
-    std::ifstream in(snapshotPath);
-    if (!in.is_open()) {
+    const detail::MappedFile file(snapshotPath);
+    if (!file.isOpen()) {
         return std::nullopt;
     }
+    const std::string_view json = file.view();
 #if CLAMP_HAS_NLOHMANN_JSON
-    nlohmann::json data = nlohmann::json::parse(in, nullptr, false);
+    nlohmann::json data = nlohmann::json::parse(json.begin(), json.end(), nullptr, false);
     if (data.is_discarded()) {
         return std::nullopt;
     }
@@ -196,25 +397,24 @@ std::optional<BuildInfo> loadBuildInfo(const std::filesystem::path& snapshotPath
     }
     return info;
 #else
-    std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
-    auto readString = [&json](const std::string& key) -> std::string {
+    auto readString = [json](std::string_view key) -> std::string {
         const auto pos = json.find(key);
-        if (pos == std::string::npos) {
+        if (pos == std::string_view::npos) {
             return {};
         }
         const auto colon = json.find(':', pos);
-        if (colon == std::string::npos) {
+        if (colon == std::string_view::npos) {
             return {};
         }
         auto firstQuote = json.find('"', colon);
-        if (firstQuote == std::string::npos) {
+        if (firstQuote == std::string_view::npos) {
             return {};
         }
         auto secondQuote = json.find('"', firstQuote + 1);
-        if (secondQuote == std::string::npos) {
+        if (secondQuote == std::string_view::npos) {
             return {};
         }
-        return json.substr(firstQuote + 1, secondQuote - firstQuote - 1);
+        return std::string(json.substr(firstQuote + 1, secondQuote - firstQuote - 1));
     };
     BuildInfo info;
     info.image = readString("\"image\"");
@@ -242,39 +442,225 @@ std::filesystem::path resolveSnapshotPath(const std::filesystem::path& overrideP
 
 } // namespace
 
+namespace detail {
+
+TemporalAggregator::Summary buildSummary(const PartialStats& total,
+                                         const std::vector<GroupTable::Entry>& groups,
+                                         const TimeBuckets& timeline) {
+    TemporalAggregator::Summary summary;
+    summary.sessionCount = total.stability.count;
+    summary.meanStability = total.stability.mean;
+    summary.stabilityVariance = total.stability.variance();
+    summary.driftIndex = driftIndex(total);
+    summary.stabilityQuantiles = quantiles(total.stabilitySketch);
+    summary.durationQuantiles = quantiles(total.durationSketch);
+
+    summary.groups.reserve(groups.size());
+    for (const auto& [key, stats] : groups) {
+        TemporalAggregator::GroupSummary group;
+        group.key = decodeGroupKey(key);
+        group.sessionCount = stats.stability.count;
+        group.meanStability = stats.stability.mean;
+        group.stabilityVariance = stats.stability.variance();
+        group.driftIndex = driftIndex(stats);
+        group.stabilityQuantiles = quantiles(stats.stabilitySketch);
+        group.durationQuantiles = quantiles(stats.durationSketch);
+        summary.groups.push_back(std::move(group));
+    }
+    std::sort(summary.groups.begin(), summary.groups.end(),
+              [](const TemporalAggregator::GroupSummary& lhs, const TemporalAggregator::GroupSummary& rhs) {
+                  return std::tie(lhs.key.context, lhs.key.backend, lhs.key.deviceName, lhs.key.threadId) <
+                         std::tie(rhs.key.context, rhs.key.backend, rhs.key.deviceName, rhs.key.threadId);
+              });
+
+    summary.bucketWidthMs = timeline.widthMs();
+    summary.timeBuckets.reserve(timeline.buckets().size());
+    for (const auto& [key, stats] : timeline.buckets()) {
+        TemporalAggregator::TimeBucket bucket;
+        bucket.startMs = key * timeline.widthMs();
+        bucket.sessionCount = stats.stability.count;
+        bucket.meanStability = stats.stability.mean;
+        bucket.stabilityVariance = stats.stability.variance();
+        bucket.meanDurationMs = stats.duration.mean;
+        bucket.durationVariance = stats.duration.variance();
+        bucket.stabilityQuantiles = quantiles(stats.stabilitySketch);
+        bucket.durationQuantiles = quantiles(stats.durationSketch);
+        summary.timeBuckets.push_back(bucket);
+    }
+    return summary;
+}
+
+} // namespace detail
+
+TemporalAggregator::TemporalAggregator(Options options)
+    : options_(options) {}
+
 TemporalAggregator::Summary TemporalAggregator::aggregate(const std::filesystem::path& telemetryDir) {
-    Summary summary;
+    return aggregate(telemetryDir, Query{});
+}
+
+TemporalAggregator::Summary TemporalAggregator::aggregate(const std::filesystem::path& telemetryDir,
+                                                          const Query& query) {
     if (!std::filesystem::exists(telemetryDir)) {
-        return summary;
+        return {};
+    }
+
+    const auto files = listTelemetryFiles(telemetryDir, query, options_.incremental);
+    // Files to parse, and files whose cached partial is current.
+    std::vector<std::size_t> pending;
+    std::vector<std::size_t> cachedFiles;
+    pending.reserve(files.size());
+
+    const detail::RecordFilter filter = recordFilter(query);
+    SinkConfig config = detail::sinkConfig(options_);
+    if (filter.active()) {
+        config.filter = &filter;
+    }
+    detail::AggregateCache cache(cacheLayout(config));
+    const auto cachePath = options_.cachePath.empty() ? defaultCachePath(telemetryDir) : options_.cachePath;
+    // Whether the cached rollup is exactly the merge of cachedFiles, so they
+    // need not be read one by one.
+    bool useRollup = false;
+    if (options_.incremental) {
+        cache.load(cachePath);
+        for (std::size_t i = 0; i < files.size(); ++i) {
+            const auto* cached = cache.lookup(files[i].cacheKey, files[i].identity);
+            if (cached != nullptr && filter.windowed &&
+                (cached->maxTimestamp < filter.fromMs || cached->minTimestamp >= filter.toMs)) {
+                // No record of this file can fall inside the window.
+                continue;
+            }
+            if (cached != nullptr && !filter.active()) {
+                cachedFiles.push_back(i);
+            } else {
+                pending.push_back(i);
+            }
+        }
+        useRollup = !filter.active() && cache.rollup() != nullptr && cachedFiles.size() == cache.size();
+    } else {
+        for (std::size_t i = 0; i < files.size(); ++i) {
+            pending.push_back(i);
+        }
     }
 
-    RunningStats stats;
-    double minTimestamp = std::numeric_limits<double>::infinity();
-    double maxTimestamp = -std::numeric_limits<double>::infinity();
+    // An empty slot is a file that could not be read; it is neither merged
+    // nor cached.
+    std::vector<std::optional<FilePartial>> parsed(pending.size());
+    if (options_.batchedIo) {
+        // Compressed files stream through their own decompression thread
+        // rather than being read whole.
+        std::vector<std::size_t> plain;
+        std::vector<std::size_t> plainSlots;
+        std::vector<std::size_t> compressed;
+        for (std::size_t slot = 0; slot < pending.size(); ++slot) {
+            if (detail::compressionForPath(files[pending[slot]].path) == TelemetryCompression::None) {
+                plain.push_back(pending[slot]);
+                plainSlots.push_back(slot);
+            } else {
+                compressed.push_back(slot);
+            }
+        }
+        std::vector<std::optional<FilePartial>> plainPartials(plain.size());
+        summariseBatched(files, plain, options_.workerCount, config, plainPartials);
+        for (std::size_t i = 0; i < plain.size(); ++i) {
+            parsed[plainSlots[i]] = std::move(plainPartials[i]);
+        }
+        detail::parallelFor(compressed.size(), options_.workerCount, [&](std::size_t index) {
+            parsed[compressed[index]] = summariseFile(files[pending[compressed[index]]].path, config);
+        });
+    } else {
+        detail::parallelFor(pending.size(), options_.workerCount, [&](std::size_t index) {
+            parsed[index] = summariseFile(files[pending[index]].path, config);
+        });
+    }
 
-    for (const auto& entry : std::filesystem::directory_iterator(telemetryDir)) {
-        if (!entry.is_regular_file() || entry.path().extension() != ".json") {
-            continue;
+    FilePartial total;
+    total.timeline = detail::TimeBuckets(config.bucketWidthMs, config.maxBuckets);
+    GroupTable groups;
+    auto mergePartial = [&](const FilePartial& partial) {
+        total.merge(partial);
+        total.timeline.merge(partial.timeline);
+        for (const auto& [key, stats] : partial.groups) {
+            groups.at(key).merge(stats);
         }
-        auto records = parseTelemetryFile(entry.path());
-        for (const auto& record : records) {
-            if (std::isfinite(record.stabilityScore)) {
-                stats.add(record.stabilityScore);
+    };
+    if (useRollup) {
+        // New files are merged after the rollup, so the result can differ from
+        // a full aggregate in the last bits of the mean and variance.
+        const FilePartial& rollup = *cache.rollup();
+        static_cast<detail::PartialStats&>(total) = rollup;
+        total.timeline.merge(rollup.timeline);
+        for (const auto& [key, stats] : rollup.groups) {
+            groups.at(key) = stats;
+        }
+        for (const auto& partial : parsed) {
+            if (partial) {
+                mergePartial(*partial);
             }
-            if (std::isfinite(record.timestampMs)) {
-                minTimestamp = std::min(minTimestamp, record.timestampMs);
-                maxTimestamp = std::max(maxTimestamp, record.timestampMs);
+        }
+    } else {
+        std::vector<FilePartial> cachedPartials(cachedFiles.size());
+        detail::parallelFor(cachedFiles.size(), options_.workerCount, [&](std::size_t index) {
+            cache.read(files[cachedFiles[index]].cacheKey, cachedPartials[index]);
+        });
+        // Merge in file order so the result does not depend on the cache.
+        std::size_t nextCached = 0;
+        std::size_t nextParsed = 0;
+        while (nextCached < cachedFiles.size() || nextParsed < pending.size()) {
+            if (nextParsed == pending.size() ||
+                (nextCached < cachedFiles.size() && cachedFiles[nextCached] < pending[nextParsed])) {
+                mergePartial(cachedPartials[nextCached++]);
+            } else if (const auto& partial = parsed[nextParsed++]) {
+                mergePartial(*partial);
             }
         }
     }
 
-    summary.sessionCount = stats.count;
-    summary.meanStability = stats.mean;
-    summary.stabilityVariance = stats.variance();
-    if (stats.count > 1 && std::isfinite(minTimestamp) && std::isfinite(maxTimestamp)) {
-        summary.driftIndex = maxTimestamp - minTimestamp;
+    if (options_.incremental) {
+        // The cache only holds unfiltered partials. A query over a subset of
+        // the files keeps other files' entries; otherwise entries for deleted
+        // files are dropped.
+        if (!filter.active()) {
+            for (std::size_t slot = 0; slot < pending.size(); ++slot) {
+                if (parsed[slot]) {
+                    cache.store(files[pending[slot]].cacheKey, files[pending[slot]].identity, *parsed[slot]);
+                }
+            }
+        }
+        // An unreadable file also loses any entry left from an older version,
+        // so it is parsed again next time and no rollup claims to cover it.
+        std::unordered_set<std::string_view> unreadable;
+        for (std::size_t slot = 0; slot < pending.size(); ++slot) {
+            if (!parsed[slot]) {
+                unreadable.insert(files[pending[slot]].cacheKey);
+            }
+        }
+        if (!unreadable.empty()) {
+            cache.retain([&](const std::string& key) { return unreadable.count(key) == 0; });
+        }
+        if (!selectsSubset(query) && files.size() != cache.size()) {
+            std::unordered_set<std::string_view> listed;
+            listed.reserve(files.size());
+            for (const auto& file : files) {
+                listed.insert(file.cacheKey);
+            }
+            cache.retain([&](const std::string& key) { return listed.count(key) != 0; });
+        }
+        if (!filter.active() && files.size() == cache.size()) {
+            // Every live entry was merged: the total becomes the rollup.
+            total.groups = groups.entries();
+            cache.save(cachePath, &total);
+            total.groups.clear();
+        } else {
+            cache.save(cachePath, nullptr);
+        }
     }
-    return summary;
+
+    return detail::buildSummary(total, groups.entries(), total.timeline);
+}
+
+std::filesystem::path TemporalAggregator::defaultCachePath(const std::filesystem::path& telemetryDir) {
+    return telemetryDir / ".clamp_aggregate.cache";
 }
 
 bool TemporalAggregator::writeSummary(const Summary& summary,
@@ -300,7 +686,39 @@ bool TemporalAggregator::writeSummary(const Summary& summary,
     out << "\"session_count\":" << summary.sessionCount << ",";
     out << "\"mean_stability\":" << summary.meanStability << ",";
     out << "\"stability_variance\":" << summary.stabilityVariance << ",";
-    out << "\"drift_index\":" << summary.driftIndex;
+    out << "\"drift_index\":" << summary.driftIndex << ",";
+    writeQuantiles(out, "stability_quantiles", summary.stabilityQuantiles);
+    out << ",";
+    writeQuantiles(out, "duration_ms_quantiles", summary.durationQuantiles);
+
+    if (!summary.groups.empty()) {
+        out << ",\"groups\":[";
+        for (std::size_t i = 0; i < summary.groups.size(); ++i) {
+            const auto& group = summary.groups[i];
+            out << (i == 0 ? "" : ",") << "{";
+            if (options_.groupBy.context || !group.key.context.empty()) {
+                out << "\"context\":\"" << group.key.context << "\",";
+            }
+            if (options_.groupBy.backend || !group.key.backend.empty()) {
+                out << "\"backend\":\"" << group.key.backend << "\",";
+            }
+            if (options_.groupBy.deviceName || !group.key.deviceName.empty()) {
+                out << "\"device_name\":\"" << group.key.deviceName << "\",";
+            }
+            if (options_.groupBy.threadId || !group.key.threadId.empty()) {
+                out << "\"thread_id\":\"" << group.key.threadId << "\",";
+            }
+            out << "\"session_count\":" << group.sessionCount << ",";
+            out << "\"mean_stability\":" << group.meanStability << ",";
+            out << "\"stability_variance\":" << group.stabilityVariance << ",";
+            out << "\"drift_index\":" << group.driftIndex << ",";
+            writeQuantiles(out, "stability_quantiles", group.stabilityQuantiles);
+            out << ",";
+            writeQuantiles(out, "duration_ms_quantiles", group.durationQuantiles);
+            out << "}";
+        }
+        out << "]";
+    }
 
     if (buildInfo) {
         out << ",\"build_info\":{";
@@ -324,4 +742,44 @@ bool TemporalAggregator::writeSummary(const Summary& summary,
     return out.good();
 }
 
+bool TemporalAggregator::writeTimeSeries(const Summary& summary, const std::filesystem::path& outputPath) const {
+    std::error_code ec;
+    const auto parent = outputPath.parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, ec);
+    }
+
+    std::ofstream out(outputPath);
+    if (!out.is_open()) {
+        return false;
+    }
+
+    const auto& buckets = summary.timeBuckets;
+    auto column = [&](const char* name, auto value) {
+        out << ",\"" << name << "\":[";
+        for (std::size_t i = 0; i < buckets.size(); ++i) {
+            out << (i == 0 ? "" : ",") << value(buckets[i]);
+        }
+        out << "]";
+    };
+
+    out << std::setprecision(9);
+    out << "{\"bucket_width_ms\":" << summary.bucketWidthMs;
+    out << ",\"bucket_count\":" << buckets.size();
+    column("start_ms", [](const TimeBucket& bucket) { return bucket.startMs; });
+    column("session_count", [](const TimeBucket& bucket) { return bucket.sessionCount; });
+    column("mean_stability", [](const TimeBucket& bucket) { return bucket.meanStability; });
+    column("stability_variance", [](const TimeBucket& bucket) { return bucket.stabilityVariance; });
+    column("stability_p50", [](const TimeBucket& bucket) { return bucket.stabilityQuantiles.p50; });
+    column("stability_p90", [](const TimeBucket& bucket) { return bucket.stabilityQuantiles.p90; });
+    column("stability_p99", [](const TimeBucket& bucket) { return bucket.stabilityQuantiles.p99; });
+    column("mean_duration_ms", [](const TimeBucket& bucket) { return bucket.meanDurationMs; });
+    column("duration_variance", [](const TimeBucket& bucket) { return bucket.durationVariance; });
+    column("duration_p50", [](const TimeBucket& bucket) { return bucket.durationQuantiles.p50; });
+    column("duration_p90", [](const TimeBucket& bucket) { return bucket.durationQuantiles.p90; });
+    column("duration_p99", [](const TimeBucket& bucket) { return bucket.durationQuantiles.p99; });
+    out << "}\n";
+    return out.good();
+}
+
 } // namespace clamp
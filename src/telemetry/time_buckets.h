@@ -0,0 +1,123 @@
+#pragma once
+
+#include "partial_stats.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+
+namespace clamp::detail {
+
+// Fixed-width time buckets keyed by floor(timestamp / width), so bucket
+// boundaries are aligned to the epoch and identical across files. When the map
+// would exceed `maxBuckets` the width doubles and neighbouring buckets merge;
+// every width is therefore the configured width times a power of two, and
+// bucket sets built at different widths can still be merged exactly.
+class TimeBuckets {
+public:
+    using Map = std::map<std::int64_t, PartialStats>;
+
+    TimeBuckets() = default;
+    TimeBuckets(std::int64_t widthMs, std::size_t maxBuckets)
+        : widthMs_(widthMs), maxBuckets_(maxBuckets < 2 ? 2 : maxBuckets) {}
+
+    bool enabled() const { return widthMs_ > 0; }
+    std::int64_t widthMs() const { return widthMs_; }
+    std::size_t maxBuckets() const { return maxBuckets_; }
+    const Map& buckets() const { return buckets_; }
+
+    void add(double timestampMs, double stabilityScore, double durationMs) {
+        const auto key = static_cast<std::int64_t>(std::floor(timestampMs / static_cast<double>(widthMs_)));
+        // Records mostly arrive in time order, so remember the last bucket.
+        if (last_ == nullptr || key != lastKey_) {
+            auto [it, inserted] = buckets_.try_emplace(key);
+            if (inserted && buckets_.size() > maxBuckets_) {
+                coarsen();
+                add(timestampMs, stabilityScore, durationMs);
+                return;
+            }
+            last_ = &it->second;
+            lastKey_ = key;
+        }
+        last_->add(stabilityScore, timestampMs, durationMs);
+    }
+
+    void merge(const TimeBuckets& other) {
+        if (!other.enabled() || other.buckets_.empty()) {
+            return;
+        }
+        if (!enabled()) {
+            *this = other;
+            return;
+        }
+        while (widthMs_ < other.widthMs_) {
+            coarsen();
+        }
+        const std::int64_t factor = widthMs_ / other.widthMs_;
+        for (const auto& [key, stats] : other.buckets_) {
+            buckets_[floorDiv(key, factor)].merge(stats);
+        }
+        while (buckets_.size() > maxBuckets_) {
+            coarsen();
+        }
+        last_ = nullptr;
+    }
+
+    void compress() {
+        for (auto& [key, stats] : buckets_) {
+            stats.compress();
+        }
+    }
+
+    // Used when restoring from the aggregate cache.
+    void assign(std::int64_t widthMs, Map buckets) {
+        widthMs_ = widthMs;
+        buckets_ = std::move(buckets);
+        last_ = nullptr;
+    }
+
+    TimeBuckets(const TimeBuckets& other)
+        : widthMs_(other.widthMs_), maxBuckets_(other.maxBuckets_), buckets_(other.buckets_) {}
+    TimeBuckets& operator=(const TimeBuckets& other) {
+        widthMs_ = other.widthMs_;
+        maxBuckets_ = other.maxBuckets_;
+        buckets_ = other.buckets_;
+        last_ = nullptr;
+        return *this;
+    }
+    TimeBuckets(TimeBuckets&& other) noexcept
+        : widthMs_(other.widthMs_), maxBuckets_(other.maxBuckets_), buckets_(std::move(other.buckets_)) {}
+    TimeBuckets& operator=(TimeBuckets&& other) noexcept {
+        widthMs_ = other.widthMs_;
+        maxBuckets_ = other.maxBuckets_;
+        buckets_ = std::move(other.buckets_);
+        last_ = nullptr;
+        return *this;
+    }
+
+private:
+    static std::int64_t floorDiv(std::int64_t value, std::int64_t divisor) {
+        const std::int64_t quotient = value / divisor;
+        return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+    }
+
+    void coarsen() {
+        Map coarser;
+        for (auto& [key, stats] : buckets_) {
+            coarser[floorDiv(key, 2)].merge(stats);
+        }
+        buckets_ = std::move(coarser);
+        widthMs_ *= 2;
+        last_ = nullptr;
+    }
+
+    std::int64_t widthMs_{0};
+    std::size_t maxBuckets_{0};
+    Map buckets_;
+    PartialStats* last_{nullptr};
+    std::int64_t lastKey_{0};
+};
+
+} // namespace clamp::detail
@@ -1,18 +1,33 @@
+#include "clamp/AggregationDaemon.h"
+#include "clamp/EntropyTelemetry.h"
 #include "clamp/TemporalAggregator.h"
+#include "telemetry/aggregate_cache.h"
+#include "telemetry/batch_reader.h"
+#include "telemetry/compression.h"
+#include "telemetry/quantile_sketch.h"
+#include "telemetry/telemetry_scanner.h"
 
 #include <cassert>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 namespace {
 
 void writeTelemetryFile(const std::filesystem::path& path,
-                        std::initializer_list<std::pair<double, double>> values) {
+                        std::initializer_list<std::pair<double, double>> values,
+                        std::initializer_list<const char*> acquiredAt = {}) {
     std::filesystem::create_directories(path.parent_path());
     std::ofstream out(path);
     out << "{\n  \"records\": [\n";
     bool first = true;
+    auto stamp = acquiredAt.begin();
     for (const auto& [stability, duration] : values) {
         if (!first) {
             out << ",\n";
@@ -22,7 +37,8 @@ void writeTelemetryFile(const std::filesystem::path& path,
             << "      \"context\": \"test\",\n"
             << "      \"seed\": 1,\n"
             << "      \"thread_id\": \"0\",\n"
-            << "      \"acquired_at\": \"2025-01-01T00:00:00Z\",\n"
+            << "      \"acquired_at\": \"" << (stamp != acquiredAt.end() ? *stamp++ : "2025-01-01T00:00:00Z")
+            << "\",\n"
             << "      \"released_at\": \"2025-01-01T00:00:01Z\",\n"
             << "      \"duration_ms\": " << duration << ",\n"
             << "      \"stability_score\": " << stability << "\n"
@@ -31,6 +47,716 @@ void writeTelemetryFile(const std::filesystem::path& path,
     out << "\n  ]\n}\n";
 }
 
+void validate_worker_invariance(const std::filesystem::path& baseDir) {
+    const auto parallelDir = baseDir / "parallel";
+    for (int file = 0; file < 12; ++file) {
+        const double offset = static_cast<double>(file) / 40.0;
+        writeTelemetryFile(parallelDir / ("run_" + std::to_string(file) + ".json"),
+                           {{0.55 + offset, 3.0}, {0.9 - offset, 4.5}, {0.71, 2.0 + offset}});
+    }
+
+    const auto serial = clamp::TemporalAggregator({1}).aggregate(parallelDir);
+    assert(serial.sessionCount == 36);
+    for (const std::size_t workers : {2, 3, 8}) {
+        const auto parallel = clamp::TemporalAggregator({workers}).aggregate(parallelDir);
+        assert(parallel.sessionCount == serial.sessionCount);
+        assert(parallel.meanStability == serial.meanStability);
+        assert(parallel.stabilityVariance == serial.stabilityVariance);
+        assert(parallel.driftIndex == serial.driftIndex);
+    }
+}
+
+bool sameSummary(const clamp::TemporalAggregator::Summary& lhs, const clamp::TemporalAggregator::Summary& rhs) {
+    return lhs.sessionCount == rhs.sessionCount && lhs.meanStability == rhs.meanStability &&
+           lhs.stabilityVariance == rhs.stabilityVariance && lhs.driftIndex == rhs.driftIndex &&
+           lhs.durationQuantiles.p50 == rhs.durationQuantiles.p50 &&
+           lhs.durationQuantiles.p999 == rhs.durationQuantiles.p999 &&
+           lhs.stabilityQuantiles.p99 == rhs.stabilityQuantiles.p99;
+}
+
+void validate_incremental_cache(const std::filesystem::path& baseDir) {
+    const auto cacheDir = baseDir / "incremental";
+    writeTelemetryFile(cacheDir / "a.json", {{0.9, 1.0}, {0.8, 2.0}});
+    writeTelemetryFile(cacheDir / "b.json", {{0.4, 3.0}});
+
+    clamp::TemporalAggregator::Options options;
+    options.incremental = true;
+    clamp::TemporalAggregator cached(options);
+    clamp::TemporalAggregator uncached;
+
+    const auto first = cached.aggregate(cacheDir);
+    assert(std::filesystem::exists(clamp::TemporalAggregator::defaultCachePath(cacheDir)));
+    assert(sameSummary(first, uncached.aggregate(cacheDir)));
+    assert(sameSummary(cached.aggregate(cacheDir), first));
+
+    writeTelemetryFile(cacheDir / "b.json", {{0.2, 3.0}, {0.3, 1.0}, {0.1, 2.0}});
+    writeTelemetryFile(cacheDir / "c.json", {{0.7, 4.0}});
+    const auto changed = cached.aggregate(cacheDir);
+    assert(changed.sessionCount == 6);
+    assert(sameSummary(changed, uncached.aggregate(cacheDir)));
+
+    std::filesystem::remove(cacheDir / "a.json");
+    const auto removed = cached.aggregate(cacheDir);
+    assert(removed.sessionCount == 4);
+    assert(sameSummary(removed, uncached.aggregate(cacheDir)));
+
+    // A new file is merged onto the cached rollup and appended to the cache
+    // in place; only rounding may separate it from a full aggregate.
+    const auto cachePath = clamp::TemporalAggregator::defaultCachePath(cacheDir);
+    clamp::detail::FileIdentity before;
+    assert(clamp::detail::statFileIdentity(cachePath, before));
+    writeTelemetryFile(cacheDir / "d.json", {{0.65, 2.5}});
+    const auto added = cached.aggregate(cacheDir);
+    const auto full = uncached.aggregate(cacheDir);
+    assert(added.sessionCount == 5);
+    assert(std::abs(added.meanStability - full.meanStability) < 1e-12);
+    assert(std::abs(added.stabilityVariance - full.stabilityVariance) < 1e-12);
+    assert(added.driftIndex == full.driftIndex);
+    assert(added.durationQuantiles.p50 == full.durationQuantiles.p50);
+    clamp::detail::FileIdentity after;
+    assert(clamp::detail::statFileIdentity(cachePath, after));
+    assert(after.inode == before.inode && after.size > before.size);
+    assert(sameSummary(cached.aggregate(cacheDir), added));
+}
+
+clamp::detail::FilePartial partialOf(std::initializer_list<double> scores) {
+    clamp::detail::FilePartial partial;
+    double timestamp = 0.0;
+    for (const double score : scores) {
+        partial.add(score, timestamp, 2.0 * score);
+        timestamp += 1000.0;
+    }
+    partial.compress();
+    return partial;
+}
+
+void validate_cache_log(const std::filesystem::path& baseDir) {
+    using clamp::detail::AggregateCache;
+    using clamp::detail::FileIdentity;
+    using clamp::detail::FilePartial;
+    std::filesystem::create_directories(baseDir);
+    const auto path = baseDir / "log.cache";
+    std::filesystem::remove(path);
+
+    AggregateCache cache(7);
+    FilePartial rollup;
+    for (int i = 0; i < 3; ++i) {
+        const auto partial = partialOf({0.1 * i, 0.5});
+        cache.store("f" + std::to_string(i), FileIdentity{static_cast<std::uint64_t>(i)}, partial);
+        rollup.merge(partial);
+    }
+    assert(cache.save(path, &rollup));
+
+    // The rollup is current until the live set changes.
+    AggregateCache loaded(7);
+    loaded.load(path);
+    assert(loaded.size() == 3 && loaded.rollup() != nullptr);
+    assert(loaded.rollup()->stability.count == 6);
+    assert(loaded.lookup("f1", FileIdentity{1}) != nullptr && loaded.lookup("f1", FileIdentity{2}) == nullptr);
+    FilePartial decoded;
+    assert(loaded.read("f2", decoded) && decoded.stability.count == 2 && decoded.stability.mean == 0.35);
+    AggregateCache otherLayout(8);
+    otherLayout.load(path);
+    assert(otherLayout.size() == 0);
+
+    // A torn trailing record is ignored, then cut off before the next append
+    // so later records stay readable.
+    {
+        std::ofstream torn(path, std::ios::binary | std::ios::app);
+        torn << "E\x40\x00";
+    }
+    loaded.load(path);
+    assert(loaded.size() == 3 && loaded.rollup() != nullptr);
+    loaded.store("f3", FileIdentity{3}, partialOf({0.9}));
+    loaded.retain([](const std::string& key) { return key != "f0"; });
+    assert(loaded.save(path, nullptr));
+    AggregateCache reopened(7);
+    reopened.load(path);
+    assert(reopened.size() == 3 && reopened.rollup() == nullptr);
+    assert(reopened.lookup("f0", FileIdentity{0}) == nullptr);
+    assert(reopened.read("f3", decoded) && decoded.stability.count == 1 && decoded.stability.mean == 0.9);
+    assert(reopened.read("f1", decoded) && decoded.stability.count == 2);
+
+    // Rewriting one entry over and over compacts the log instead of growing it.
+    for (int round = 0; round < 50; ++round) {
+        reopened.store("f1", FileIdentity{1, round}, partialOf({0.2, 0.4, 0.6}));
+        assert(reopened.save(path, nullptr));
+        reopened.load(path);
+    }
+    assert(reopened.size() == 3 && reopened.lookup("f1", FileIdentity{1, 49}) != nullptr);
+    assert(std::filesystem::file_size(path) < 8 * 1024);
+}
+
+void validate_exported_snapshot(const std::filesystem::path& baseDir) {
+    // EntropyTelemetry::toJson emits a single line with a top-level average and
+    // a nested overhead object; only entries of "records" may be aggregated.
+    const auto exportDir = baseDir / "exported";
+    clamp::EntropyTelemetry telemetry;
+    std::vector<clamp::AnchorTelemetryRecord> records(3);
+    const auto base = std::chrono::system_clock::time_point{} + std::chrono::hours(24 * 365 * 55);
+    const double scores[] = {0.25, 0.5, 0.75};
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        records[i].context = i == 0 ? "brace } [ \"quoted\"" : "plain";
+        records[i].seed = i + 1;
+        records[i].acquiredAt = base + std::chrono::seconds(10 * i);
+        records[i].stabilityScore = scores[i];
+    }
+    telemetry.mergeRecords(records);
+    assert(telemetry.writeJSON(exportDir, "export"));
+
+    const auto summary = clamp::TemporalAggregator({1}).aggregate(exportDir);
+    assert(summary.sessionCount == 3);
+    assert(summary.meanStability == 0.5);
+    assert(summary.driftIndex == 20000.0);
+}
+
+void validate_timestamp_formats(const std::filesystem::path& baseDir) {
+    const auto stampDir = baseDir / "timestamps";
+    writeTelemetryFile(stampDir / "stamps.json",
+                       {{1.0, 1.0}, {1.0, 1.0}, {1.0, 1.0}, {1.0, 1.0}},
+                       {"2024-02-29T23:59:59.250Z", "2024-03-01T00:00:00Z", "2024-03-01T00:00:01", "2024-03-01T00:00:00.5Z"});
+    const auto summary = clamp::TemporalAggregator({1}).aggregate(stampDir);
+    assert(summary.sessionCount == 4);
+    assert(summary.driftIndex == 1750.0);
+}
+
+void validate_large_file(const std::filesystem::path& baseDir) {
+    // Large enough to take the mmap path rather than the buffered read.
+    const auto largeDir = baseDir / "large";
+    std::filesystem::create_directories(largeDir);
+    constexpr int kRecords = 2000;
+    {
+        std::ofstream out(largeDir / "large.json");
+        out << "{\n  \"records\": [\n";
+        for (int i = 0; i < kRecords; ++i) {
+            out << (i == 0 ? "" : ",\n") << "    {\"context\": \"large\", \"acquired_at\": \"2025-01-01T00:00:00Z\", "
+                << "\"duration_ms\": 1.0, \"stability_score\": " << (i % 2 == 0 ? "0.25" : "0.75") << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+    assert(std::filesystem::file_size(largeDir / "large.json") > 64 * 1024);
+    const auto summary = clamp::TemporalAggregator({1}).aggregate(largeDir);
+    assert(summary.sessionCount == kRecords);
+    assert(summary.meanStability == 0.5);
+}
+
+class CollectingSink final : public clamp::detail::RecordSink {
+public:
+    void onRecord(const clamp::detail::ParsedRecord& record) override { records.push_back(record); }
+    std::vector<clamp::detail::ParsedRecord> records;
+};
+
+void validate_chunked_scanner() {
+    const std::string document =
+        "{\"backend\":\"CPU\",\"stability_score\":0.5,\"telemetry_overhead\":{\"record_count\":3},"
+        "\"records\": [{\"context\":\"a \\\" } ]\",\"acquired_at\":\"2025-01-01T00:00:01Z\","
+        "\"stability_score\":0.125},\n  {\"context\":\"b\", \"stability_score\" : 1e-1 ,"
+        "\"acquired_at\" : \"2025-01-01T00:00:02.5Z\"},{\"stability_score\":0.75}] }";
+
+    CollectingSink whole;
+    assert(clamp::detail::TelemetryScanner::scan(document, whole) == 3);
+    assert(whole.records[0].stabilityScore == 0.125);
+    assert(whole.records[1].stabilityScore == 0.1);
+    assert(whole.records[1].timestampMs - whole.records[0].timestampMs == 1500.0);
+    assert(whole.records[2].timestampMs == 2.0);
+
+    for (std::size_t chunkSize = 1; chunkSize < 97; ++chunkSize) {
+        CollectingSink chunked;
+        clamp::detail::TelemetryScanner scanner(chunked);
+        for (std::size_t offset = 0; offset < document.size(); offset += chunkSize) {
+            scanner.feed(std::string_view(document).substr(offset, chunkSize));
+        }
+        assert(scanner.finish() == whole.records.size());
+        for (std::size_t i = 0; i < whole.records.size(); ++i) {
+            assert(chunked.records[i].stabilityScore == whole.records[i].stabilityScore);
+            assert(chunked.records[i].timestampMs == whole.records[i].timestampMs);
+        }
+    }
+}
+
+void validate_batched_io(const std::filesystem::path& baseDir) {
+    const auto parallelDir = baseDir / "parallel";
+    std::vector<std::filesystem::path> paths;
+    for (int file = 0; file < 12; ++file) {
+        paths.push_back(parallelDir / ("run_" + std::to_string(file) + ".json"));
+    }
+    paths.push_back(parallelDir / "missing.json");
+
+    for (const bool preferIoUring : {true, false}) {
+        clamp::detail::BatchFileReader reader(2, preferIoUring, 1024);
+        const auto buffers = reader.read(paths);
+        assert(buffers.size() == paths.size());
+        for (std::size_t i = 0; i + 1 < paths.size(); ++i) {
+            std::ifstream in(paths[i], std::ios::binary);
+            const std::string expected((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            assert(buffers[i].status == clamp::detail::FileBuffer::Status::Ok);
+            assert(buffers[i].data == expected);
+        }
+        assert(buffers.back().status == clamp::detail::FileBuffer::Status::Failed);
+
+        clamp::detail::BatchFileReader tiny(1, preferIoUring, 16);
+        assert(tiny.read({paths.front()}).front().status == clamp::detail::FileBuffer::Status::Oversized);
+    }
+
+    clamp::TemporalAggregator::Options options;
+    options.workerCount = 2;
+    const auto plain = clamp::TemporalAggregator(options).aggregate(parallelDir);
+    options.batchedIo = true;
+    const auto batched = clamp::TemporalAggregator(options).aggregate(parallelDir);
+    assert(batched.sessionCount == plain.sessionCount);
+    assert(batched.meanStability == plain.meanStability);
+    assert(batched.stabilityVariance == plain.stabilityVariance);
+    assert(batched.driftIndex == plain.driftIndex);
+}
+
+void validate_group_by(const std::filesystem::path& baseDir) {
+    const auto groupDir = baseDir / "groups";
+    std::filesystem::create_directories(groupDir);
+    const std::string first =
+        "{\"backend\":\"HIP\",\"deviceName\":\"gfx90a\",\"records\":["
+        "{\"context\":\"alpha\",\"thread_id\":\"1\",\"acquired_at\":\"2025-01-01T00:00:00Z\",\"stability_score\":0.5},"
+        "{\"context\":\"beta\",\"thread_id\":\"2\",\"acquired_at\":\"2025-01-01T00:00:01Z\",\"stability_score\":0.25}]}";
+    const std::string second =
+        "{\"backend\":\"CPU\",\"device_name\":\"host\",\"records\":["
+        "{\"context\":\"alpha\",\"backend\":\"HIP\",\"thread_id\":\"1\",\"acquired_at\":\"2025-01-01T00:00:02Z\","
+        "\"stability_score\":1.0}]}";
+    std::ofstream(groupDir / "g1.json") << first;
+    std::ofstream(groupDir / "g2.json") << second;
+
+    clamp::TemporalAggregator::Options options;
+    options.workerCount = 1;
+    options.groupBy.context = true;
+    const auto byContext = clamp::TemporalAggregator(options).aggregate(groupDir);
+    assert(byContext.sessionCount == 3);
+    assert(byContext.groups.size() == 2);
+    assert(byContext.groups[0].key.context == "alpha" && byContext.groups[0].key.backend.empty());
+    assert(byContext.groups[0].sessionCount == 2);
+    assert(byContext.groups[0].meanStability == 0.75);
+    assert(byContext.groups[0].driftIndex == 2000.0);
+    assert(byContext.groups[1].key.context == "beta" && byContext.groups[1].sessionCount == 1);
+    assert(byContext.groups[1].driftIndex == 0.0);
+
+    // Records without their own backend or device inherit the document's.
+    clamp::TemporalAggregator::Options hardware;
+    hardware.workerCount = 1;
+    hardware.groupBy.backend = true;
+    hardware.groupBy.deviceName = true;
+    const auto byDevice = clamp::TemporalAggregator(hardware).aggregate(groupDir);
+    assert(byDevice.groups.size() == 2);
+    assert(byDevice.groups[0].key.backend == "HIP" && byDevice.groups[0].key.deviceName == "gfx90a");
+    assert(byDevice.groups[0].sessionCount == 2);
+    assert(byDevice.groups[1].key.backend == "HIP" && byDevice.groups[1].key.deviceName == "host");
+    assert(byDevice.groups[1].sessionCount == 1);
+
+    // A cache written for one grouping must not be reused for another.
+    options.incremental = true;
+    hardware.incremental = true;
+    const auto cold = clamp::TemporalAggregator(options).aggregate(groupDir);
+    const auto regrouped = clamp::TemporalAggregator(hardware).aggregate(groupDir);
+    const auto warm = clamp::TemporalAggregator(hardware).aggregate(groupDir);
+    assert(cold.groups.size() == 2 && cold.groups[0].key.context == "alpha");
+    assert(regrouped.groups.size() == 2 && regrouped.groups[0].key.deviceName == "gfx90a");
+    assert(warm.groups.size() == regrouped.groups.size());
+    for (std::size_t i = 0; i < warm.groups.size(); ++i) {
+        assert(warm.groups[i].key == regrouped.groups[i].key);
+        assert(warm.groups[i].meanStability == regrouped.groups[i].meanStability);
+        assert(warm.groups[i].sessionCount == regrouped.groups[i].sessionCount);
+    }
+
+    const auto outputPath = groupDir / "summary.json";
+    assert(clamp::TemporalAggregator(options).writeSummary(byContext, outputPath, groupDir.string()));
+    std::ifstream in(outputPath);
+    const std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    assert(contents.find("\"groups\":[{\"context\":\"alpha\",\"session_count\":2") != std::string::npos);
+
+    constexpr unsigned kAllFields = clamp::detail::TelemetryScanner::kFieldContext |
+                                    clamp::detail::TelemetryScanner::kFieldBackend |
+                                    clamp::detail::TelemetryScanner::kFieldDeviceName |
+                                    clamp::detail::TelemetryScanner::kFieldThreadId;
+    class FieldSink final : public clamp::detail::RecordSink {
+    public:
+        void onRecord(const clamp::detail::ParsedRecord& record) override {
+            keys.push_back(std::string(record.context) + "|" + std::string(record.backend) + "|" +
+                           std::string(record.deviceName) + "|" + std::string(record.threadId));
+        }
+        std::vector<std::string> keys;
+    };
+    for (std::size_t chunkSize = 1; chunkSize < 40; ++chunkSize) {
+        FieldSink sink;
+        clamp::detail::TelemetryScanner scanner(sink, kAllFields);
+        for (std::size_t offset = 0; offset < first.size(); offset += chunkSize) {
+            scanner.feed(std::string_view(first).substr(offset, chunkSize));
+        }
+        scanner.finish();
+        assert(sink.keys.size() == 2);
+        assert(sink.keys[0] == "alpha|HIP|gfx90a|1");
+        assert(sink.keys[1] == "beta|HIP|gfx90a|2");
+    }
+}
+
+void validate_quantile_sketch(const std::filesystem::path& baseDir) {
+    // Values 0..N-1 in a scrambled order; the exact q-quantile is q * N.
+    constexpr int kSamples = 100000;
+    clamp::detail::TDigest whole;
+    std::vector<clamp::detail::TDigest> parts(10);
+    for (int i = 0; i < kSamples; ++i) {
+        const double value = static_cast<double>((static_cast<long long>(i) * 7919) % kSamples);
+        whole.add(value);
+        parts[static_cast<std::size_t>(i % 10)].add(value);
+    }
+    clamp::detail::TDigest merged;
+    for (const auto& part : parts) {
+        merged.merge(part);
+    }
+    for (const auto* digest : {&whole, &merged}) {
+        assert(std::abs(digest->quantile(0.5) - 0.5 * kSamples) < 0.01 * kSamples);
+        assert(std::abs(digest->quantile(0.9) - 0.9 * kSamples) < 0.01 * kSamples);
+        assert(std::abs(digest->quantile(0.99) - 0.99 * kSamples) < 0.002 * kSamples);
+        assert(std::abs(digest->quantile(0.999) - 0.999 * kSamples) < 0.0005 * kSamples);
+        assert(digest->quantile(0.0) == 0.0 && digest->quantile(1.0) == kSamples - 1);
+    }
+    merged.compress();
+    assert(merged.centroids().size() <= 2 * static_cast<std::size_t>(clamp::detail::TDigest::kDefaultCompression));
+
+    const auto summary = clamp::TemporalAggregator({1}).aggregate(baseDir);
+    assert(summary.durationQuantiles.p50 == 5.0);
+    assert(summary.durationQuantiles.p999 <= 6.0 && summary.durationQuantiles.p999 > 5.0);
+    assert(summary.stabilityQuantiles.p50 == 0.8);
+}
+
+void validate_time_buckets(const std::filesystem::path& baseDir) {
+    const auto bucketDir = baseDir / "buckets";
+    writeTelemetryFile(bucketDir / "a.json", {{0.2, 1.0}, {0.4, 3.0}, {0.9, 8.0}},
+                       {"2025-01-01T00:00:00.100Z", "2025-01-01T00:00:00.900Z", "2025-01-01T00:00:02.500Z"});
+    writeTelemetryFile(bucketDir / "b.json", {{0.6, 5.0}, {0.5, 2.0}},
+                       {"2025-01-01T00:00:00.500Z", "2025-01-01T00:00:03.999Z"});
+
+    clamp::TemporalAggregator::Options options;
+    options.workerCount = 2;
+    options.bucketWidth = std::chrono::seconds(1);
+    const auto summary = clamp::TemporalAggregator(options).aggregate(bucketDir);
+    constexpr std::int64_t kEpoch = 1735689600000;
+    assert(summary.bucketWidthMs == 1000);
+    assert(summary.timeBuckets.size() == 3);
+    assert(summary.timeBuckets[0].startMs == kEpoch);
+    assert(summary.timeBuckets[0].sessionCount == 3);
+    assert(std::abs(summary.timeBuckets[0].meanStability - 0.4) < 1e-12);
+    assert(summary.timeBuckets[0].meanDurationMs == 3.0);
+    assert(summary.timeBuckets[0].durationQuantiles.p50 == 3.0);
+    assert(summary.timeBuckets[1].startMs == kEpoch + 2000 && summary.timeBuckets[1].sessionCount == 1);
+    assert(summary.timeBuckets[2].startMs == kEpoch + 3000 && summary.timeBuckets[2].meanStability == 0.5);
+
+    // Too many buckets: the width doubles until the timeline fits.
+    options.maxBuckets = 2;
+    const auto coarse = clamp::TemporalAggregator(options).aggregate(bucketDir);
+    assert(coarse.bucketWidthMs == 2000);
+    assert(coarse.timeBuckets.size() == 2);
+    assert(coarse.timeBuckets[0].sessionCount == 3 && coarse.timeBuckets[1].sessionCount == 2);
+
+    options.incremental = true;
+    const auto cold = clamp::TemporalAggregator(options).aggregate(bucketDir);
+    const auto warm = clamp::TemporalAggregator(options).aggregate(bucketDir);
+    assert(warm.bucketWidthMs == cold.bucketWidthMs && warm.timeBuckets.size() == cold.timeBuckets.size());
+    for (std::size_t i = 0; i < warm.timeBuckets.size(); ++i) {
+        assert(warm.timeBuckets[i].startMs == cold.timeBuckets[i].startMs);
+        assert(warm.timeBuckets[i].meanStability == cold.timeBuckets[i].meanStability);
+        assert(warm.timeBuckets[i].durationQuantiles.p90 == cold.timeBuckets[i].durationQuantiles.p90);
+    }
+
+    const auto seriesPath = bucketDir / "series.json";
+    assert(clamp::TemporalAggregator(options).writeTimeSeries(summary, seriesPath));
+    std::ifstream in(seriesPath);
+    const std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    assert(contents.find("\"bucket_width_ms\":1000,\"bucket_count\":3") != std::string::npos);
+    assert(contents.find("\"start_ms\":[1735689600000,1735689602000,1735689603000]") != std::string::npos);
+    assert(contents.find("\"session_count\":[3,1,1]") != std::string::npos);
+}
+
+void validate_query(const std::filesystem::path& baseDir) {
+    constexpr std::int64_t kEpoch = 1735689600000;
+    const auto queryDir = baseDir / "query";
+    auto record = [](const char* context, const char* backend, int second, double stability) {
+        std::string json = "{\"context\":\"" + std::string(context) + "\",";
+        if (*backend != '\0') {
+            json += "\"backend\":\"" + std::string(backend) + "\",";
+        }
+        return json + "\"acquired_at\":\"2025-01-01T00:00:" + (second < 10 ? "0" : "") + std::to_string(second) +
+               "Z\",\"duration_ms\":1.0,\"stability_score\":" + std::to_string(stability) + "}";
+    };
+    auto writeDocument = [](const std::filesystem::path& path, const char* backend, std::vector<std::string> records) {
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream out(path);
+        out << "{\"backend\":\"" << backend << "\",\"records\":[";
+        for (std::size_t i = 0; i < records.size(); ++i) {
+            out << (i == 0 ? "" : ",") << records[i];
+        }
+        out << "]}";
+    };
+    writeDocument(queryDir / "top.json", "CPU", {record("alpha", "", 0, 0.5), record("beta", "HIP", 1, 0.25)});
+    writeDocument(queryDir / "nested" / "a.json", "HIP", {record("alpha", "", 10, 1.0)});
+    writeDocument(queryDir / "nested" / "deep" / "b.json", "CPU", {record("gamma", "", 20, 0.75)});
+    writeDocument(queryDir / "skip" / "c.json", "CPU", {record("alpha", "", 30, 0.0)});
+    std::ofstream(queryDir / "nested" / "notes.txt") << "not telemetry";
+
+    clamp::TemporalAggregator aggregator({1});
+    using Query = clamp::TemporalAggregator::Query;
+    auto count = [&](const Query& query) { return aggregator.aggregate(queryDir, query).sessionCount; };
+
+    assert(count({}) == 2);
+    Query recursive;
+    recursive.recursive = true;
+    assert(count(recursive) == 5);
+    Query nested = recursive;
+    nested.include = {"nested/**"};
+    assert(count(nested) == 2);
+    nested.include = {"nested/*.json"};
+    assert(count(nested) == 1);
+    Query byName = recursive;
+    byName.include = {"[a-b].json", "t?p.json"};
+    assert(count(byName) == 4);
+    Query pruned = recursive;
+    pruned.exclude = {"skip", "**/deep/**"};
+    assert(count(pruned) == 3);
+
+    Query window = recursive;
+    window.fromMs = kEpoch + 1000;
+    window.toMs = kEpoch + 30000;
+    const auto windowed = aggregator.aggregate(queryDir, window);
+    assert(windowed.sessionCount == 3);
+    assert(windowed.driftIndex == 19000.0);
+
+    // Backends fall back to the document-level value.
+    Query filtered = recursive;
+    filtered.contexts = {"alpha"};
+    assert(count(filtered) == 3);
+    filtered.backends = {"HIP"};
+    assert(count(filtered) == 1);
+    filtered.contexts.clear();
+    assert(count(filtered) == 2);
+
+    // Filtered fields are not exposed unless grouping asked for them, and
+    // records without a timestamp never pass a window.
+    clamp::detail::RecordFilter contextFilter;
+    contextFilter.contexts = {"alpha"};
+    CollectingSink sink;
+    const std::string document = "{\"records\":[" + record("alpha", "", 0, 0.5) + "," + record("beta", "", 1, 0.25) +
+                                 ",{\"context\":\"alpha\",\"stability_score\":0.125}]}";
+    assert(clamp::detail::TelemetryScanner::scan(document, sink, 0, &contextFilter) == 2);
+    assert(sink.records[0].context.empty() && sink.records[1].timestampMs == 2.0);
+    // A record without a context never matches a context filter.
+    CollectingSink contextless;
+    const std::string unlabelled = "{\"records\":[{\"stability_score\":0.5}," + record("alpha", "", 1, 0.25) + "]}";
+    assert(clamp::detail::TelemetryScanner::scan(unlabelled, contextless, 0, &contextFilter) == 1);
+    assert(contextless.records[0].stabilityScore == 0.25);
+    clamp::detail::RecordFilter timeFilter;
+    timeFilter.windowed = true;
+    CollectingSink timed;
+    assert(clamp::detail::TelemetryScanner::scan(document, timed, 0, &timeFilter) == 2);
+
+    // With a warm cache, files whose cached time range misses the window are
+    // trusted and never opened: replace one in place without changing its
+    // identity and the window still ignores it.
+    clamp::TemporalAggregator::Options options;
+    options.workerCount = 1;
+    options.incremental = true;
+    clamp::TemporalAggregator cached(options);
+    assert(cached.aggregate(queryDir, recursive).sessionCount == 5);
+    const auto skipped = queryDir / "skip" / "c.json";
+    const auto mtime = std::filesystem::last_write_time(skipped);
+    const auto size = std::filesystem::file_size(skipped);
+    {
+        std::fstream inPlace(skipped, std::ios::in | std::ios::out | std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(inPlace)), std::istreambuf_iterator<char>());
+        contents.replace(contents.find("00:00:30Z"), 9, "00:00:05Z");
+        inPlace.seekp(0);
+        inPlace << contents;
+    }
+    std::filesystem::last_write_time(skipped, mtime);
+    assert(std::filesystem::file_size(skipped) == size);
+    assert(cached.aggregate(queryDir, window).sessionCount == 3);
+    assert(aggregator.aggregate(queryDir, window).sessionCount == 4);
+}
+
+void validate_compressed_input(const std::filesystem::path& baseDir) {
+    using clamp::TelemetryCompression;
+    const auto plainDir = baseDir / "compressed_plain";
+    const auto packedDir = baseDir / "compressed";
+    std::filesystem::create_directories(packedDir);
+
+    // Large enough to span many decompression chunks; the second half is a
+    // separate gzip member / zstd frame appended to the first.
+    constexpr int kRecords = 40000;
+    std::string document = "{\"records\":[";
+    for (int i = 0; i < kRecords; ++i) {
+        document += (i == 0 ? "" : ",");
+        document += "{\"context\":\"packed\",\"acquired_at\":\"2025-01-01T00:00:0" + std::to_string(i % 10) +
+                    "Z\",\"duration_ms\":" + std::to_string(i % 7) + ".5,\"stability_score\":" +
+                    (i % 2 == 0 ? "0.25" : "0.75") + "}";
+    }
+    document += "]}";
+    std::filesystem::create_directories(plainDir);
+    std::ofstream(plainDir / "large.json") << document;
+
+    for (const auto compression : {TelemetryCompression::Gzip, TelemetryCompression::Zstd}) {
+        if (!clamp::EntropyTelemetry::compressionSupported(compression)) {
+            clamp::EntropyTelemetry telemetry;
+            telemetry.setCompression(compression);
+            assert(!telemetry.writeJSON(packedDir, "unsupported"));
+            continue;
+        }
+        const auto extension = std::string(".json") + clamp::detail::compressionExtension(compression);
+        const std::size_t half = document.size() / 2;
+        std::string first;
+        std::string second;
+        assert(clamp::detail::compressBuffer(std::string_view(document).substr(0, half), compression, first));
+        assert(clamp::detail::compressBuffer(std::string_view(document).substr(half), compression, second));
+        {
+            std::ofstream out(packedDir / ("large" + extension), std::ios::binary);
+            out << first << second;
+        }
+        assert(clamp::detail::compressionForPath(packedDir / ("large" + extension)) == compression);
+
+        std::string roundTrip;
+        assert(clamp::detail::decompressFile(packedDir / ("large" + extension), compression,
+                                             [&](std::string_view chunk) {
+                                                 roundTrip.append(chunk);
+                                                 return true;
+                                             }));
+        assert(roundTrip == document);
+
+        // A truncated archive is unreadable: it is neither counted nor cached,
+        // and is picked up once it has been rewritten in full.
+        const auto truncatedDir = baseDir / ("truncated" + extension);
+        writeTelemetryFile(truncatedDir / "good.json", {{0.5, 1.0}});
+        {
+            std::ofstream out(truncatedDir / ("cut" + extension), std::ios::binary);
+            out << first << std::string_view(second).substr(0, second.size() / 2);
+        }
+        assert(!clamp::detail::decompressFile(truncatedDir / ("cut" + extension), compression,
+                                              [](std::string_view) { return true; }));
+        for (const bool batchedIo : {false, true}) {
+            clamp::TemporalAggregator::Options options;
+            options.workerCount = 2;
+            options.batchedIo = batchedIo;
+            options.incremental = true;
+            assert(clamp::TemporalAggregator(options).aggregate(truncatedDir).sessionCount == 1);
+            assert(clamp::TemporalAggregator(options).aggregate(truncatedDir).sessionCount == 1);
+        }
+        {
+            std::ofstream out(truncatedDir / ("cut" + extension), std::ios::binary);
+            out << first << second;
+        }
+        clamp::TemporalAggregator::Options incremental;
+        incremental.incremental = true;
+        assert(clamp::TemporalAggregator(incremental).aggregate(truncatedDir).sessionCount == kRecords + 1);
+        std::filesystem::remove_all(truncatedDir);
+
+        clamp::EntropyTelemetry telemetry;
+        telemetry.setCompression(compression);
+        std::vector<clamp::AnchorTelemetryRecord> records(2);
+        records[0].context = "written";
+        records[0].stabilityScore = 0.5;
+        records[1].context = "written";
+        records[1].stabilityScore = 1.0;
+        telemetry.mergeRecords(records);
+        const auto writtenDir = packedDir / ("written" + extension);
+        assert(telemetry.writeJSON(writtenDir, "run"));
+        const auto written = std::filesystem::directory_iterator(writtenDir)->path();
+        assert(written.string().size() > extension.size() &&
+               written.string().compare(written.string().size() - extension.size(), extension.size(), extension) == 0);
+        const auto writtenSummary = clamp::TemporalAggregator({1}).aggregate(writtenDir);
+        assert(writtenSummary.sessionCount == 2 && writtenSummary.meanStability == 0.75);
+        std::filesystem::remove_all(writtenDir);
+    }
+
+    const auto expected = clamp::TemporalAggregator({1}).aggregate(plainDir);
+    for (const bool batchedIo : {false, true}) {
+        clamp::TemporalAggregator::Options options;
+        options.workerCount = 2;
+        options.batchedIo = batchedIo;
+        const auto summary = clamp::TemporalAggregator(options).aggregate(packedDir);
+        const std::size_t codecs = (clamp::EntropyTelemetry::compressionSupported(TelemetryCompression::Gzip) ? 1 : 0) +
+                                   (clamp::EntropyTelemetry::compressionSupported(TelemetryCompression::Zstd) ? 1 : 0);
+        assert(summary.sessionCount == expected.sessionCount * codecs);
+        if (codecs > 0) {
+            assert(summary.meanStability == expected.meanStability);
+            assert(summary.driftIndex == expected.driftIndex);
+        }
+    }
+}
+
+bool closeTo(const clamp::TemporalAggregator::Summary& lhs, const clamp::TemporalAggregator::Summary& rhs) {
+    return lhs.sessionCount == rhs.sessionCount && std::abs(lhs.meanStability - rhs.meanStability) < 1e-12 &&
+           std::abs(lhs.stabilityVariance - rhs.stabilityVariance) < 1e-12 && lhs.driftIndex == rhs.driftIndex;
+}
+
+void validate_daemon(const std::filesystem::path& baseDir) {
+    const auto watchDir = baseDir / "watched";
+    writeTelemetryFile(watchDir / "a.json", {{0.9, 1.0}, {0.8, 2.0}});
+    writeTelemetryFile(watchDir / "b.json", {{0.4, 3.0}});
+    // A record cut off mid-way, as seen while a writer is still flushing.
+    writeTelemetryFile(baseDir / "growing.json", {{0.3, 1.0}, {0.5, 2.0}, {0.7, 3.0}},
+                       {"2025-01-01T00:00:00Z", "2025-01-01T00:00:05Z", "2025-01-01T00:00:09Z"});
+    std::string growing;
+    {
+        std::ifstream in(baseDir / "growing.json");
+        growing.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    const std::size_t cut = growing.find("\"stability_score\"", growing.find("00:00:05Z"));
+    {
+        std::ofstream out(watchDir / "c.json", std::ios::binary);
+        out << growing.substr(0, cut);
+    }
+
+    clamp::AggregationDaemon::Options options;
+    options.summaryPath = watchDir / "telemetry_summary.json";
+    options.writeInterval = std::chrono::milliseconds(0);
+    clamp::AggregationDaemon daemon(watchDir, options);
+    clamp::TemporalAggregator reference;
+
+    assert(daemon.refresh() == 4);
+    assert(daemon.summary().sessionCount == 4);
+    assert(std::filesystem::exists(options.summaryPath));
+
+    // Only the appended tail is read; the summary file in the same directory
+    // is never aggregated.
+    const auto scannedBefore = daemon.bytesScanned();
+    {
+        std::ofstream out(watchDir / "c.json", std::ios::binary | std::ios::app);
+        out << growing.substr(cut);
+    }
+    assert(daemon.refresh() == 2);
+    assert(daemon.bytesScanned() - scannedBefore == growing.size() - cut);
+    assert(closeTo(daemon.summary(), reference.aggregate(watchDir)));
+    assert(daemon.summary().driftIndex == 9000.0);
+    assert(daemon.refresh() == 0 && daemon.rescans() == 0);
+
+    // Rewritten and deleted files are rebuilt from scratch.
+    writeTelemetryFile(watchDir / "b.json", {{0.1, 3.0}});
+    daemon.refresh();
+    assert(daemon.rescans() == 1);
+    assert(closeTo(daemon.summary(), reference.aggregate(watchDir)));
+    std::filesystem::remove(watchDir / "a.json");
+    daemon.refresh();
+    assert(daemon.rescans() == 2);
+    assert(daemon.summary().sessionCount == 4);
+    assert(closeTo(daemon.summary(), reference.aggregate(watchDir)));
+
+    std::thread watcher([&daemon] { assert(daemon.run()); });
+    writeTelemetryFile(watchDir / "d.json", {{0.6, 2.0}, {0.2, 2.5}});
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (daemon.summary().sessionCount != 6 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    daemon.stop();
+    watcher.join();
+    assert(daemon.summary().sessionCount == 6);
+    std::ifstream written(options.summaryPath);
+    const std::string contents((std::istreambuf_iterator<char>(written)), std::istreambuf_iterator<char>());
+    assert(contents.find("\"session_count\":6") != std::string::npos);
+    assert(!std::filesystem::exists(watchDir / "telemetry_summary.json.tmp"));
+}
+
 } // namespace
 
 int main() {
@@ -48,6 +774,21 @@ int main() {
     assert(summary.stabilityVariance >= 0.0);
     assert(summary.driftIndex >= 0.0);
 
+    validate_worker_invariance(baseDir);
+    validate_incremental_cache(baseDir);
+    validate_cache_log(baseDir / "cache_log");
+    validate_exported_snapshot(baseDir);
+    validate_timestamp_formats(baseDir);
+    validate_large_file(baseDir);
+    validate_chunked_scanner();
+    validate_batched_io(baseDir);
+    validate_group_by(baseDir);
+    validate_quantile_sketch(baseDir);
+    validate_time_buckets(baseDir);
+    validate_query(baseDir);
+    validate_compressed_input(baseDir);
+    validate_daemon(baseDir);
+
     const auto buildDir = std::filesystem::current_path() / "build";
     std::filesystem::create_directories(buildDir);
     const auto snapshotPath = buildDir / "rocm_snapshot.json";
@@ -75,6 +816,7 @@ int main() {
     assert(contents.find("\"drift_index\"") != std::string::npos);
     assert(contents.find("\"build_info\"") != std::string::npos);
     assert(contents.find("rocforge-ci") != std::string::npos);
+    assert(contents.find("\"duration_ms_quantiles\":{\"p50\":5.000000") != std::string::npos);
 
     return 0;
 }
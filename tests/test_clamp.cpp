@@ -1,14 +1,21 @@
 #include "clamp.h"
+#include "clamp/EntropyBackend.h"
 #include "clamp/EntropyTelemetry.h"
+#include "telemetry/entropy_mirror.h"
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cmath>
+#include <cstdlib>
 #include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <iterator>
 #include <mutex>
 #include <numeric>
+#include <optional>
+#include <random>
 #include <string>
 #include <thread>
 #include <utility>
@@ -144,9 +151,259 @@ void validate_telemetry(const clamp::EntropyTelemetry& telemetry) {
     assert(json.find("\"stability_score\"") != std::string::npos);
 }
 
+void validate_overhead(const clamp::EntropyTelemetry& telemetry) {
+    const auto before = telemetry.overhead();
+    assert(before.recordCount == telemetry.records().size());
+    assert(before.acquireCalls >= before.recordCount);
+    assert(before.acquireSamples >= 1);
+    assert(before.releaseSamples >= 1);
+    assert(before.recordBytes >= before.recordCount * sizeof(clamp::AnchorTelemetryRecord));
+    assert(before.lockAcquisitions > 0);
+
+    const std::string json = telemetry.toJson();
+    assert(json.find("\"telemetry_overhead\"") != std::string::npos);
+    assert(json.find("\"lock_wait_ns\"") != std::string::npos);
+
+    const auto after = telemetry.overhead();
+    assert(after.serializationCount == before.serializationCount + 1);
+    assert(after.serializedBytes >= before.serializedBytes + json.size());
+}
+
+void validate_release_scores() {
+    clamp::ReleaseScorer scorer;
+    // The first sample has nothing to compare against.
+    assert(scorer.observe(3.0) == 1.0);
+    for (int i = 0; i < 24; ++i) {
+        assert(scorer.observe(3.0) == 1.0);
+    }
+    assert(scorer.count() == 25 && scorer.meanMs() == 3.0 && scorer.spreadMs() == 0.0);
+
+    // Constant holds have no spread, so the floor (5% of the mean) sets the
+    // width: three floors away scores 0.5.
+    assert(std::abs(scorer.observe(3.0 + 3.0 * 0.05 * 3.0) - 0.5) < 1e-9);
+    assert(scorer.spreadMs() > 0.0);
+    // A hold far outside the history scores low.
+    assert(scorer.observe(60.0) < 0.2);
+
+    // Noisy holds widen the score rather than being penalised for their noise.
+    clamp::ReleaseScorer noisy;
+    std::mt19937_64 generator(7);
+    std::normal_distribution<double> holdMs(10.0, 2.0);
+    std::vector<double> noisyScores;
+    for (int i = 0; i < 1000; ++i) {
+        noisyScores.push_back(noisy.observe(holdMs(generator)));
+    }
+    std::sort(noisyScores.begin(), noisyScores.end());
+    assert(noisyScores[noisyScores.size() / 2] > 0.8);
+    assert(std::abs(noisy.meanMs() - 10.0) < 2.0);
+
+    // ClampAnchor scores its releases through the same path; a new context
+    // starts from scratch.
+    clamp::EntropyTelemetry telemetry;
+    auto cycle = [&](const std::string& context) {
+        clamp::ClampAnchor anchor;
+        anchor.attachTelemetry(&telemetry);
+        anchor.lock(context);
+        anchor.release();
+        return telemetry.records().back().stabilityScore;
+    };
+    assert(cycle("steady") == 1.0);
+    for (int i = 0; i < 8; ++i) {
+        cycle("steady");
+    }
+    assert(cycle("other") == 1.0);
+    for (const auto& record : telemetry.records()) {
+        assert(record.stabilityScore >= 0.0 && record.stabilityScore <= 1.0);
+    }
+}
+
+// Feeds durations to a detector with the rolling spread EntropyTelemetry
+// passes for a context.
+struct SyntheticContext {
+    clamp::ReleaseScorer scorer;
+    clamp::ChangePointDetector detector;
+    clamp::ChangePointOptions options;
+
+    std::optional<clamp::ChangePointDetector::Shift> observe(double durationMs) {
+        const double spread = scorer.spreadMs();
+        scorer.observe(durationMs);
+        return detector.observe(durationMs, spread, options);
+    }
+};
+
+void validate_change_points() {
+    // A step from 1 ms to 40 ms holds is found within a few releases.
+    SyntheticContext shifting;
+    for (int i = 0; i < 40; ++i) {
+        assert(!shifting.observe(1.0 + 0.01 * (i % 5)));
+    }
+    std::optional<clamp::ChangePointDetector::Shift> shift;
+    int releases = 0;
+    while (!shift && releases < 4) {
+        shift = shifting.observe(40.0);
+        ++releases;
+    }
+    assert(shift && shift->increase && shift->baselineMs > 0.9 && shift->baselineMs < 1.1);
+
+    // The detector learns the new regime before it can alarm again.
+    for (int i = 0; i < 200; ++i) {
+        assert(!shifting.observe(40.0 + 0.4 * (i % 5)));
+    }
+    // A drop takes longer: the short holds widen the rolling spread, and with
+    // it the threshold, until the running mean catches up.
+    shift.reset();
+    releases = 0;
+    while (!shift && releases < 16) {
+        shift = shifting.observe(1.0);
+        ++releases;
+    }
+    assert(shift && !shift->increase && shift->baselineMs > 30.0);
+
+    // EntropyTelemetry records a marker and runs the callback for each alarm.
+    // With these options every release alarms.
+    clamp::EntropyTelemetry telemetry;
+    clamp::ChangePointOptions everyRelease;
+    everyRelease.tolerance = -1.0;
+    everyRelease.threshold = 0.0;
+    everyRelease.warmup = 0;
+    telemetry.setChangePointOptions(everyRelease);
+    std::vector<clamp::TelemetryChangePoint> fired;
+    telemetry.setChangePointCallback([&](const clamp::TelemetryChangePoint& changePoint) {
+        // Runs outside the telemetry lock.
+        assert(!telemetry.records().empty());
+        fired.push_back(changePoint);
+    });
+    const std::size_t id = telemetry.recordAcquire("shifting", 7);
+    telemetry.recordRelease(id, "shifting", 7);
+    const auto changePoints = telemetry.changePoints();
+    assert(changePoints.size() == 1 && fired.size() == 1);
+    assert(changePoints[0].recordIndex == id && changePoints[0].context == "shifting" && changePoints[0].increase);
+    const std::string json = telemetry.toJson();
+    assert(json.find("\"change_points\":[{") != std::string::npos);
+    assert(json.find("\"direction\":\"increase\"") != std::string::npos);
+
+    clamp::EntropyTelemetry disabled;
+    everyRelease.enabled = false;
+    disabled.setChangePointOptions(everyRelease);
+    for (int i = 0; i < 40; ++i) {
+        disabled.recordRelease(disabled.recordAcquire("quiet", 1), "quiet", 1);
+    }
+    assert(disabled.changePoints().empty() && disabled.changePointCount() == 0);
+    assert(disabled.toJson().find("\"change_points\":[]") != std::string::npos);
+}
+
+void validate_change_point_noise() {
+    // Stationary exponential holds have a standard deviation as large as their
+    // mean; scaled by that spread, their tails are not shifts.
+    std::mt19937_64 generator(42);
+    std::exponential_distribution<double> holdMs(1.0 / 5.0);
+    SyntheticContext context;
+    for (int i = 0; i < 20000; ++i) {
+        assert(!context.observe(holdMs(generator)));
+    }
+    std::optional<clamp::ChangePointDetector::Shift> shift;
+    for (int i = 0; i < 200 && !shift; ++i) {
+        shift = context.observe(10.0 * holdMs(generator));
+    }
+    assert(shift && shift->increase && shift->baselineMs > 4.0 && shift->baselineMs < 6.0);
+
+    // Only the latest markers are kept; the rest are counted.
+    clamp::EntropyTelemetry telemetry;
+    clamp::ChangePointOptions everyRelease;
+    everyRelease.tolerance = -1.0;
+    everyRelease.threshold = 0.0;
+    everyRelease.warmup = 0;
+    telemetry.setChangePointOptions(everyRelease);
+    const std::size_t releases = clamp::EntropyTelemetry::kRetainedChangePoints + 44;
+    for (std::size_t i = 0; i < releases; ++i) {
+        telemetry.recordRelease(telemetry.recordAcquire("alarming", 1), "alarming", 1);
+    }
+    const auto retained = telemetry.changePoints();
+    assert(telemetry.changePointCount() == releases);
+    assert(retained.size() == clamp::EntropyTelemetry::kRetainedChangePoints);
+    assert(retained.front().recordIndex == 44 && retained.back().recordIndex == releases - 1);
+    assert(telemetry.toJson().find("\"change_point_count\":300,") != std::string::npos);
+}
+
 void validate_hip_mirror(const std::vector<std::uint64_t>& seeds,
                          const std::vector<int>& states) {
     assert(clamp::runHipEntropyMirror(seeds, states));
+    assert(!clamp::runHipEntropyMirror(seeds, std::vector<int>(states.size() + 1, 0)));
+    assert(clamp::runHipEntropyMirror({}, {}));
+
+    // Large enough to be split into chunks across threads.
+    std::vector<std::uint64_t> manySeeds(1'000'003);
+    std::vector<int> manyStates(manySeeds.size());
+    for (std::size_t i = 0; i < manySeeds.size(); ++i) {
+        manySeeds[i] = i * 0x9E3779B97F4A7C15ull;
+        manyStates[i] = static_cast<int>(i % 3);
+    }
+    assert(clamp::runHipEntropyMirror(manySeeds, manyStates));
+    for (const std::size_t workers : {std::size_t{1}, std::size_t{4}}) {
+        assert(clamp::detail::cpuEntropyMirror(manySeeds.data(), manyStates.data(), manySeeds.size(), workers));
+    }
+
+    // The compare catches a single flipped bit in either buffer, including
+    // in the last, partial chunk.
+    auto seedsCopy = manySeeds;
+    auto statesCopy = manyStates;
+    for (const std::size_t index : {std::size_t{0}, std::size_t{500'000}, manySeeds.size() - 1}) {
+        seedsCopy[index] ^= 1ull << 63;
+        assert(!clamp::detail::mirrorMatches(manySeeds.data(), seedsCopy.data(), manyStates.data(),
+                                             statesCopy.data(), manySeeds.size(), 4));
+        seedsCopy[index] ^= 1ull << 63;
+        statesCopy[index] ^= 4;
+        assert(!clamp::detail::mirrorMatches(manySeeds.data(), seedsCopy.data(), manyStates.data(),
+                                             statesCopy.data(), manySeeds.size(), 4));
+        statesCopy[index] ^= 4;
+    }
+    assert(clamp::detail::mirrorMatches(manySeeds.data(), seedsCopy.data(), manyStates.data(), statesCopy.data(),
+                                        manySeeds.size(), 4));
+}
+
+void validate_entropy_backends(const std::vector<std::uint64_t>& seeds,
+                               const std::vector<int>& states) {
+    const auto names = clamp::entropyBackendNames();
+    assert(std::find(names.begin(), names.end(), "cpu-parallel") != names.end());
+    assert(std::find(names.begin(), names.end(), "cpu-scalar") != names.end());
+    assert(!clamp::makeEntropyBackend("no-such-backend"));
+
+    const auto backends = clamp::availableEntropyBackends(2);
+    assert(backends.size() >= 2);
+    for (const auto& backend : backends) {
+        assert(backend->measuredThroughput() == 0.0);
+        assert(backend->mirror(seeds, states) == std::optional<bool>(true));
+        assert(backend->mirror(seeds, std::vector<int>(states.size() + 1, 0)) == std::optional<bool>(false));
+        assert(backend->mirroredEntries() == seeds.size());
+        assert(backend->measuredThroughput() > 0.0);
+
+        const auto capabilities = backend->capabilities();
+        assert(!capabilities.kernel.empty());
+        assert(capabilities.workerCount >= 1);
+        if (!capabilities.device) {
+            assert(backend->telemetryBackend() == "CPU");
+        }
+    }
+    const auto scalar = clamp::makeEntropyBackend("cpu-scalar");
+    assert(scalar->capabilities().workerCount == 1 && scalar->capabilities().kernel == "scalar");
+    assert(clamp::makeEntropyBackend("cpu-parallel", 3)->capabilities().workerCount == 3);
+
+    // Runtime selection: explicit names, then the environment.
+    assert(clamp::selectEntropyBackend("cpu-scalar"));
+    assert(std::string(clamp::activeEntropyBackend()->name()) == "cpu-scalar");
+    assert(!clamp::selectEntropyBackend("no-such-backend"));
+    assert(std::string(clamp::activeEntropyBackend()->name()) == "cpu-scalar");
+    assert(clamp::runHipEntropyMirror(seeds, states));
+    assert(clamp::activeEntropyBackend()->mirroredEntries() == seeds.size());
+
+    setenv("CLAMP_ENTROPY_BACKEND", "cpu-parallel", 1);
+    assert(clamp::selectEntropyBackendFromEnvironment());
+    assert(std::string(clamp::activeEntropyBackend()->name()) == "cpu-parallel");
+    setenv("CLAMP_ENTROPY_BACKEND", "no-such-backend", 1);
+    assert(!clamp::selectEntropyBackendFromEnvironment());
+    assert(std::string(clamp::activeEntropyBackend()->name()) == backends.front()->name());
+    unsetenv("CLAMP_ENTROPY_BACKEND");
+    assert(clamp::selectEntropyBackendFromEnvironment());
 }
 
 void validate_file_export(const clamp::EntropyTelemetry& telemetry) {
@@ -185,7 +442,12 @@ int main() {
     exercise_multithreaded_entropy(telemetry, seeds, states);
 
     validate_telemetry(telemetry);
+    validate_overhead(telemetry);
+    validate_release_scores();
+    validate_change_points();
+    validate_change_point_noise();
     validate_hip_mirror(seeds, states);
+    validate_entropy_backends(seeds, states);
     validate_file_export(telemetry);
 
     return 0;
@@ -0,0 +1,262 @@
+#include "clamp/TelemetryComparator.h"
+#include "clamp/TemporalAggregator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+bool close(double lhs, double rhs) {
+    return std::abs(lhs - rhs) <= 1e-9 * std::max(1.0, std::abs(rhs));
+}
+
+// Writes a summary whose single group carries the backend and device, as
+// TemporalAggregator does with groupBy.backend and groupBy.deviceName.
+std::filesystem::path writeSummary(const std::filesystem::path& path,
+                                   const std::string& backend,
+                                   const std::string& deviceName,
+                                   std::size_t sessions,
+                                   double mean,
+                                   double variance,
+                                   double drift) {
+    clamp::TemporalAggregator::Summary summary;
+    summary.sessionCount = sessions;
+    summary.meanStability = mean;
+    summary.stabilityVariance = variance;
+    summary.driftIndex = drift;
+    if (!backend.empty()) {
+        clamp::TemporalAggregator::GroupSummary group;
+        group.key.backend = backend;
+        group.key.deviceName = deviceName;
+        group.sessionCount = sessions;
+        group.meanStability = mean;
+        group.stabilityVariance = variance;
+        group.driftIndex = drift;
+        summary.groups.push_back(group);
+    }
+    const bool written = clamp::TemporalAggregator().writeSummary(summary, path, "telemetry");
+    assert(written);
+    (void)written;
+    return path;
+}
+
+void validate_baseline(const std::filesystem::path& dir) {
+    const std::vector<std::filesystem::path> paths{
+        writeSummary(dir / "hip.json", "HIP", "gfx1100", 10, 0.78, 0.05, 27.0),
+        dir / "missing.json",
+        writeSummary(dir / "cpu.json", "CPU", "host", 10, 0.80, 0.04, 20.0),
+        writeSummary(dir / "plain.json", "", "", 4, 0.81, 0.0, 22.0),
+    };
+    const auto output = dir / "comparison.json";
+    const auto result = clamp::TelemetryComparator().compare(paths, output);
+
+    assert(result.baselineBackend == "CPU");
+    assert(result.entries.size() == 3);
+    assert(result.entries[0].path == paths[0]);
+    assert(result.entries[0].backend == "HIP");
+    assert(result.entries[0].deviceName == "gfx1100");
+    assert(result.entries[0].summary.groups.size() == 1);
+    assert(close(result.entries[0].meanDelta, -0.02));
+    assert(close(result.entries[0].driftSkew, 7.0));
+    assert(close(result.entries[0].varianceRatio, 1.25));
+    assert(result.entries[0].driftSignificant);
+
+    assert(result.entries[1].backend == "CPU");
+    assert(result.entries[1].meanDelta == 0.0);
+    assert(result.entries[1].varianceRatio == 1.0);
+    assert(!result.entries[1].driftSignificant);
+
+    // No backend in the file at all.
+    assert(result.entries[2].backend == "@unknown");
+    assert(result.entries[2].deviceName == "@unknown");
+    assert(close(result.entries[2].driftSkew, 2.0));
+    assert(!result.entries[2].driftSignificant);
+    assert(result.entries[2].varianceRatio == 0.0);
+
+    assert(result.wroteOutput);
+    std::ifstream in(output);
+    const std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    assert(json.find("\"baseline\":{\"path\":") != std::string::npos);
+    assert(json.find("\"backend\":\"CPU\"") != std::string::npos);
+    assert(json.find("\"matrix\":{\"meanDelta\":[[") != std::string::npos);
+    assert(json.find("\"driftSignificant\":[[false,") != std::string::npos);
+}
+
+void validate_matrix(const std::filesystem::path& dir) {
+    // Two CPU summaries pool into one backend: sessions {n=2, mean 0.7, var
+    // 0.02} and {n=2, mean 0.9, var 0.02} combine to n=4, mean 0.8 and
+    // m2 = 0.02 + 0.02 + 0.2^2 * 2*2/4 = 0.08, so variance 0.08 / 3.
+    const std::vector<std::filesystem::path> paths{
+        writeSummary(dir / "a.json", "HIP", "gfx90a", 6, 0.60, 0.01, 40.0),
+        writeSummary(dir / "b.json", "CPU", "host", 2, 0.70, 0.02, 10.0),
+        writeSummary(dir / "c.json", "CPU", "host", 2, 0.90, 0.02, 30.0),
+    };
+    const auto result = clamp::TelemetryComparator().compare(paths, {});
+    assert(!result.wroteOutput);
+    assert(result.backends.size() == 2);
+    assert(result.matrix.size() == 4);
+
+    const auto& cpu = result.backends[0];
+    assert(cpu.backend == "CPU" && cpu.deviceName == "host");
+    assert(cpu.summaryCount == 2);
+    assert(cpu.sessionCount == 4);
+    assert(close(cpu.meanStability, 0.8));
+    assert(close(cpu.stabilityVariance, 0.08 / 3.0));
+    assert(close(cpu.driftIndex, 20.0));
+    const auto& hip = result.backends[1];
+    assert(hip.backend == "HIP" && hip.summaryCount == 1);
+
+    for (std::size_t i = 0; i < 2; ++i) {
+        assert(result.at(i, i).meanDelta == 0.0);
+        assert(result.at(i, i).varianceRatio == 1.0);
+        assert(!result.at(i, i).driftSignificant);
+    }
+    assert(close(result.at(1, 0).meanDelta, -0.2));
+    assert(close(result.at(0, 1).meanDelta, 0.2));
+    assert(close(result.at(1, 0).driftSkew, 20.0));
+    assert(result.at(1, 0).driftSignificant && result.at(0, 1).driftSignificant);
+    assert(close(result.at(1, 0).varianceRatio * result.at(0, 1).varianceRatio, 1.0));
+
+    // A wider threshold clears the flag.
+    const auto lenient = clamp::TelemetryComparator({0, 25.0}).compare(paths, {});
+    assert(!lenient.at(1, 0).driftSignificant);
+}
+
+void validate_many_summaries(const std::filesystem::path& dir) {
+    const char* backends[][2] = {{"CPU", "host"}, {"HIP", "gfx1100"}, {"HIP", "gfx90a"}, {"HIP", "gfx942"}};
+    std::vector<std::filesystem::path> paths;
+    for (std::size_t i = 0; i < 1000; ++i) {
+        const auto& backend = backends[i % 4];
+        paths.push_back(writeSummary(dir / ("summary_" + std::to_string(i) + ".json"), backend[0], backend[1],
+                                     10 + i % 7, 0.5 + static_cast<double>(i % 100) / 400.0,
+                                     0.01 + static_cast<double>(i % 13) / 1000.0, static_cast<double>(i % 50)));
+    }
+
+    const auto result = clamp::TelemetryComparator().compare(paths, dir / "comparison.json");
+    assert(result.wroteOutput);
+    assert(result.entries.size() == 1000);
+    assert(result.backends.size() == 4);
+    assert(result.baselineBackend == "CPU");
+
+    std::size_t pooled = 0;
+    for (const auto& backend : result.backends) {
+        assert(backend.summaryCount == 250);
+        pooled += backend.sessionCount;
+    }
+    std::size_t sessions = 0;
+    for (const auto& entry : result.entries) {
+        sessions += entry.summary.sessionCount;
+    }
+    assert(pooled == sessions);
+
+    // Parsing order must not leak into the result.
+    const auto serial = clamp::TelemetryComparator({1, 5.0}).compare(paths, {});
+    assert(serial.entries.size() == result.entries.size());
+    for (std::size_t i = 0; i < serial.entries.size(); ++i) {
+        assert(serial.entries[i].path == result.entries[i].path);
+        assert(serial.entries[i].meanDelta == result.entries[i].meanDelta);
+    }
+    for (std::size_t i = 0; i < serial.matrix.size(); ++i) {
+        assert(serial.matrix[i].meanDelta == result.matrix[i].meanDelta);
+        assert(serial.matrix[i].varianceRatio == result.matrix[i].varianceRatio);
+    }
+}
+
+// Raw EntropyTelemetry-style document; the backend and device are set at
+// document level, as EntropyTelemetry writes them.
+void writeTelemetry(const std::filesystem::path& path,
+                    const std::string& backend,
+                    const std::string& deviceName,
+                    const std::vector<std::pair<double, double>>& records) {
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream out(path);
+    out << "{\"backend\":\"" << backend << "\",\"device_name\":\"" << deviceName << "\",\"records\":[";
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        out << (i == 0 ? "" : ",") << "{\"context\":\"test\",\"stability_score\":" << records[i].first
+            << ",\"duration_ms\":" << records[i].second << "}";
+    }
+    out << "]}";
+}
+
+void validate_bootstrap(const std::filesystem::path& dir) {
+    // CPU and HIP/gfx1100 share one distribution; HIP/gfx90a is 0.01 less
+    // stable and 0.5 ms slower, well outside the sampling noise.
+    std::mt19937_64 rng(7);
+    std::normal_distribution<double> noise(0.0, 0.05);
+    auto sample = [&](double stability, double duration, std::size_t count) {
+        std::vector<std::pair<double, double>> records;
+        for (std::size_t i = 0; i < count; ++i) {
+            records.emplace_back(stability + noise(rng), duration + 20.0 * noise(rng));
+        }
+        return records;
+    };
+    const std::vector<std::filesystem::path> paths{
+        dir / "cpu_0.json", dir / "cpu_1.json", dir / "gfx1100.json", dir / "gfx90a.json"};
+    writeTelemetry(paths[0], "CPU", "host", sample(0.8, 4.0, 2500));
+    writeTelemetry(paths[1], "CPU", "host", sample(0.8, 4.0, 2500));
+    writeTelemetry(paths[2], "HIP", "gfx1100", sample(0.8, 4.0, 5000));
+    writeTelemetry(paths[3], "HIP", "gfx90a", sample(0.79, 4.5, 5000));
+
+    clamp::TelemetryComparator::Options options;
+    options.resamples = 1000;
+    const auto output = dir / "bootstrap.json";
+    const auto result = clamp::TelemetryComparator(options).bootstrap(paths, output);
+    assert(result.resamples == 1000);
+    assert(result.backends.size() == 3);
+    assert(result.backends[0].backend == "CPU");
+    assert(result.backends[0].recordCount == 5000);
+    assert(result.backends[2].deviceName == "gfx90a");
+
+    const auto& same = result.at(1, 0);
+    assert(!same.meanStabilityDelta.significant);
+    assert(!same.meanDurationDeltaMs.significant);
+    const auto& shifted = result.at(2, 0);
+    assert(shifted.meanStabilityDelta.significant && shifted.meanStabilityDelta.upper < 0.0);
+    assert(shifted.meanDurationDeltaMs.significant && shifted.meanDurationDeltaMs.lower > 0.0);
+    for (const auto& cell : {same, shifted}) {
+        for (const auto& interval : {cell.meanStabilityDelta, cell.meanDurationDeltaMs}) {
+            assert(interval.lower <= interval.estimate && interval.estimate <= interval.upper);
+        }
+    }
+    // About two standard errors each way: 2 * 1.96 * sqrt(2) * 0.05 / sqrt(5000).
+    const double width = shifted.meanStabilityDelta.upper - shifted.meanStabilityDelta.lower;
+    assert(width > 0.0035 && width < 0.0044);
+    assert(close(result.at(0, 2).meanStabilityDelta.estimate, -shifted.meanStabilityDelta.estimate));
+    assert(result.at(0, 0).meanStabilityDelta.estimate == 0.0);
+
+    assert(result.wroteOutput);
+    std::ifstream in(output);
+    const std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    assert(json.find("\"meanStabilityDelta\":[[") != std::string::npos);
+
+    // Replicates are keyed by resample, not by thread.
+    options.workerCount = 1;
+    const auto serial = clamp::TelemetryComparator(options).bootstrap(paths, {});
+    for (std::size_t i = 0; i < serial.matrix.size(); ++i) {
+        assert(serial.matrix[i].meanStabilityDelta.lower == result.matrix[i].meanStabilityDelta.lower);
+        assert(serial.matrix[i].meanDurationDeltaMs.upper == result.matrix[i].meanDurationDeltaMs.upper);
+    }
+}
+
+} // namespace
+
+int main() {
+    const auto baseDir = std::filesystem::current_path() / "telemetry_compare";
+    std::error_code ec;
+    std::filesystem::remove_all(baseDir, ec);
+
+    validate_baseline(baseDir / "baseline");
+    validate_matrix(baseDir / "matrix");
+    validate_many_summaries(baseDir / "many");
+    validate_bootstrap(baseDir / "bootstrap");
+    return 0;
+}
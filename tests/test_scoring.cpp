@@ -1,10 +1,14 @@
 #include "clamp/EntropyTelemetry.h"
+#include "clamp/StreamingTemporalScorer.h"
 #include "clamp/TemporalScoring.h"
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <filesystem>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -26,6 +30,244 @@ clamp::AnchorTelemetryRecord makeRecord(std::uint64_t seed,
     return record;
 }
 
+// The two-pass formulation TemporalScoring used before the fused kernel.
+double referenceNormalizedVariance(const std::vector<double>& values) {
+    if (values.size() < 2) {
+        return 0.0;
+    }
+    double mean = 0.0;
+    for (const double value : values) {
+        mean += value;
+    }
+    mean /= static_cast<double>(values.size());
+    double sumSq = 0.0;
+    for (const double value : values) {
+        sumSq += (value - mean) * (value - mean);
+    }
+    const double scale = std::abs(mean) + 1.0;
+    return std::min(1.0, sumSq / static_cast<double>(values.size() - 1) / (scale * scale));
+}
+
+bool close(double actual, double expected) {
+    return std::abs(actual - expected) <= 1e-9 * std::max(1.0, std::abs(expected));
+}
+
+void validateFusedKernel() {
+    clamp::TemporalScoring scoring;
+    std::mt19937_64 rng(41);
+    for (const std::size_t size : {1u, 2u, 3u, 7u, 1023u, 1024u, 1025u, 4099u, 50000u}) {
+        std::vector<clamp::AnchorTelemetryRecord> records;
+        std::vector<std::uint64_t> seeds;
+        std::vector<double> durations;
+        std::vector<std::int64_t> stamps;
+        std::vector<double> seedValues;
+        std::int64_t minStamp = INT64_MAX;
+        std::int64_t maxStamp = INT64_MIN;
+        for (std::size_t i = 0; i < size; ++i) {
+            // Large, tightly clustered seeds stress cancellation.
+            const std::uint64_t seed = (1ULL << 40) + rng() % 1000;
+            const double duration = 5.0 + static_cast<double>(rng() % 10000) / 1000.0;
+            auto record = makeRecord(seed, "node", std::chrono::milliseconds(rng() % 800), duration);
+            if (i % 5 == 3) {
+                record.acquiredAt = {};
+            }
+            const std::int64_t stamp =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(record.acquiredAt.time_since_epoch()).count();
+            if (stamp != 0) {
+                minStamp = std::min(minStamp, stamp);
+                maxStamp = std::max(maxStamp, stamp);
+            }
+            records.push_back(record);
+            seeds.push_back(seed);
+            durations.push_back(duration);
+            stamps.push_back(stamp);
+            seedValues.push_back(static_cast<double>(seed));
+        }
+
+        const auto fused = scoring.evaluate(records);
+        assert(fused.sampleCount == size);
+        assert(close(fused.entropyVariance, referenceNormalizedVariance(seedValues)));
+        assert(close(fused.durationVariance, referenceNormalizedVariance(durations)));
+        const double drift = minStamp > maxStamp ? 0.0 : static_cast<double>(maxStamp - minStamp) / 1e6;
+        assert(close(fused.driftMs, drift));
+
+        const auto columnar = scoring.evaluate(clamp::TemporalColumns{seeds.data(), durations.data(), stamps.data(), size});
+        assert(columnar.sampleCount == size);
+        assert(close(columnar.entropyVariance, fused.entropyVariance));
+        assert(close(columnar.durationVariance, fused.durationVariance));
+        assert(columnar.driftMs == fused.driftMs);
+        assert(close(columnar.stabilityScore, fused.stabilityScore));
+    }
+
+    const auto empty = scoring.evaluate(clamp::TemporalColumns{});
+    assert(empty.sampleCount == 0 && empty.stabilityScore == 1.0);
+}
+
+void validateParallelAggregation() {
+    // Enough records to cross the threshold below which groups stay serial.
+    std::mt19937_64 rng(42);
+    std::vector<std::vector<clamp::AnchorTelemetryRecord>> groups(700);
+    std::vector<std::uint64_t> seeds;
+    std::vector<double> durations;
+    std::vector<std::int64_t> stamps;
+    std::vector<std::size_t> offsets{0};
+    for (std::size_t group = 0; group < groups.size(); ++group) {
+        const std::size_t size = group % 11 == 0 ? 0 : 1 + rng() % 120;
+        for (std::size_t i = 0; i < size; ++i) {
+            const auto record = makeRecord(rng() % 50, "node", std::chrono::milliseconds(rng() % 3000),
+                                           1.0 + static_cast<double>(rng() % 500) / 100.0);
+            groups[group].push_back(record);
+            seeds.push_back(record.seed);
+            durations.push_back(record.durationMs);
+            stamps.push_back(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(record.acquiredAt.time_since_epoch()).count());
+        }
+        offsets.push_back(seeds.size());
+    }
+    assert(seeds.size() >= 32 * 1024);
+
+    const auto serial = clamp::TemporalScoring({1}).evaluateAggregated(groups);
+    const clamp::TemporalColumns columns{seeds.data(), durations.data(), stamps.data(), seeds.size()};
+    const auto serialColumns = clamp::TemporalScoring({1}).evaluateAggregated(columns, offsets);
+    assert(serial.sampleCount == seeds.size());
+    assert(close(serialColumns.stabilityScore, serial.stabilityScore));
+    assert(close(serialColumns.entropyVariance, serial.entropyVariance));
+    assert(close(serialColumns.durationVariance, serial.durationVariance));
+    assert(close(serialColumns.driftMs, serial.driftMs));
+
+    for (const std::size_t workers : {2u, 3u, 8u}) {
+        const clamp::TemporalScoring scoring({workers});
+        const auto parallel = scoring.evaluateAggregated(groups);
+        assert(parallel.toJson() == serial.toJson());
+        assert(parallel.stabilityScore == serial.stabilityScore && parallel.driftMs == serial.driftMs &&
+               parallel.entropyVariance == serial.entropyVariance &&
+               parallel.durationVariance == serial.durationVariance);
+        const auto parallelColumns = scoring.evaluateAggregated(columns, offsets);
+        assert(parallelColumns.stabilityScore == serialColumns.stabilityScore &&
+               parallelColumns.entropyVariance == serialColumns.entropyVariance &&
+               parallelColumns.sampleCount == serialColumns.sampleCount);
+    }
+
+    // Offsets past the end are clamped; no offsets means no groups.
+    const auto clamped = clamp::TemporalScoring().evaluateAggregated(columns, {0, seeds.size() + 10});
+    assert(clamped.sampleCount == seeds.size());
+    const auto none = clamp::TemporalScoring().evaluateAggregated(columns, {});
+    assert(none.sampleCount == 0 && none.stabilityScore == 1.0);
+}
+
+void assertSameScore(const clamp::TemporalScoringResult& actual, const clamp::TemporalScoringResult& expected) {
+    assert(actual.sampleCount == expected.sampleCount);
+    assert(close(actual.entropyVariance, expected.entropyVariance));
+    assert(close(actual.durationVariance, expected.durationVariance));
+    assert(close(actual.driftMs, expected.driftMs));
+    assert(close(actual.stabilityScore, expected.stabilityScore));
+}
+
+void validateStreamingScorer() {
+    clamp::TemporalScoring scoring;
+    std::mt19937_64 rng(43);
+    std::vector<clamp::AnchorTelemetryRecord> stream;
+    for (std::size_t i = 0; i < 5000; ++i) {
+        // Mostly in order, with some late and some unstamped records.
+        const auto offset = std::chrono::milliseconds(static_cast<long long>(i) * 3 - (i % 7 == 0 ? 40 : 0));
+        auto record = makeRecord(500 + rng() % 40, "node", offset, 2.0 + static_cast<double>(rng() % 300) / 50.0);
+        if (i % 13 == 5) {
+            record.acquiredAt = {};
+        }
+        stream.push_back(record);
+    }
+
+    clamp::StreamingTemporalScorer empty;
+    assert(empty.size() == 0 && empty.current().stabilityScore == 1.0);
+
+    // Count window: always the last 100 records.
+    clamp::StreamingTemporalScorer byCount({100, std::chrono::milliseconds(0)});
+    for (std::size_t i = 0; i < stream.size(); ++i) {
+        byCount.add(stream[i]);
+        const std::size_t first = i + 1 > 100 ? i + 1 - 100 : 0;
+        if (i % 97 == 0 || i + 1 == stream.size()) {
+            const std::vector<clamp::AnchorTelemetryRecord> window(stream.begin() + first, stream.begin() + i + 1);
+            assertSameScore(byCount.current(), scoring.evaluate(window));
+        }
+    }
+    assert(byCount.size() == 100);
+
+    // Time window: arrivals leave from the front once older than 250 ms
+    // behind the newest stamp; unstamped ones take the newest stamp so far.
+    clamp::StreamingTemporalScorer byTime({0, std::chrono::milliseconds(250)});
+    std::vector<std::int64_t> evictAt;
+    std::int64_t newest = INT64_MIN;
+    std::size_t first = 0;
+    for (std::size_t i = 0; i < stream.size(); ++i) {
+        byTime.add(stream[i]);
+        const std::int64_t stamp =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(stream[i].acquiredAt.time_since_epoch()).count();
+        newest = stamp != 0 ? std::max(newest, stamp) : newest;
+        evictAt.push_back(stamp != 0 ? stamp : newest);
+        while (first <= i && evictAt[first] <= newest - 250'000'000) {
+            ++first;
+        }
+        assert(byTime.size() == i + 1 - first);
+        if (i % 89 == 0) {
+            const std::vector<clamp::AnchorTelemetryRecord> window(stream.begin() + first, stream.begin() + i + 1);
+            assertSameScore(byTime.current(), scoring.evaluate(window));
+        }
+    }
+
+    byTime.clear();
+    assert(byTime.size() == 0 && byTime.current().sampleCount == 0);
+}
+
+// Drift only, saturating at 100 ms.
+struct DriftPolicy : clamp::DefaultScoringPolicy {
+    static constexpr bool kEntropy = false;
+    static constexpr bool kDuration = false;
+    static constexpr double kDriftScaleMs = 100.0;
+};
+
+// Durations weigh three times as much as seeds; drift is ignored.
+struct DurationHeavyPolicy : clamp::DefaultScoringPolicy {
+    static constexpr bool kDrift = false;
+    static constexpr double kDurationWeight = 3.0;
+};
+
+void validateScoringPolicies() {
+    const std::vector<clamp::AnchorTelemetryRecord> records{
+        makeRecord(10, "node", std::chrono::milliseconds(0), 4.0),
+        makeRecord(30, "node", std::chrono::milliseconds(20), 6.0),
+        makeRecord(20, "node", std::chrono::milliseconds(50), 8.0)};
+    const auto full = clamp::TemporalScoring().evaluate(records);
+    assert(full.entropyVariance > 0.0 && full.durationVariance > 0.0 && full.driftMs == 50.0);
+
+    const auto drift = clamp::BasicTemporalScoring<DriftPolicy>().evaluate(records);
+    assert(drift.entropyVariance == 0.0 && drift.durationVariance == 0.0);
+    assert(drift.driftMs == full.driftMs);
+    assert(close(drift.stabilityScore, 0.5));
+
+    const auto weighted = clamp::BasicTemporalScoring<DurationHeavyPolicy>().evaluate(records);
+    assert(weighted.driftMs == 0.0);
+    assert(weighted.entropyVariance == full.entropyVariance && weighted.durationVariance == full.durationVariance);
+    assert(close(weighted.stabilityScore, 1.0 - (full.entropyVariance + 3.0 * full.durationVariance) / 4.0));
+
+    std::vector<std::uint64_t> seeds;
+    std::vector<double> durations;
+    std::vector<std::int64_t> stamps;
+    for (const auto& record : records) {
+        seeds.push_back(record.seed);
+        durations.push_back(record.durationMs);
+        stamps.push_back(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(record.acquiredAt.time_since_epoch()).count());
+    }
+    const clamp::TemporalColumns columns{seeds.data(), durations.data(), stamps.data(), seeds.size()};
+    assertSameScore(clamp::BasicTemporalScoring<DriftPolicy>().evaluate(columns), drift);
+    assertSameScore(clamp::BasicTemporalScoring<DurationHeavyPolicy>().evaluate(columns), weighted);
+
+    // Columns a policy does not read may be left null, also when grouped.
+    const clamp::TemporalColumns stampsOnly{nullptr, nullptr, stamps.data(), stamps.size()};
+    assertSameScore(clamp::BasicTemporalScoring<DriftPolicy>().evaluateAggregated(stampsOnly, {0, stamps.size()}),
+                    drift);
+}
+
 } // namespace
 
 int main() {
@@ -74,5 +316,10 @@ int main() {
     const std::string repeatJson = aggregated.toJson();
     assert(repeatJson == jsonSummary);
 
+    validateFusedKernel();
+    validateParallelAggregation();
+    validateStreamingScorer();
+    validateScoringPolicies();
+
     return 0;
 }
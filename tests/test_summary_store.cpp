@@ -0,0 +1,155 @@
+#include "clamp/SummaryStore.h"
+#include "clamp/TemporalAggregator.h"
+
+#include <cassert>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::int64_t kBaseMs = 1735689600000;
+constexpr std::int64_t kHourMs = 3600000;
+
+clamp::SummaryStore::Row makeRow(int build) {
+    clamp::SummaryStore::Row row;
+    row.timestampMs = kBaseMs + build * kHourMs;
+    row.digest = "sha256:" + std::to_string(build % 7);
+    row.sessionCount = static_cast<std::size_t>(build + 1);
+    row.meanStability = 0.5 + build / 1000.0;
+    row.durationP99 = 10.0 + build;
+    return row;
+}
+
+void validate_append_and_query(const std::filesystem::path& storeDir) {
+    clamp::SummaryStore store;
+    assert(store.open(storeDir));
+    assert(store.size() == 0);
+    // Appended slightly out of order to exercise the time index.
+    for (int build = 0; build < 500; ++build) {
+        const int shuffled = build % 2 == 0 ? build + 1 : build - 1;
+        assert(store.append(makeRow(shuffled)));
+    }
+    assert(store.size() == 500);
+
+    const auto window = store.range(kBaseMs + 100 * kHourMs, kBaseMs + 110 * kHourMs);
+    assert(window.size() == 10);
+    for (std::size_t i = 0; i < window.size(); ++i) {
+        assert(window[i].timestampMs == kBaseMs + static_cast<std::int64_t>(100 + i) * kHourMs);
+        assert(window[i].sessionCount == 101 + i);
+    }
+
+    const auto recent = store.latest(3);
+    assert(recent.size() == 3);
+    assert(recent.back().timestampMs == kBaseMs + 499 * kHourMs);
+    assert(recent.front().durationP99 == 10.0 + 497);
+
+    const auto digestRows = store.findDigest("sha256:3");
+    assert(digestRows.size() == 71);
+    for (std::size_t i = 1; i < digestRows.size(); ++i) {
+        assert(digestRows[i - 1].timestampMs < digestRows[i].timestampMs);
+        assert(digestRows[i].digest == "sha256:3");
+    }
+    assert(store.findDigest("sha256:unknown").empty());
+}
+
+void validate_reopen(const std::filesystem::path& storeDir) {
+    // The first reopen indexes everything appended above; the next one loads
+    // the saved index and only catches up with the newly appended row.
+    for (int pass = 0; pass < 2; ++pass) {
+        clamp::SummaryStore store;
+        assert(store.open(storeDir));
+        assert(store.size() == static_cast<std::size_t>(500 + pass));
+        assert(store.range(kBaseMs, kBaseMs + 2000 * kHourMs).size() == store.size());
+        assert(store.findDigest("sha256:3").size() == 71);
+        clamp::SummaryStore::Row extra = makeRow(1000 + pass);
+        extra.digest = "sha256:extra";
+        assert(store.append(extra));
+    }
+    clamp::SummaryStore store;
+    assert(store.open(storeDir));
+    assert(store.findDigest("sha256:extra").size() == 2);
+
+    // A torn trailing row is cut off rather than failing the whole store, and
+    // rows appended afterwards stay aligned.
+    {
+        std::ofstream out(storeDir / "summaries.rows", std::ios::binary | std::ios::app);
+        out << "partial";
+    }
+    clamp::SummaryStore torn;
+    assert(torn.open(storeDir));
+    assert(torn.size() == 502);
+    clamp::SummaryStore::Row afterTear = makeRow(2000);
+    afterTear.digest = "sha256:after-tear";
+    assert(torn.append(afterTear));
+
+    clamp::SummaryStore reopened;
+    assert(reopened.open(storeDir));
+    assert(reopened.size() == 503);
+    const auto tail = reopened.findDigest("sha256:after-tear");
+    assert(tail.size() == 1);
+    assert(tail[0].timestampMs == afterTear.timestampMs);
+    assert(tail[0].meanStability == afterTear.meanStability);
+    assert(reopened.findDigest("sha256:extra").size() == 2);
+}
+
+void validate_summary_import(const std::filesystem::path& baseDir) {
+    const auto telemetryDir = baseDir / "telemetry";
+    std::filesystem::create_directories(telemetryDir);
+    {
+        std::ofstream out(telemetryDir / "run.json");
+        out << "{\"records\":[{\"acquired_at\":\"2025-01-01T00:00:00Z\",\"duration_ms\":4.0,\"stability_score\":0.5},"
+               "{\"acquired_at\":\"2025-01-01T00:00:01Z\",\"duration_ms\":6.0,\"stability_score\":0.7}]}";
+    }
+    const auto snapshotPath = baseDir / "rocm_snapshot.json";
+    {
+        std::ofstream snapshot(snapshotPath);
+        snapshot << R"({"image":"rocm/dev","digest":"sha256:abcd","resolved_at":"2025-02-01T12:00:00Z"})";
+    }
+
+    clamp::TemporalAggregator aggregator;
+    const auto summary = aggregator.aggregate(telemetryDir);
+    const auto summaryPath = baseDir / "telemetry_summary.json";
+    assert(aggregator.writeSummary(summary, summaryPath, telemetryDir.string(), snapshotPath));
+
+    clamp::SummaryStore store;
+    assert(store.open(baseDir / "import_store"));
+    assert(store.appendSummaryFile(summaryPath));
+    assert(store.append(summary, "sha256:direct", kBaseMs));
+    const auto imported = store.findDigest("sha256:abcd");
+    assert(imported.size() == 1);
+    assert(imported[0].timestampMs == 1738411200000);
+    assert(imported[0].sessionCount == 2);
+    assert(imported[0].meanStability == 0.6);
+    assert(imported[0].durationP50 == 5.0);
+
+    const auto rows = store.latest(10);
+    assert(rows.size() == 2 && rows[0].digest == "sha256:direct");
+    const auto exportPath = baseDir / "history.json";
+    assert(clamp::SummaryStore::exportJson(rows, exportPath));
+    std::ifstream in(exportPath);
+    const std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    assert(contents.find("\"digest\":\"sha256:abcd\"") != std::string::npos);
+    assert(contents.find("\"timestamp_ms\":1738411200000") != std::string::npos);
+
+    // Digests are escaped on export.
+    clamp::SummaryStore::Row quoted = makeRow(0);
+    quoted.digest = "tag:\"v1\"\\x";
+    const std::string json = clamp::SummaryStore::toJson({quoted});
+    assert(json.find(R"("digest":"tag:\"v1\"\\x")") != std::string::npos);
+}
+
+} // namespace
+
+int main() {
+    const auto baseDir = std::filesystem::current_path() / "summary_store";
+    std::error_code ec;
+    std::filesystem::remove_all(baseDir, ec);
+
+    validate_append_and_query(baseDir / "store");
+    validate_reopen(baseDir / "store");
+    validate_summary_import(baseDir);
+    return 0;
+}